@@ -0,0 +1,155 @@
+#include "mapped_file.hpp"
+#include "core/log.hpp"
+
+#include <utility>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace huedra {
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept { *this = std::move(rhs); }
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        close();
+        m_data = std::exchange(rhs.m_data, nullptr);
+        m_size = std::exchange(rhs.m_size, 0);
+        m_open = std::exchange(rhs.m_open, false);
+#ifdef WIN32
+        m_file = std::exchange(rhs.m_file, nullptr);
+        m_mapping = std::exchange(rhs.m_mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#ifdef WIN32
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        log(LogLevel::WARNING, "MappedFile::open(): failed to open file: \"{}\"", path.c_str());
+        return false;
+    }
+
+    LARGE_INTEGER size{};
+    if (GetFileSizeEx(file, &size) == 0)
+    {
+        log(LogLevel::WARNING, "MappedFile::open(): failed to get size of file: \"{}\"", path.c_str());
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_size = static_cast<u64>(size.QuadPart);
+    m_open = true;
+    if (m_size == 0) // Empty files can not be mapped
+    {
+        return true;
+    }
+
+    m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping != nullptr)
+    {
+        m_data = static_cast<const u8*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (m_data == nullptr)
+    {
+        log(LogLevel::WARNING, "MappedFile::open(): failed to map file: \"{}\"", path.c_str());
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != nullptr)
+    {
+        CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file == -1)
+    {
+        log(LogLevel::WARNING, "MappedFile::open(): failed to open file: \"{}\"", path.c_str());
+        return false;
+    }
+
+    struct stat info{};
+    if (fstat(file, &info) == -1)
+    {
+        log(LogLevel::WARNING, "MappedFile::open(): failed to get size of file: \"{}\"", path.c_str());
+        ::close(file);
+        return false;
+    }
+
+    m_size = static_cast<u64>(info.st_size);
+    if (m_size != 0) // Empty files can not be mapped
+    {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (data == MAP_FAILED)
+        {
+            log(LogLevel::WARNING, "MappedFile::open(): failed to map file: \"{}\"", path.c_str());
+            ::close(file);
+            m_size = 0;
+            return false;
+        }
+        m_data = static_cast<const u8*>(data);
+        madvise(data, m_size, MADV_SEQUENTIAL);
+    }
+
+    // The mapping keeps its own reference to the file
+    ::close(file);
+    m_open = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<u8*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+#endif
+
+} // namespace huedra
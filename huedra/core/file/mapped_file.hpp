@@ -0,0 +1,42 @@
+#pragma once
+
+#include "core/types.hpp"
+
+#include <span>
+
+namespace huedra {
+
+// Read only view of a whole file mapped into memory, pages are loaded by the os on first access instead of being
+// copied up front. The data stays valid until the file is closed or the object is destroyed
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile& rhs) = delete;
+    MappedFile& operator=(const MappedFile& rhs) = delete;
+    MappedFile(MappedFile&& rhs) noexcept;
+    MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+    // Empty files are opened successfully but have no data
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return m_open; }
+    const u8* data() const { return m_data; }
+    u64 size() const { return m_size; }
+    std::span<const u8> getBytes() const { return {m_data, m_size}; }
+
+private:
+    const u8* m_data{nullptr};
+    u64 m_size{0};
+    bool m_open{false};
+#ifdef WIN32
+    void* m_file{nullptr};
+    void* m_mapping{nullptr};
+#endif
+};
+
+} // namespace huedra
@@ -34,7 +34,7 @@ inline std::vector<u8> readBytes(const std::string& path)
 
 inline bool writeBytes(const std::string& path, const std::vector<u8>& bytes)
 {
-    std::ofstream file(path);
+    std::ofstream file(path, std::ios::binary);
     if (!file.is_open())
     {
         log(LogLevel::ERR, "Failed to open file: \"{}\"!", path.c_str());
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "core/types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace huedra {
+
+// Four independent multiply-xorshift lanes so that hashing keeps up with reading large files, used for cache keys
+inline u64 hashBytes(std::span<const u8> bytes, u64 seed)
+{
+    std::array<u64, 4> lanes{seed ^ 0x9e3779b97f4a7c15ull, seed ^ 0xc2b2ae3d27d4eb4full, seed ^ 0x165667b19e3779f9ull,
+                             seed ^ 0x27d4eb2f165667c5ull};
+    u64 i = 0;
+    for (; i + sizeof(lanes) <= bytes.size(); i += sizeof(lanes))
+    {
+        for (u64 j = 0; j < lanes.size(); ++j)
+        {
+            u64 word = 0;
+            std::memcpy(&word, &bytes[i + (j * sizeof(u64))], sizeof(u64));
+            lanes[j] = (lanes[j] ^ word) * 0xff51afd7ed558ccdull;
+            lanes[j] ^= lanes[j] >> 32;
+        }
+    }
+
+    u64 hash = bytes.size();
+    for (u64 lane : lanes)
+    {
+        hash = (hash ^ lane) * 0xff51afd7ed558ccdull;
+        hash ^= hash >> 32;
+    }
+    for (; i < bytes.size(); i += sizeof(u64))
+    {
+        u64 word = 0;
+        std::memcpy(&word, &bytes[i], std::min<u64>(sizeof(u64), bytes.size() - i));
+        hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+        hash ^= hash >> 32;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+template <typename T>
+u64 hashValue(u64 hash, const T& value)
+{
+    static_assert(std::has_unique_object_representations_v<T>);
+    return hashBytes(std::span(reinterpret_cast<const u8*>(&value), sizeof(T)), hash);
+}
+
+} // namespace huedra
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "core/types.hpp"
+
+#include <bit>
+#include <cstring>
+#include <span>
+
+namespace huedra {
+
+// Typed read only view over elements that are stride bytes apart, e.g. one attribute of interleaved vertex data inside
+// a file buffer. Elements are read with memcpy, so neither the data nor the stride has to be aligned for T. The data is
+// stored little endian in components of componentSize bytes (a vec3 has 4 byte components), which are swapped on big
+// endian hosts
+template <typename T>
+    requires(std::is_trivially_copyable_v<T>)
+class StridedView
+{
+public:
+    StridedView() = default;
+    StridedView(const u8* data, u64 count, u64 stride, u32 componentSize = sizeof(T))
+        : m_data(data), m_count(count), m_stride(stride), m_componentSize(componentSize)
+    {}
+    ~StridedView() = default;
+
+    StridedView(const StridedView& rhs) = default;
+    StridedView& operator=(const StridedView& rhs) = default;
+    StridedView(StridedView&& rhs) = default;
+    StridedView& operator=(StridedView&& rhs) = default;
+
+    T operator[](u64 index) const
+    {
+        T value;
+        std::memcpy(&value, &m_data[index * m_stride], sizeof(T));
+        if constexpr (std::endian::native == std::endian::big)
+        {
+            swapComponents(reinterpret_cast<u8*>(&value), 1);
+        }
+        return value;
+    }
+
+    // Copies all elements into dst, which has room for size() elements. A single memcpy if the elements are tightly
+    // packed
+    void copyTo(T* dst) const
+    {
+        if (isContiguous())
+        {
+            std::memcpy(dst, m_data, m_count * sizeof(T));
+        }
+        else
+        {
+            for (u64 i = 0; i < m_count; ++i)
+            {
+                std::memcpy(&dst[i], &m_data[i * m_stride], sizeof(T));
+            }
+        }
+        if constexpr (std::endian::native == std::endian::big)
+        {
+            swapComponents(reinterpret_cast<u8*>(dst), m_count);
+        }
+    }
+
+    const u8* data() const { return m_data; }
+    u64 size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    u64 getStride() const { return m_stride; }
+    bool isContiguous() const { return m_stride == sizeof(T); }
+
+    // Raw bytes covered by the view, including any interleaved data between the elements
+    std::span<const u8> getBytes() const
+    {
+        return {m_data, m_count == 0 ? 0 : (m_stride * (m_count - 1)) + sizeof(T)};
+    }
+
+private:
+    void swapComponents(u8* bytes, u64 count) const
+    {
+        for (u64 i = 0; i + m_componentSize <= count * sizeof(T); i += m_componentSize)
+        {
+            for (u64 j = 0; j < m_componentSize / 2; ++j)
+            {
+                std::swap(bytes[i + j], bytes[i + m_componentSize - j - 1]);
+            }
+        }
+    }
+
+    const u8* m_data{nullptr};
+    u64 m_count{0};
+    u64 m_stride{0};
+    u32 m_componentSize{sizeof(T)};
+};
+
+} // namespace huedra
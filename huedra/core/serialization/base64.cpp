@@ -2,74 +2,403 @@
 
 #include "core/log.hpp"
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define BASE64_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// Allows compiling the SIMD paths without enabling the instruction sets for the whole project, they are only called
+// after checking cpu support at runtime
+#if defined(__GNUC__) || defined(__clang__)
+#define BASE64_TARGET(isa) __attribute__((target(isa)))
+#else
+#define BASE64_TARGET(isa)
+#endif
+
 namespace huedra {
 
-std::vector<u8> decodeBase64(const std::string& base64)
-{
-    u64 len = base64.length();
-    if (len % 4 != 0)
+namespace {
+
+constexpr u8 INVALID_CHAR = 0xff;
+constexpr std::string_view ALPHABET = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+constexpr std::array<u8, 256> DECODE_TABLE = [] {
+    std::array<u8, 256> table{};
+    table.fill(INVALID_CHAR);
+    for (u8 i = 0; i < ALPHABET.length(); ++i)
     {
-        log(LogLevel::WARNING, "decodeBase64(): incorrect string length: {}", len);
-        return {};
+        table[static_cast<u8>(ALPHABET[i])] = i;
     }
+    return table;
+}();
 
-    auto decodeChar = [](char c) -> u8 {
-        if (c >= 'A' && c <= 'Z')
-        {
-            return c - 'A';
-        }
-        if (c >= 'a' && c <= 'z')
-        {
-            return c - 'a' + 26;
-        }
-        if (c >= '0' && c <= '9')
+enum class SimdLevel
+{
+    NONE,
+    SSSE3,
+    AVX2
+};
+
+SimdLevel getSimdLevel()
+{
+#ifdef BASE64_X86
+    static const SimdLevel level = [] {
+#if defined(_MSC_VER) && !defined(__clang__)
+        std::array<int, 4> info{};
+        __cpuid(info.data(), 1);
+        bool ssse3 = (info[2] & (1 << 9)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        __cpuidex(info.data(), 7, 0);
+        bool avx2 = (info[1] & (1 << 5)) != 0 && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+#else
+        bool ssse3 = __builtin_cpu_supports("ssse3");
+        bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        if (avx2)
         {
-            return c - '0' + 52;
+            return SimdLevel::AVX2;
         }
-        if (c == '+')
+        return ssse3 ? SimdLevel::SSSE3 : SimdLevel::NONE;
+    }();
+    return level;
+#else
+    return SimdLevel::NONE;
+#endif
+}
+
+#ifdef BASE64_X86
+// Character validation and translation is based on nibble lookups and the 6-bit values are packed with multiply-add
+// instructions, as described by Wojciech Muła and Daniel Lemire in "Faster Base64 Encoding and Decoding Using AVX2
+// Instructions". The decoders stop at the first block containing an incorrect character and return the number of
+// characters consumed, the scalar path then reports the error. Every store writes a full register, so the callers
+// only let the SIMD paths run while there is enough room left in the output.
+
+BASE64_TARGET("ssse3") u64 decodeSsse3(const char* src, u64 length, u8* dst, u64 dstSize)
+{
+    const __m128i lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a, 0x1b,
+                                        0x1b, 0x1b, 0x1a);
+    const __m128i lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                        0x10, 0x10, 0x10);
+    const __m128i lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i packShuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m128i nibbleMask = _mm_set1_epi8(0x0f);
+
+    u64 i = 0;
+    u64 o = 0;
+    for (; i + 16 <= length && o + 16 <= dstSize; i += 16, o += 12)
+    {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), nibbleMask);
+        __m128i lo = _mm_shuffle_epi8(lutLo, _mm_and_si128(in, nibbleMask));
+        __m128i hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xffff)
         {
-            return 62;
+            break;
         }
-        if (c == '/')
+
+        __m128i roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(_mm_cmpeq_epi8(in, _mm_set1_epi8('/')), hiNibbles));
+        __m128i values = _mm_add_epi8(in, roll);
+
+        __m128i merged = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + o), _mm_shuffle_epi8(packed, packShuffle));
+    }
+    return i;
+}
+
+BASE64_TARGET("avx2") u64 decodeAvx2(const char* src, u64 length, u8* dst, u64 dstSize)
+{
+    const __m256i lutLo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a,
+                                           0x1b, 0x1b, 0x1b, 0x1a, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                           0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+    const __m256i lutHi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+                                           0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                           0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    const __m256i lutRoll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4,
+                                             -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m256i packShuffle = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6,
+                                                 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    const __m256i packPermute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, -1, -1);
+    const __m256i nibbleMask = _mm256_set1_epi8(0x0f);
+
+    u64 i = 0;
+    u64 o = 0;
+    for (; i + 32 <= length && o + 32 <= dstSize; i += 32, o += 24)
+    {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), nibbleMask);
+        __m256i lo = _mm256_shuffle_epi8(lutLo, _mm256_and_si256(in, nibbleMask));
+        __m256i hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(lo, hi), _mm256_setzero_si256())) != -1)
         {
-            return 63;
+            break;
         }
-        if (c == '=')
+
+        __m256i roll =
+            _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(_mm256_cmpeq_epi8(in, _mm256_set1_epi8('/')), hiNibbles));
+        __m256i values = _mm256_add_epi8(in, roll);
+
+        __m256i merged = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+        __m256i packed = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+        packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(packed, packShuffle), packPermute);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + o), packed);
+    }
+    return i;
+}
+
+// Returns the number of bytes consumed, every 12 bytes produce 16 characters. Loads are 16 bytes wide so at least 4
+// bytes past the last block have to be readable
+BASE64_TARGET("ssse3") u64 encodeSsse3(const u8* src, u64 size, char* dst)
+{
+    const __m128i splitShuffle = _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m128i shiftLut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    u64 i = 0;
+    u64 o = 0;
+    for (; i + 16 <= size; i += 12, o += 16)
+    {
+        __m128i in = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), splitShuffle);
+
+        // Spread the 24-bit groups into four bytes holding 6 bits each
+        __m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+        __m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+        __m128i indices = _mm_or_si128(t0, t1);
+
+        __m128i lutIndex = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        lutIndex = _mm_or_si128(lutIndex,
+                                _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+        __m128i out = _mm_add_epi8(_mm_shuffle_epi8(shiftLut, lutIndex), indices);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + o), out);
+    }
+    return i;
+}
+
+// Same as encodeSsse3() but 24 bytes at a time, the two 12 byte halves are loaded into separate lanes
+BASE64_TARGET("avx2") u64 encodeAvx2(const u8* src, u64 size, char* dst)
+{
+    const __m256i splitShuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3,
+                                                  5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+    const __m256i shiftLut =
+        _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                         '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0, 'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                         '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63,
+                         'A', 0, 0);
+
+    u64 i = 0;
+    u64 o = 0;
+    for (; i + 28 <= size; i += 24, o += 32)
+    {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12));
+        __m256i in = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), splitShuffle);
+
+        __m256i t0 =
+            _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+        __m256i t1 =
+            _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+        __m256i indices = _mm256_or_si256(t0, t1);
+
+        __m256i lutIndex = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        lutIndex = _mm256_or_si256(
+            lutIndex, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+        __m256i out = _mm256_add_epi8(_mm256_shuffle_epi8(shiftLut, lutIndex), indices);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + o), out);
+    }
+    return i;
+}
+#endif
+
+} // namespace
+
+u64 decodedBase64Size(std::string_view base64)
+{
+    u64 len = base64.length();
+    if (len == 0 || len % 4 != 0)
+    {
+        return 0;
+    }
+
+    u64 size = (len / 4) * 3;
+    if (base64[len - 1] == '=')
+    {
+        --size;
+        if (base64[len - 2] == '=')
         {
-            return 64; // Padding
+            --size;
         }
-        return 65; // Incorrect
-    };
+    }
+    return size;
+}
 
-    std::vector<u8> bytes;
+u64 encodedBase64Size(u64 byteCount) { return ((byteCount + 2) / 3) * 4; }
 
-    for (u64 i = 0; i < len; i += 4)
+bool decodeBase64(std::string_view base64, std::span<u8> bytes)
+{
+    u64 len = base64.length();
+    if (len % 4 != 0)
     {
-        std::array<u8, 4> arr{decodeChar(base64[i]), decodeChar(base64[i + 1]), decodeChar(base64[i + 2]),
-                              decodeChar(base64[i + 3])};
-        for (u64 j = 0; j < 4; ++j)
+        log(LogLevel::WARNING, "decodeBase64(): incorrect string length: {}", len);
+        return false;
+    }
+    if (len == 0)
+    {
+        return true;
+    }
+
+    u64 size = decodedBase64Size(base64);
+    if (bytes.size() < size)
+    {
+        log(LogLevel::WARNING, "decodeBase64(): output of {} bytes is too small, {} bytes needed", bytes.size(), size);
+        return false;
+    }
+
+    const char* src = base64.data();
+    u8* dst = bytes.data();
+
+    // The last quad can contain padding and is always decoded separately
+    u64 blockLen = len - 4;
+    u64 i = 0;
+    u64 o = 0;
+#ifdef BASE64_X86
+    SimdLevel simdLevel = getSimdLevel();
+    if (simdLevel == SimdLevel::AVX2)
+    {
+        i = decodeAvx2(src, blockLen, dst, size);
+        o = (i / 4) * 3;
+    }
+    if (simdLevel != SimdLevel::NONE)
+    {
+        u64 consumed = decodeSsse3(src + i, blockLen - i, dst + o, size - o);
+        i += consumed;
+        o += (consumed / 4) * 3;
+    }
+#endif
+
+    auto reportIncorrect = [&](u64 quadStart) {
+        for (u64 j = quadStart; j < quadStart + 4; ++j)
         {
-            if (arr[j] == 65)
+            if (DECODE_TABLE[static_cast<u8>(src[j])] == INVALID_CHAR)
             {
-                log(LogLevel::WARNING, "decodeBase64(): Incorrect base64 character: {}", base64[i + j]);
-                return {};
+                log(LogLevel::WARNING, "decodeBase64(): Incorrect base64 character: {} at {}", src[j], j);
+                return false;
             }
         }
+        return false;
+    };
 
-        bytes.push_back((arr[0] << 2) | (arr[1] >> 4));
-
-        if (arr[2] != 64)
+    for (; i < blockLen; i += 4, o += 3)
+    {
+        u32 a = DECODE_TABLE[static_cast<u8>(src[i])];
+        u32 b = DECODE_TABLE[static_cast<u8>(src[i + 1])];
+        u32 c = DECODE_TABLE[static_cast<u8>(src[i + 2])];
+        u32 d = DECODE_TABLE[static_cast<u8>(src[i + 3])];
+        if (((a | b | c | d) & 0x80) != 0)
         {
-            bytes.push_back(((arr[1] & 0x0f) << 4) | (arr[2] >> 2));
+            return reportIncorrect(i);
         }
 
-        if (arr[3] != 64)
+        u32 triple = (a << 18) | (b << 12) | (c << 6) | d;
+        dst[o] = static_cast<u8>(triple >> 16);
+        dst[o + 1] = static_cast<u8>(triple >> 8);
+        dst[o + 2] = static_cast<u8>(triple);
+    }
+
+    // Last quad, "xx==", "xxx=" or "xxxx"
+    u64 padding = 3 - (size - o);
+    u32 a = DECODE_TABLE[static_cast<u8>(src[i])];
+    u32 b = DECODE_TABLE[static_cast<u8>(src[i + 1])];
+    u32 c = padding == 2 ? 0 : DECODE_TABLE[static_cast<u8>(src[i + 2])];
+    u32 d = padding >= 1 ? 0 : DECODE_TABLE[static_cast<u8>(src[i + 3])];
+    if (((a | b | c | d) & 0x80) != 0)
+    {
+        return reportIncorrect(i);
+    }
+
+    u32 triple = (a << 18) | (b << 12) | (c << 6) | d;
+    dst[o] = static_cast<u8>(triple >> 16);
+    if (padding < 2)
+    {
+        dst[o + 1] = static_cast<u8>(triple >> 8);
+    }
+    if (padding < 1)
+    {
+        dst[o + 2] = static_cast<u8>(triple);
+    }
+    return true;
+}
+
+std::vector<u8> decodeBase64(std::string_view base64)
+{
+    std::vector<u8> bytes(decodedBase64Size(base64));
+    if (!decodeBase64(base64, bytes))
+    {
+        return {};
+    }
+    return bytes;
+}
+
+void encodeBase64(std::span<const u8> bytes, std::span<char> base64)
+{
+    u64 size = bytes.size();
+    if (base64.size() < encodedBase64Size(size))
+    {
+        log(LogLevel::WARNING, "encodeBase64(): output of {} characters is too small, {} characters needed",
+            base64.size(), encodedBase64Size(size));
+        return;
+    }
+
+    const u8* src = bytes.data();
+    char* dst = base64.data();
+    u64 i = 0;
+    u64 o = 0;
+#ifdef BASE64_X86
+    SimdLevel simdLevel = getSimdLevel();
+    if (simdLevel == SimdLevel::AVX2)
+    {
+        i = encodeAvx2(src, size, dst);
+        o = (i / 3) * 4;
+    }
+    if (simdLevel != SimdLevel::NONE)
+    {
+        u64 consumed = encodeSsse3(src + i, size - i, dst + o);
+        i += consumed;
+        o += (consumed / 3) * 4;
+    }
+#endif
+
+    for (; i + 3 <= size; i += 3, o += 4)
+    {
+        u32 triple = (src[i] << 16) | (src[i + 1] << 8) | src[i + 2];
+        dst[o] = ALPHABET[(triple >> 18) & 0x3f];
+        dst[o + 1] = ALPHABET[(triple >> 12) & 0x3f];
+        dst[o + 2] = ALPHABET[(triple >> 6) & 0x3f];
+        dst[o + 3] = ALPHABET[triple & 0x3f];
+    }
+
+    u64 remaining = size - i;
+    if (remaining != 0)
+    {
+        u32 triple = src[i] << 16;
+        if (remaining == 2)
         {
-            bytes.push_back(((arr[2] & 0x03) << 6) | arr[3]);
+            triple |= src[i + 1] << 8;
         }
+        dst[o] = ALPHABET[(triple >> 18) & 0x3f];
+        dst[o + 1] = ALPHABET[(triple >> 12) & 0x3f];
+        dst[o + 2] = remaining == 2 ? ALPHABET[(triple >> 6) & 0x3f] : '=';
+        dst[o + 3] = '=';
     }
+}
 
-    return bytes;
+std::string encodeBase64(std::span<const u8> bytes)
+{
+    std::string base64(encodedBase64Size(bytes.size()), '\0');
+    encodeBase64(bytes, base64);
+    return base64;
 }
 
-} // namespace huedra
\ No newline at end of file
+} // namespace huedra
@@ -2,8 +2,22 @@
 
 #include "core/types.hpp"
 
+#include <span>
+#include <string_view>
+
 namespace huedra {
 
-std::vector<u8> decodeBase64(const std::string& base64);
+// Exact number of bytes the (padded) base64 string decodes to, 0 if the length is not a multiple of 4
+u64 decodedBase64Size(std::string_view base64);
+u64 encodedBase64Size(u64 byteCount);
+
+// Decodes into a preallocated span of at least decodedBase64Size(base64) bytes. Returns false on incorrect characters
+// or padding, the content of bytes is then undefined. Uses AVX2 or SSSE3 when supported by the cpu
+bool decodeBase64(std::string_view base64, std::span<u8> bytes);
+std::vector<u8> decodeBase64(std::string_view base64);
+
+// Encodes into a preallocated span of at least encodedBase64Size(bytes.size()) characters, padded with '='
+void encodeBase64(std::span<const u8> bytes, std::span<char> base64);
+std::string encodeBase64(std::span<const u8> bytes);
 
-} // namespace huedra
\ No newline at end of file
+} // namespace huedra
@@ -0,0 +1,532 @@
+#include "cbor.hpp"
+
+#include "core/log.hpp"
+#include "core/memory/utils.hpp"
+
+#include <cmath>
+
+namespace huedra {
+
+namespace {
+
+enum class MajorType : u8
+{
+    UINT = 0,
+    NEGATIVE_INT = 1,
+    BYTE_STRING = 2,
+    TEXT_STRING = 3,
+    ARRAY = 4,
+    MAP = 5,
+    TAG = 6,
+    SIMPLE = 7 // Also floats and the break code
+};
+
+constexpr u8 CBOR_INDEFINITE = 31;
+constexpr u8 CBOR_BREAK = 0xff;
+constexpr u8 CBOR_FALSE = 20;
+constexpr u8 CBOR_TRUE = 21;
+constexpr u8 CBOR_NULL = 22;
+constexpr u8 CBOR_UNDEFINED = 23;
+constexpr u8 CBOR_HALF = 25;
+constexpr u8 CBOR_SINGLE = 26;
+constexpr u8 CBOR_DOUBLE = 27;
+
+// Nesting deeper than this is treated as corrupt data instead of risking running out of stack
+constexpr u32 CBOR_MAX_DEPTH = 512;
+
+double decodeHalf(u16 half)
+{
+    u32 exponent = (half >> 10) & 0x1f;
+    u32 mantissa = half & 0x3ff;
+    double value = 0.0;
+    if (exponent == 0)
+    {
+        value = std::ldexp(mantissa, -24);
+    }
+    else if (exponent != 31)
+    {
+        value = std::ldexp(mantissa + 1024, static_cast<i32>(exponent) - 25);
+    }
+    else
+    {
+        value = mantissa == 0 ? INFINITY : NAN;
+    }
+    return (half & 0x8000) != 0 ? -value : value;
+}
+
+class CborDecoder
+{
+public:
+    CborDecoder(const u8* bytes, u64 size) : m_bytes(bytes), m_size(size) {}
+
+    bool decode(JsonObject& root)
+    {
+        MajorType major{};
+        u8 info = 0;
+        u64 argument = 0;
+        if (!readHead(major, info, argument))
+        {
+            return false;
+        }
+        if (major != MajorType::MAP)
+        {
+            return fail("Root item is not a map");
+        }
+        if (!readMembers(root, info, argument, 0))
+        {
+            return false;
+        }
+        if (m_index != m_size)
+        {
+            return fail("Unexpected data after root item");
+        }
+        return true;
+    }
+
+private:
+    bool fail(const char* message)
+    {
+        log(LogLevel::WARNING, "parseCbor(): (byte {}) {}", m_index, message);
+        return false;
+    }
+
+    bool readHead(MajorType& major, u8& info, u64& argument)
+    {
+        if (m_index >= m_size)
+        {
+            return fail("Unexpected end of data");
+        }
+
+        u8 initial = m_bytes[m_index++];
+        major = static_cast<MajorType>(initial >> 5);
+        info = initial & 0x1f;
+        if (info < 24)
+        {
+            argument = info;
+            return true;
+        }
+        if (info == CBOR_INDEFINITE)
+        {
+            if (major == MajorType::UINT || major == MajorType::NEGATIVE_INT || major == MajorType::TAG)
+            {
+                return fail("Indefinite length is not allowed for this type");
+            }
+            argument = 0;
+            return true;
+        }
+        if (info > 27)
+        {
+            return fail("Reserved additional information value");
+        }
+
+        u64 length = 1ull << (info - 24);
+        if (m_size - m_index < length)
+        {
+            return fail("Unexpected end of data");
+        }
+        switch (length)
+        {
+        case 1:
+            argument = m_bytes[m_index];
+            break;
+        case 2:
+            argument = parseFromBytes<u16>(&m_bytes[m_index], std::endian::big);
+            break;
+        case 4:
+            argument = parseFromBytes<u32>(&m_bytes[m_index], std::endian::big);
+            break;
+        default:
+            argument = parseFromBytes<u64>(&m_bytes[m_index], std::endian::big);
+            break;
+        }
+        m_index += length;
+        return true;
+    }
+
+    bool atBreak()
+    {
+        if (m_index < m_size && m_bytes[m_index] == CBOR_BREAK)
+        {
+            ++m_index;
+            return true;
+        }
+        return false;
+    }
+
+    // Appends the content of a byte/text string to out, indefinite strings are concatenated from their chunks
+    template <typename T>
+    bool readString(MajorType major, u8 info, u64 length, T& out)
+    {
+        if (info != CBOR_INDEFINITE)
+        {
+            if (m_size - m_index < length)
+            {
+                return fail("String length exceeds the data");
+            }
+            out.insert(out.end(), &m_bytes[m_index], &m_bytes[m_index + length]);
+            m_index += length;
+            return true;
+        }
+
+        while (!atBreak())
+        {
+            MajorType chunkMajor{};
+            u8 chunkInfo = 0;
+            u64 chunkLength = 0;
+            if (!readHead(chunkMajor, chunkInfo, chunkLength))
+            {
+                return false;
+            }
+            if (chunkMajor != major || chunkInfo == CBOR_INDEFINITE)
+            {
+                return fail("Incorrect chunk in indefinite length string");
+            }
+            if (!readString(major, chunkInfo, chunkLength, out))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool readMembers(JsonObject& object, u8 info, u64 count, u32 depth)
+    {
+        for (u64 i = 0; info == CBOR_INDEFINITE ? !atBreak() : i < count; ++i)
+        {
+            MajorType major{};
+            u8 keyInfo = 0;
+            u64 length = 0;
+            if (!readHead(major, keyInfo, length))
+            {
+                return false;
+            }
+            if (major != MajorType::TEXT_STRING)
+            {
+                return fail("Map key is not a text string");
+            }
+
+            m_key.clear();
+            if (!readString(major, keyInfo, length, m_key) || !readValue(object[m_key], depth + 1))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool readValue(JsonValue& value, u32 depth)
+    {
+        if (depth > CBOR_MAX_DEPTH)
+        {
+            return fail("Maximum nesting depth exceeded");
+        }
+
+        MajorType major{};
+        u8 info = 0;
+        u64 argument = 0;
+        if (!readHead(major, info, argument))
+        {
+            return false;
+        }
+
+        switch (major)
+        {
+        case MajorType::UINT:
+            value = argument;
+            return true;
+
+        case MajorType::NEGATIVE_INT:
+            if (argument <= static_cast<u64>(std::numeric_limits<i64>::max()))
+            {
+                value = -1 - static_cast<i64>(argument);
+            }
+            else
+            {
+                value = -1.0 - static_cast<double>(argument);
+            }
+            return true;
+
+        case MajorType::BYTE_STRING:
+            value = std::vector<u8>();
+            return readString(major, info, argument, value.asBinary());
+
+        case MajorType::TEXT_STRING:
+            value = std::string();
+            return readString(major, info, argument, value.asString());
+
+        case MajorType::ARRAY: {
+            value = JsonArray();
+            JsonArray& array = value.asArray();
+            if (info != CBOR_INDEFINITE)
+            {
+                // Every element takes at least one byte
+                if (argument > m_size - m_index)
+                {
+                    return fail("Array length exceeds the data");
+                }
+                array.reserve(argument);
+            }
+            for (u64 i = 0; info == CBOR_INDEFINITE ? !atBreak() : i < argument; ++i)
+            {
+                if (!readValue(array.emplace_back(value.getParent()), depth + 1))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        case MajorType::MAP:
+            value = JsonObject();
+            return readMembers(value.asObject(), info, argument, depth);
+
+        case MajorType::TAG:
+            return readValue(value, depth + 1);
+
+        case MajorType::SIMPLE:
+            switch (info)
+            {
+            case CBOR_FALSE:
+                value = false;
+                return true;
+            case CBOR_TRUE:
+                value = true;
+                return true;
+            case CBOR_NULL:
+            case CBOR_UNDEFINED:
+                value = nullptr;
+                return true;
+            case CBOR_HALF:
+                value = decodeHalf(static_cast<u16>(argument));
+                return true;
+            case CBOR_SINGLE:
+                value = static_cast<double>(std::bit_cast<float>(static_cast<u32>(argument)));
+                return true;
+            case CBOR_DOUBLE:
+                value = std::bit_cast<double>(argument);
+                return true;
+            case CBOR_INDEFINITE:
+                return fail("Unexpected break code");
+            default:
+                return fail("Unsupported simple value");
+            }
+        }
+        return fail("Unknown major type");
+    }
+
+    const u8* m_bytes{nullptr};
+    u64 m_size{0};
+    u64 m_index{0};
+    std::string m_key;
+};
+
+class CborEncoder
+{
+public:
+    explicit CborEncoder(JsonSink& sink) : m_sink(sink) { m_buffer.reserve(FLUSH_SIZE + 16); }
+    ~CborEncoder() { flush(); }
+
+    CborEncoder(const CborEncoder& rhs) = delete;
+    CborEncoder& operator=(const CborEncoder& rhs) = delete;
+    CborEncoder(CborEncoder&& rhs) = delete;
+    CborEncoder& operator=(CborEncoder&& rhs) = delete;
+
+    void writeObject(JsonObject& object)
+    {
+        writeHead(MajorType::MAP, object.getMembers().size());
+        for (auto& [key, value] : object.getMembers())
+        {
+            writeHead(MajorType::TEXT_STRING, key.length());
+            writeRaw(reinterpret_cast<const u8*>(key.data()), key.length());
+            writeValue(value);
+        }
+    }
+
+    void flush()
+    {
+        if (!m_buffer.empty())
+        {
+            m_sink.write(m_buffer.data(), m_buffer.size());
+            m_buffer.clear();
+        }
+    }
+
+private:
+    static constexpr u64 FLUSH_SIZE = 1 << 16;
+
+    void writeValue(JsonValue& value)
+    {
+        switch (value.getType())
+        {
+        case JsonValue::Type::NIL:
+            writeByte(static_cast<u8>(MajorType::SIMPLE) << 5 | CBOR_NULL);
+            break;
+        case JsonValue::Type::INT: {
+            i64 num = value.asInt();
+            if (num < 0)
+            {
+                writeHead(MajorType::NEGATIVE_INT, static_cast<u64>(-1 - num));
+            }
+            else
+            {
+                writeHead(MajorType::UINT, static_cast<u64>(num));
+            }
+            break;
+        }
+        case JsonValue::Type::UINT:
+            writeHead(MajorType::UINT, value.asUint());
+            break;
+        case JsonValue::Type::FLOAT:
+            writeFloat(value.asFloat());
+            break;
+        case JsonValue::Type::BOOL:
+            writeByte(static_cast<u8>(MajorType::SIMPLE) << 5 | (value.asBool() ? CBOR_TRUE : CBOR_FALSE));
+            break;
+        case JsonValue::Type::STRING: {
+            const std::string& str = value.asString();
+            writeHead(MajorType::TEXT_STRING, str.length());
+            writeRaw(reinterpret_cast<const u8*>(str.data()), str.length());
+            break;
+        }
+        case JsonValue::Type::BINARY: {
+            const std::vector<u8>& bytes = value.asBinary();
+            writeHead(MajorType::BYTE_STRING, bytes.size());
+            writeRaw(bytes.data(), bytes.size());
+            break;
+        }
+        case JsonValue::Type::ARRAY:
+            writeHead(MajorType::ARRAY, value.asArray().size());
+            for (auto& element : value.asArray())
+            {
+                writeValue(element);
+            }
+            break;
+        case JsonValue::Type::OBJECT:
+            writeObject(value.asObject());
+            break;
+        }
+    }
+
+    void writeFloat(double value)
+    {
+        // Single precision is used when no precision is lost, NaN always compares unequal and is kept as double
+        auto single = static_cast<float>(value);
+        if (static_cast<double>(single) == value)
+        {
+            std::array<u8, 5> bytes{static_cast<u8>(static_cast<u8>(MajorType::SIMPLE) << 5 | CBOR_SINGLE)};
+            parseToBytes<u32>(&bytes[1], std::bit_cast<u32>(single), std::endian::big);
+            writeRaw(bytes.data(), bytes.size());
+        }
+        else
+        {
+            std::array<u8, 9> bytes{static_cast<u8>(static_cast<u8>(MajorType::SIMPLE) << 5 | CBOR_DOUBLE)};
+            parseToBytes<u64>(&bytes[1], std::bit_cast<u64>(value), std::endian::big);
+            writeRaw(bytes.data(), bytes.size());
+        }
+    }
+
+    // Shortest encoding of the argument
+    void writeHead(MajorType major, u64 argument)
+    {
+        std::array<u8, 9> bytes{};
+        u8 initial = static_cast<u8>(major) << 5;
+        u64 length = 1;
+        if (argument < 24)
+        {
+            bytes[0] = initial | static_cast<u8>(argument);
+        }
+        else if (argument <= std::numeric_limits<u8>::max())
+        {
+            bytes[0] = initial | 24;
+            bytes[1] = static_cast<u8>(argument);
+            length = 2;
+        }
+        else if (argument <= std::numeric_limits<u16>::max())
+        {
+            bytes[0] = initial | 25;
+            parseToBytes<u16>(&bytes[1], static_cast<u16>(argument), std::endian::big);
+            length = 3;
+        }
+        else if (argument <= std::numeric_limits<u32>::max())
+        {
+            bytes[0] = initial | 26;
+            parseToBytes<u32>(&bytes[1], static_cast<u32>(argument), std::endian::big);
+            length = 5;
+        }
+        else
+        {
+            bytes[0] = initial | 27;
+            parseToBytes<u64>(&bytes[1], argument, std::endian::big);
+            length = 9;
+        }
+        writeRaw(bytes.data(), length);
+    }
+
+    void writeByte(u8 byte) { writeRaw(&byte, 1); }
+
+    void writeRaw(const u8* data, u64 size)
+    {
+        // Large strings go straight to the sink instead of through the buffer
+        if (size >= FLUSH_SIZE)
+        {
+            flush();
+            m_sink.write(data, size);
+            return;
+        }
+        m_buffer.insert(m_buffer.end(), data, data + size);
+        if (m_buffer.size() >= FLUSH_SIZE)
+        {
+            flush();
+        }
+    }
+
+    JsonSink& m_sink;
+    std::vector<u8> m_buffer;
+};
+
+} // namespace
+
+JsonObject parseCbor(const std::vector<u8>& bytes) { return parseCbor(bytes.data(), bytes.size()); }
+
+JsonObject parseCbor(const u8* bytes, u64 size)
+{
+    JsonObject root;
+    CborDecoder decoder(bytes, size);
+    if (!decoder.decode(root))
+    {
+        return {};
+    }
+    return root;
+}
+
+std::vector<u8> serializeCbor(const JsonObject& json)
+{
+    std::vector<u8> bytes;
+    JsonBufferSink sink(bytes);
+    {
+        CborEncoder encoder(sink);
+        // Values are only read, see serializeJson()
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        encoder.writeObject(const_cast<JsonObject&>(json));
+    }
+    return bytes;
+}
+
+bool writeCbor(const std::string& path, const JsonObject& json)
+{
+    JsonFileSink sink(path);
+    if (!sink.isOpen())
+    {
+        log(LogLevel::WARNING, "writeCbor(): Failed to open file: \"{}\"!", path.c_str());
+        return false;
+    }
+
+    {
+        CborEncoder encoder(sink);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        encoder.writeObject(const_cast<JsonObject&>(json));
+    }
+    return sink.good();
+}
+
+} // namespace huedra
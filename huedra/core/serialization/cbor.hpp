@@ -0,0 +1,23 @@
+#pragma once
+
+#include "core/serialization/json.hpp"
+#include "core/types.hpp"
+
+namespace huedra {
+
+// CBOR (RFC 8949) encoding of the json object model, meant for caches that are written by the engine and read back
+// often. Each JsonValue::Type maps to its own CBOR type: negative INT and UINT to major type 1/0, FLOAT to a single
+// or double precision float (whichever is lossless), STRING to text strings, BINARY to byte strings, ARRAY and OBJECT
+// to arrays and maps. Like in text json, non negative integers are read back as UINT.
+//
+// The parser also accepts indefinite length items, half precision floats and tagged items (the tag is ignored). The
+// root item has to be a map with text string keys.
+JsonObject parseCbor(const std::vector<u8>& bytes);
+JsonObject parseCbor(const u8* bytes, u64 size);
+
+std::vector<u8> serializeCbor(const JsonObject& json);
+
+// Streams the serialized cbor directly to the file
+bool writeCbor(const std::string& path, const JsonObject& json);
+
+} // namespace huedra
@@ -1,10 +1,8 @@
 #include "json.hpp"
 
 #include "core/log.hpp"
-
-#include <functional>
-#include <iomanip>
-#include <sstream>
+#include "core/serialization/base64.hpp"
+#include "core/serialization/json_number.hpp"
 
 namespace huedra {
 
@@ -14,6 +12,10 @@ JsonValue::JsonValue(JsonObject* parent, Type desiredType) : m_parent(parent), m
     {
         m_value.str = m_parent->addString("");
     }
+    else if (m_type == Type::BINARY)
+    {
+        m_value.binary = m_parent->addBinary({});
+    }
     else if (m_type == Type::ARRAY)
     {
         m_value.array = m_parent->addArray({});
@@ -30,14 +32,18 @@ JsonValue& JsonValue::operator=(std::nullptr_t /*null*/)
     return *this;
 }
 
-JsonValue& JsonValue::operator=(i32 value)
+JsonValue& JsonValue::operator=(i32 value) { return *this = static_cast<i64>(value); }
+
+JsonValue& JsonValue::operator=(u32 value) { return *this = static_cast<u64>(value); }
+
+JsonValue& JsonValue::operator=(i64 value)
 {
     m_type = Type::INT;
     m_value.iNum = value;
     return *this;
 }
 
-JsonValue& JsonValue::operator=(u32 value)
+JsonValue& JsonValue::operator=(u64 value)
 {
     m_type = Type::UINT;
     m_value.uNum = value;
@@ -79,6 +85,13 @@ JsonValue& JsonValue::operator=(const std::string_view& value)
     return *this;
 }
 
+JsonValue& JsonValue::operator=(const std::vector<u8>& bytes)
+{
+    m_type = Type::BINARY;
+    m_value.binary = m_parent->addBinary(bytes);
+    return *this;
+}
+
 JsonValue& JsonValue::operator=(const JsonArray& values)
 {
     m_type = Type::ARRAY;
@@ -93,7 +106,7 @@ JsonValue& JsonValue::operator=(const JsonObject& value)
     return *this;
 }
 
-i32& JsonValue::asInt()
+i64& JsonValue::asInt()
 {
     if (m_type == Type::NIL)
     {
@@ -102,21 +115,21 @@ i32& JsonValue::asInt()
     }
     else if (m_type != Type::INT)
     {
-        log(LogLevel::ERR, "json value can't be accessed as i32");
+        log(LogLevel::ERR, "json value can't be accessed as i64");
     }
     return m_value.iNum;
 }
 
-u32& JsonValue::asUint()
+u64& JsonValue::asUint()
 {
     if (m_type == Type::NIL)
     {
         m_type = Type::UINT;
-        m_value.uNum = 0u;
+        m_value.uNum = 0;
     }
     else if (m_type != Type::UINT)
     {
-        log(LogLevel::ERR, "json value can't be accessed as u32");
+        log(LogLevel::ERR, "json value can't be accessed as u64");
     }
     return m_value.uNum;
 }
@@ -163,6 +176,20 @@ std::string& JsonValue::asString()
     return *m_value.str;
 }
 
+std::vector<u8>& JsonValue::asBinary()
+{
+    if (m_type == Type::NIL)
+    {
+        m_type = Type::BINARY;
+        m_value.binary = m_parent->addBinary({});
+    }
+    else if (m_type != Type::BINARY)
+    {
+        log(LogLevel::ERR, "json value can't be accessed as binary");
+    }
+    return *m_value.binary;
+}
+
 JsonArray& JsonValue::asArray()
 {
     if (m_type == Type::NIL)
@@ -235,23 +262,17 @@ JsonValue& JsonValue::operator[](const std::string& identifier)
 JsonValue& JsonValue::operator[](const char* str) { return (*this)[std::string(str)]; }
 
 JsonObject::JsonObject(const JsonObject& rhs)
-    : m_strings(rhs.m_strings), m_arrays(rhs.m_arrays), m_objects(rhs.m_objects), m_keys(rhs.m_keys),
-      m_members(rhs.m_members)
+    : m_strings(rhs.m_strings), m_binaries(rhs.m_binaries), m_arrays(rhs.m_arrays), m_objects(rhs.m_objects),
+      m_members(rhs.m_members), m_hashes(rhs.m_hashes), m_index(rhs.m_index)
 {
-    for (auto& [key, value] : m_members)
-    {
-        value.setParent(this);
-    }
+    updateParents();
 }
 
 JsonObject::JsonObject(const JsonObject&& rhs)
-    : m_strings(rhs.m_strings), m_arrays(rhs.m_arrays), m_objects(rhs.m_objects), m_keys(rhs.m_keys),
-      m_members(rhs.m_members)
+    : m_strings(rhs.m_strings), m_binaries(rhs.m_binaries), m_arrays(rhs.m_arrays), m_objects(rhs.m_objects),
+      m_members(rhs.m_members), m_hashes(rhs.m_hashes), m_index(rhs.m_index)
 {
-    for (auto& [key, value] : m_members)
-    {
-        value.setParent(this);
-    }
+    updateParents();
 }
 
 JsonObject& JsonObject::operator=(const JsonObject& rhs)
@@ -262,51 +283,145 @@ JsonObject& JsonObject::operator=(const JsonObject& rhs)
     }
 
     m_strings = rhs.m_strings;
+    m_binaries = rhs.m_binaries;
     m_arrays = rhs.m_arrays;
     m_objects = rhs.m_objects;
-    m_keys = rhs.m_keys;
     m_members = rhs.m_members;
-
-    for (auto& [key, value] : m_members)
-    {
-        value.setParent(this);
-    }
+    m_hashes = rhs.m_hashes;
+    m_index = rhs.m_index;
+    updateParents();
     return *this;
 }
 
 JsonObject& JsonObject::operator=(JsonObject&& rhs)
 {
     m_strings = rhs.m_strings;
+    m_binaries = rhs.m_binaries;
     m_arrays = rhs.m_arrays;
     m_objects = rhs.m_objects;
-    m_keys = rhs.m_keys;
     m_members = rhs.m_members;
-    for (auto& [key, value] : m_members)
-    {
-        value.setParent(this);
-    }
+    m_hashes = rhs.m_hashes;
+    m_index = rhs.m_index;
+    updateParents();
     return *this;
 }
 
 JsonValue& JsonObject::operator[](const std::string& identifier)
 {
-    if (!m_members.contains(identifier))
+    u64 hash = hashJsonKey(identifier);
+    u32 index = findIndex(identifier, hash);
+    if (index != EMPTY_SLOT)
     {
-        m_members.insert(std::pair<std::string, JsonValue>(identifier, JsonValue(this)));
-        m_keys.push_back(identifier);
+        return m_members[index].second;
     }
-    return m_members.at(identifier);
+
+    index = static_cast<u32>(m_members.size());
+    m_members.emplace_back(identifier, JsonValue(this));
+    m_hashes.push_back(hash);
+    insertIndex(index);
+    return m_members.back().second;
 }
 
-bool JsonObject::hasMember(const std::string& identifier) const { return m_members.contains(identifier); }
+bool JsonObject::hasMember(const std::string& identifier) const { return find(identifier) != nullptr; }
 
 bool JsonObject::hasMember(const std::string& identifier, JsonValue::Type type) const
 {
-    if (!m_members.contains(identifier))
+    const JsonValue* value = find(identifier);
+    return value != nullptr && value->getType() == type;
+}
+
+JsonValue* JsonObject::find(std::string_view identifier, u64 hash)
+{
+    u32 index = findIndex(identifier, hash);
+    return index != EMPTY_SLOT ? &m_members[index].second : nullptr;
+}
+
+const JsonValue* JsonObject::find(std::string_view identifier, u64 hash) const
+{
+    u32 index = findIndex(identifier, hash);
+    return index != EMPTY_SLOT ? &m_members[index].second : nullptr;
+}
+
+u32 JsonObject::findIndex(std::string_view identifier, u64 hash) const
+{
+    // Small objects are cheaper to scan than to probe, the hashes are contiguous so this touches one or two cache lines
+    if (m_index.empty())
     {
-        return false;
+        for (u32 i = 0; i < m_hashes.size(); ++i)
+        {
+            if (m_hashes[i] == hash && m_members[i].first == identifier)
+            {
+                return i;
+            }
+        }
+        return EMPTY_SLOT;
+    }
+
+    u64 mask = m_index.size() - 1;
+    for (u64 slot = hash & mask;; slot = (slot + 1) & mask)
+    {
+        u32 index = m_index[slot];
+        if (index == EMPTY_SLOT)
+        {
+            return EMPTY_SLOT;
+        }
+        if (m_hashes[index] == hash && m_members[index].first == identifier)
+        {
+            return index;
+        }
+    }
+}
+
+void JsonObject::insertIndex(u32 memberIndex)
+{
+    if (m_members.size() <= LINEAR_SEARCH_LIMIT)
+    {
+        return;
+    }
+
+    // Keep the load factor at or below 1/2
+    if (m_members.size() * 2 > m_index.size())
+    {
+        rebuildIndex();
+        return;
+    }
+
+    u64 mask = m_index.size() - 1;
+    u64 slot = m_hashes[memberIndex] & mask;
+    while (m_index[slot] != EMPTY_SLOT)
+    {
+        slot = (slot + 1) & mask;
+    }
+    m_index[slot] = memberIndex;
+}
+
+void JsonObject::rebuildIndex()
+{
+    u64 capacity = 16;
+    while (capacity < m_members.size() * 2)
+    {
+        capacity *= 2;
+    }
+    m_index.assign(capacity, EMPTY_SLOT);
+
+    u64 mask = capacity - 1;
+    for (u32 i = 0; i < m_hashes.size(); ++i)
+    {
+        u64 slot = m_hashes[i] & mask;
+        while (m_index[slot] != EMPTY_SLOT)
+        {
+            slot = (slot + 1) & mask;
+        }
+        m_index[slot] = i;
+    }
+}
+
+void JsonObject::updateParents()
+{
+    for (auto& [key, value] : m_members)
+    {
+        value.setParent(this);
     }
-    return m_members.at(identifier).getType() == type;
 }
 
 std::string* JsonObject::addString(const std::string& value)
@@ -315,6 +430,12 @@ std::string* JsonObject::addString(const std::string& value)
     return m_strings.back().get();
 }
 
+std::vector<u8>* JsonObject::addBinary(const std::vector<u8>& bytes)
+{
+    m_binaries.push_back(std::make_shared<std::vector<u8>>(bytes));
+    return m_binaries.back().get();
+}
+
 JsonArray* JsonObject::addArray(const JsonArray& values)
 {
     m_arrays.push_back(std::make_shared<JsonArray>(values));
@@ -624,103 +745,43 @@ JsonObject parseJson(const std::vector<u8>& bytes)
                 break;
             }
 
-            std::string buf;
-            JsonValue::Type type = JsonValue::Type::UINT;
-            if (static_cast<char>(bytes[i]) == '-')
-            {
-                buf.push_back(static_cast<char>(bytes[i++]));
-                type = JsonValue::Type::INT;
-            }
-
             // Number
-            if (static_cast<char>(bytes[i]) == '0')
-            {
-                buf.push_back(static_cast<char>(bytes[i++]));
-            }
-            else if (static_cast<char>(bytes[i]) >= '1' && static_cast<char>(bytes[i]) <= '9')
-            {
-                buf.push_back(static_cast<char>(bytes[i++]));
-                while (static_cast<char>(bytes[i]) >= '0' && static_cast<char>(bytes[i]) <= '9')
-                {
-                    buf.push_back(static_cast<char>(bytes[i++]));
-                }
-            }
-            else
-            {
-                log(LogLevel::WARNING, "parseJson(): ({}, {}) Unexpected character: \'{}\'", line, i - lineStart,
-                    static_cast<char>(bytes[i]));
+            JsonNumber number;
+            const char* error = nullptr;
+            const char* first = reinterpret_cast<const char*>(&bytes[i]);
+            const char* end =
+                parseJsonNumber(first, reinterpret_cast<const char*>(bytes.data() + closeIndex), number, error);
+            if (end == nullptr)
+            {
+                log(LogLevel::WARNING, "parseJson(): ({}, {}) {}", line, i - lineStart, error);
                 return {};
             }
+            i += static_cast<u64>(end - first);
 
-            // Fraction
-            if (static_cast<char>(bytes[i]) == '.')
-            {
-                buf.push_back(static_cast<char>(bytes[i++]));
-                type = JsonValue::Type::FLOAT;
-                if (static_cast<char>(bytes[i]) < '0' || static_cast<char>(bytes[i]) > '9')
-                {
-                    log(LogLevel::WARNING, "parseJson(): ({}, {}) No number defined in fraction", line, i - lineStart);
-                    return {};
-                }
-                while (static_cast<char>(bytes[i]) >= '0' && static_cast<char>(bytes[i]) <= '9')
-                {
-                    buf.push_back(static_cast<char>(bytes[i++]));
-                }
-            }
-
-            // Exponent
-            if (static_cast<char>(bytes[i]) == 'E' || static_cast<char>(bytes[i]) == 'e')
-            {
-                buf.push_back(static_cast<char>(bytes[i++]));
-                type = JsonValue::Type::FLOAT;
-                if (static_cast<char>(bytes[i]) == '-' || static_cast<char>(bytes[i]) == '+')
-                {
-                    buf.push_back(static_cast<char>(bytes[i++]));
-                }
-
-                if (static_cast<char>(bytes[i]) < '0' || static_cast<char>(bytes[i]) > '9')
+            auto assignNumber = [&number](JsonValue& value) {
+                switch (number.type)
                 {
-                    log(LogLevel::WARNING, "parseJson(): ({}, {}) No number defined in exponent", line, i - lineStart);
-                    return {};
-                }
-                while (static_cast<char>(bytes[i]) >= '0' && static_cast<char>(bytes[i]) <= '9')
-                {
-                    buf.push_back(static_cast<char>(bytes[i++]));
+                case JsonNumber::Type::INT:
+                    value = number.iNum;
+                    break;
+                case JsonNumber::Type::UINT:
+                    value = number.uNum;
+                    break;
+                case JsonNumber::Type::FLOAT:
+                    value = number.dNum;
+                    break;
                 }
-            }
+            };
 
             if (states.back() == State::ASSIGNMENT_SET)
             {
-                if (type == JsonValue::Type::UINT)
-                {
-                    *curValues.back() = static_cast<u32>(std::stoul(buf));
-                }
-                else if (type == JsonValue::Type::INT)
-                {
-                    *curValues.back() = static_cast<i32>(std::stol(buf));
-                }
-                else if (type == JsonValue::Type::FLOAT)
-                {
-                    *curValues.back() = std::stod(buf);
-                }
+                assignNumber(*curValues.back());
                 --i;
                 states.back() = State::VALUE_SET;
             }
             else if (states.back() == State::IN_ARRAY || states.back() == State::ARRAY_COMMA_SET)
             {
-                JsonValue& val = curArrays.back()->emplace_back(curValues.back()->getParent());
-                if (type == JsonValue::Type::UINT)
-                {
-                    val = static_cast<u32>(std::stoul(buf));
-                }
-                else if (type == JsonValue::Type::INT)
-                {
-                    val = static_cast<i32>(std::stoul(buf));
-                }
-                else if (type == JsonValue::Type::FLOAT)
-                {
-                    val = std::stod(buf);
-                }
+                assignNumber(curArrays.back()->emplace_back(curValues.back()->getParent()));
                 --i;
                 states.back() = State::ARRAY_VALUE_SET;
             }
@@ -728,7 +789,7 @@ JsonObject parseJson(const std::vector<u8>& bytes)
             {
                 log(LogLevel::WARNING,
                     "parseJson(): ({}, {}) Unexpected number: {}, not setting identifier/array value", line,
-                    i - lineStart, buf.c_str());
+                    i - lineStart, std::string_view(first, end));
                 return {};
             }
             break;
@@ -738,193 +799,96 @@ JsonObject parseJson(const std::vector<u8>& bytes)
     return root;
 }
 
-std::vector<u8> serializeJson(const JsonObject& json)
-{
-    std::vector<u8> bytes;
-
-    std::function<void(JsonValue&, u32)> serializeValue;
-
-    auto serializeObject = [&](JsonObject& object, u32 level = 1) {
-        std::vector<std::string> members = object.getMembers();
-        bytes.push_back('{');
-        if (!members.empty())
-        {
-            bytes.push_back('\n');
-            for (u64 i = 0; i < members.size(); ++i)
-            {
-                bytes.resize(bytes.size() + static_cast<u64>(4 * level), ' ');
-                bytes.push_back('\"');
-                for (auto& c : members[i])
-                {
-                    switch (c)
-                    {
-                    case '\"':
-                        bytes.push_back('\\');
-                        bytes.push_back('\"');
-                        break;
-                    case '\\':
-                        bytes.push_back('\\');
-                        bytes.push_back('\\');
-                        break;
-                    case '\b':
-                        bytes.push_back('\\');
-                        bytes.push_back('b');
-                        break;
-                    case '\f':
-                        bytes.push_back('\\');
-                        bytes.push_back('f');
-                        break;
-                    case '\n':
-                        bytes.push_back('\\');
-                        bytes.push_back('n');
-                        break;
-                    case '\r':
-                        bytes.push_back('\\');
-                        bytes.push_back('r');
-                        break;
-                    case '\t':
-                        bytes.push_back('\\');
-                        bytes.push_back('t');
-                        break;
-                    default:
-                        bytes.push_back(c);
-                        break;
-                    }
-                }
-                bytes.push_back('\"');
-                bytes.push_back(':');
-                bytes.push_back(' ');
+namespace {
 
-                serializeValue(object[members[i]], level);
+void serializeValue(JsonValue& value, JsonWriter& writer);
 
-                if (i != members.size() - 1)
-                {
-                    bytes.push_back(',');
-                }
-                bytes.push_back('\n');
-            }
-            bytes.resize(bytes.size() + static_cast<u64>(4 * (level - 1)), ' ');
-        }
-        bytes.push_back('}');
-    };
+void serializeObject(JsonObject& object, JsonWriter& writer)
+{
+    writer.beginObject();
+    for (auto& [key, value] : object.getMembers())
+    {
+        writer.key(key);
+        serializeValue(value, writer);
+    }
+    writer.endObject();
+}
 
-    serializeValue = [&](JsonValue& value, u32 level) {
-        std::string str;
-        switch (value.getType())
+void serializeValue(JsonValue& value, JsonWriter& writer)
+{
+    switch (value.getType())
+    {
+    case JsonValue::Type::NIL:
+        writer.writeNull();
+        break;
+    case JsonValue::Type::INT:
+        writer.writeInt(value.asInt());
+        break;
+    case JsonValue::Type::UINT:
+        writer.writeUint(value.asUint());
+        break;
+    case JsonValue::Type::FLOAT:
+        writer.writeFloat(value.asFloat());
+        break;
+    case JsonValue::Type::BOOL:
+        writer.writeBool(value.asBool());
+        break;
+    case JsonValue::Type::STRING:
+        writer.writeString(value.asString());
+        break;
+    case JsonValue::Type::BINARY:
+        writer.writeString(encodeBase64(value.asBinary()));
+        break;
+    case JsonValue::Type::ARRAY:
+        writer.beginArray();
+        for (auto& element : value.asArray())
         {
-        case JsonValue::Type::NIL:
-            bytes.push_back('n');
-            bytes.push_back('u');
-            bytes.push_back('l');
-            bytes.push_back('l');
-            break;
-        case JsonValue::Type::INT:
-            str = std::to_string(value.asInt());
-            for (auto& c : str)
-            {
-                bytes.push_back(c);
-            }
-            break;
-        case JsonValue::Type::UINT:
-            str = std::to_string(value.asUint());
-            for (auto& c : str)
-            {
-                bytes.push_back(c);
-            }
-            break;
-        case JsonValue::Type::FLOAT: {
-            std::ostringstream oss;
-            oss << std::setprecision(std::numeric_limits<double>::digits10 + 1) << value.asFloat();
-            str = oss.str();
-            for (auto& c : str)
-            {
-                bytes.push_back(c);
-            }
-            break;
+            serializeValue(element, writer);
         }
-        case JsonValue::Type::BOOL:
-            str = value.asBool() ? "true" : "false";
-            for (auto& c : str)
-            {
-                bytes.push_back(c);
-            }
-            break;
-        case JsonValue::Type::STRING:
-            str = value.asString();
-            bytes.push_back('\"');
-            for (auto& c : str)
-            {
-                switch (c)
-                {
-                case '\"':
-                    bytes.push_back('\\');
-                    bytes.push_back('\"');
-                    break;
-                case '\\':
-                    bytes.push_back('\\');
-                    bytes.push_back('\\');
-                    break;
-                case '\b':
-                    bytes.push_back('\\');
-                    bytes.push_back('b');
-                    break;
-                case '\f':
-                    bytes.push_back('\\');
-                    bytes.push_back('f');
-                    break;
-                case '\n':
-                    bytes.push_back('\\');
-                    bytes.push_back('n');
-                    break;
-                case '\r':
-                    bytes.push_back('\\');
-                    bytes.push_back('r');
-                    break;
-                case '\t':
-                    bytes.push_back('\\');
-                    bytes.push_back('t');
-                    break;
-                default:
-                    bytes.push_back(c);
-                    break;
-                }
-            }
-            bytes.push_back('\"');
-            break;
-        case JsonValue::Type::ARRAY: {
-            bytes.push_back('[');
-            JsonArray& array = value.asArray();
-            if (!array.empty())
-            {
-                bytes.push_back('\n');
-                for (u64 i = 0; i < array.size(); ++i)
-                {
-                    bytes.resize(bytes.size() + static_cast<u64>(4 * (level + 1)), ' ');
-                    serializeValue(value[i], level + 1);
-                    if (i != array.size() - 1)
-                    {
-                        bytes.push_back(',');
-                    }
-                    bytes.push_back('\n');
-                }
-                bytes.resize(bytes.size() + static_cast<u64>(4 * level), ' ');
-            }
-            bytes.push_back(']');
-            break;
-        }
-        case JsonValue::Type::OBJECT:
-            serializeObject(value.asObject(), level + 1);
-            break;
-        }
-    };
+        writer.endArray();
+        break;
+    case JsonValue::Type::OBJECT:
+        serializeObject(value.asObject(), writer);
+        break;
+    }
+}
 
+} // namespace
+
+std::vector<u8> serializeJson(const JsonObject& json, JsonWriter::Format format)
+{
+    std::vector<u8> bytes;
+    JsonBufferSink sink(bytes);
+    {
+        JsonWriter writer(sink, format);
+        serializeJson(json, writer);
+    }
+    return bytes;
+}
+
+void serializeJson(const JsonObject& json, JsonWriter& writer)
+{
     // Const cast is used here since functions of getting members are not const. Since the values aren't altered
     // in the serilization, it will still be handled as const. This could also be fixed by having json as non const
     // parameter but since it signifies to the user that the data will not be altered, this is preferred.
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
-    serializeObject(const_cast<JsonObject&>(json));
+    serializeObject(const_cast<JsonObject&>(json), writer);
+}
 
-    return bytes;
+bool writeJson(const std::string& path, const JsonObject& json, JsonWriter::Format format)
+{
+    JsonFileSink sink(path);
+    if (!sink.isOpen())
+    {
+        log(LogLevel::WARNING, "writeJson(): Failed to open file: \"{}\"!", path.c_str());
+        return false;
+    }
+
+    {
+        JsonWriter writer(sink, format);
+        serializeJson(json, writer);
+    }
+    return sink.good();
 }
 
 } // namespace huedra
\ No newline at end of file
@@ -1,11 +1,25 @@
 #pragma once
 
+#include "core/serialization/json_writer.hpp"
 #include "core/types.hpp"
 
 #include <memory>
+#include <string_view>
 
 namespace huedra {
 
+// FNV-1a, usable at compile time so loaders can hash member names once and look them up with JsonObject::find()
+constexpr u64 hashJsonKey(std::string_view key)
+{
+    u64 hash = 0xcbf29ce484222325ull;
+    for (char c : key)
+    {
+        hash ^= static_cast<u8>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
 class JsonObject;
 class JsonValue;
 using JsonArray = std::vector<JsonValue>;
@@ -15,11 +29,12 @@ class JsonValue
 private:
     union Value
     {
-        i32 iNum;
-        u32 uNum;
+        i64 iNum;
+        u64 uNum;
         double dNum;
         bool boolean;
         std::string* str;
+        std::vector<u8>* binary;
         JsonArray* array;
         JsonObject* object;
     };
@@ -33,6 +48,7 @@ public:
         FLOAT,
         BOOL,
         STRING,
+        BINARY, // Raw bytes, written as a base64 string in text json and as a byte string in cbor
         ARRAY,
         OBJECT
     };
@@ -48,19 +64,23 @@ public:
     JsonValue& operator=(std::nullptr_t null);
     JsonValue& operator=(i32 value);
     JsonValue& operator=(u32 value);
+    JsonValue& operator=(i64 value);
+    JsonValue& operator=(u64 value);
     JsonValue& operator=(double value);
     JsonValue& operator=(bool value);
     JsonValue& operator=(const std::string& value);
     JsonValue& operator=(const char* value);
     JsonValue& operator=(const std::string_view& value);
+    JsonValue& operator=(const std::vector<u8>& bytes);
     JsonValue& operator=(const JsonArray& values);
     JsonValue& operator=(const JsonObject& value);
 
-    i32& asInt();
-    u32& asUint();
+    i64& asInt();
+    u64& asUint();
     double& asFloat();
     bool& asBool();
     std::string& asString();
+    std::vector<u8>& asBinary();
     JsonArray& asArray();
     JsonObject& asObject();
 
@@ -86,11 +106,15 @@ private:
     JsonObject* m_parent{nullptr};
 };
 
+// Members are stored contiguously in insertion order, lookups go through an open addressing hash index once the object
+// grows past a few members. Inserting a member may invalidate references to other members of the same object
 class JsonObject
 {
     friend class JsonValue;
 
 public:
+    using Member = std::pair<std::string, JsonValue>;
+
     JsonObject() = default;
     virtual ~JsonObject() = default;
 
@@ -103,25 +127,47 @@ public:
     bool hasMember(const std::string& identifier) const;
     bool hasMember(const std::string& identifier, JsonValue::Type type) const;
 
-    std::vector<std::string> getMembers() const { return m_keys; }
+    // Returns nullptr if there is no member with the identifier, hash has to be hashJsonKey(identifier)
+    JsonValue* find(std::string_view identifier, u64 hash);
+    const JsonValue* find(std::string_view identifier, u64 hash) const;
+    JsonValue* find(std::string_view identifier) { return find(identifier, hashJsonKey(identifier)); }
+    const JsonValue* find(std::string_view identifier) const { return find(identifier, hashJsonKey(identifier)); }
+
+    std::vector<Member>& getMembers() { return m_members; }
+    const std::vector<Member>& getMembers() const { return m_members; }
 
 private:
+    static constexpr u64 LINEAR_SEARCH_LIMIT = 8;
+    static constexpr u32 EMPTY_SLOT = ~0u;
+
+    u32 findIndex(std::string_view identifier, u64 hash) const;
+    void insertIndex(u32 memberIndex);
+    void rebuildIndex();
+    void updateParents();
+
     std::string* addString(const std::string& value);
+    std::vector<u8>* addBinary(const std::vector<u8>& bytes);
     JsonArray* addArray(const JsonArray& values);
     JsonObject* addObject(const JsonObject& value);
 
     // Collection of pointers to json members with composed of a string/array/object value
     std::vector<std::shared_ptr<std::string>> m_strings;
+    std::vector<std::shared_ptr<std::vector<u8>>> m_binaries;
     std::vector<std::shared_ptr<JsonArray>> m_arrays;
     std::vector<std::shared_ptr<JsonObject>> m_objects;
 
-    std::vector<std::string> m_keys; // Keeping track of insert order
-    std::map<std::string, JsonValue> m_members;
+    std::vector<Member> m_members;
+    std::vector<u64> m_hashes; // Hash of each member key, compared before the keys themselves
+    std::vector<u32> m_index;  // Member indices, power of two sized and left empty while linear search is used
 };
 
 // TODO: Support \u characters
 JsonObject parseJson(const std::vector<u8>& bytes);
 
-std::vector<u8> serializeJson(const JsonObject& json);
+std::vector<u8> serializeJson(const JsonObject& json, JsonWriter::Format format = JsonWriter::Format::PRETTY);
+void serializeJson(const JsonObject& json, JsonWriter& writer);
+
+// Streams the serialized json directly to the file
+bool writeJson(const std::string& path, const JsonObject& json, JsonWriter::Format format = JsonWriter::Format::PRETTY);
 
 } // namespace huedra
\ No newline at end of file
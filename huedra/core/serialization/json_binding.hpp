@@ -0,0 +1,273 @@
+#pragma once
+
+#include "core/log.hpp"
+#include "core/serialization/json.hpp"
+#include "core/serialization/json_reader.hpp"
+#include "core/types.hpp"
+
+#include <tuple>
+
+namespace huedra {
+
+// Declarative mapping from json members to struct members. A struct is made readable by specializing JsonBinding:
+//
+//     template <>
+//     struct JsonBinding<Foo>
+//     {
+//         static constexpr auto fields = std::make_tuple(jsonRequired("count", &Foo::count),
+//                                                        jsonOptional("name", &Foo::name));
+//     };
+//
+// readJson() then fills the struct directly from a JsonReader in a single pass, without building a JsonObject.
+// Values are type checked while reading, unknown members are skipped and missing required members are reported once
+// the object has been read. Optional members keep the value they had before reading.
+//
+// Supported member types: integers (range checked), floating point, bool, std::string, std::optional, std::vector,
+// std::array (element count has to match) and other bound structs.
+template <typename T>
+struct JsonBinding;
+
+template <typename T>
+concept JsonBound = requires { JsonBinding<T>::fields; };
+
+template <typename T, typename M>
+struct JsonField
+{
+    std::string_view name;
+    u64 hash;
+    M T::* member;
+    bool required;
+};
+
+template <typename T, typename M>
+constexpr JsonField<T, M> jsonRequired(std::string_view name, M T::* member)
+{
+    return {name, hashJsonKey(name), member, true};
+}
+
+template <typename T, typename M>
+constexpr JsonField<T, M> jsonOptional(std::string_view name, M T::* member)
+{
+    return {name, hashJsonKey(name), member, false};
+}
+
+template <typename T>
+bool readJson(JsonReader& reader, T& value);
+
+// Reports a binding error at the current position of the reader, always returns false
+inline bool jsonBindingError(const JsonReader& reader, std::string_view message, std::string_view name)
+{
+    log(LogLevel::WARNING, "readJson(): ({}, {}) \"{}\": {}", reader.getLine(), reader.getColumn(), name, message);
+    return false;
+}
+
+template <typename T>
+struct IsStdVector : std::false_type
+{};
+template <typename T>
+struct IsStdVector<std::vector<T>> : std::true_type
+{};
+
+template <typename T>
+struct IsStdArray : std::false_type
+{};
+template <typename T, std::size_t N>
+struct IsStdArray<std::array<T, N>> : std::true_type
+{};
+
+template <typename T>
+struct IsStdOptional : std::false_type
+{};
+template <typename T>
+struct IsStdOptional<std::optional<T>> : std::true_type
+{};
+
+// Reads the current value of the reader into value, the name is only used for error messages
+template <typename T>
+bool readJsonValue(JsonReader& reader, T& value, std::string_view name)
+{
+    using Token = JsonReader::Token;
+    Token token = reader.getToken();
+
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        if (token != Token::BOOL)
+        {
+            return jsonBindingError(reader, "expected bool", name);
+        }
+        value = reader.getBool();
+        return true;
+    }
+    else if constexpr (std::is_integral_v<T>)
+    {
+        if (token == Token::UINT && reader.getUint() <= static_cast<u64>(std::numeric_limits<T>::max()))
+        {
+            value = static_cast<T>(reader.getUint());
+            return true;
+        }
+        if constexpr (std::is_signed_v<T>)
+        {
+            if (token == Token::INT && reader.getInt() >= static_cast<i64>(std::numeric_limits<T>::min()))
+            {
+                value = static_cast<T>(reader.getInt());
+                return true;
+            }
+        }
+        return jsonBindingError(reader, "expected integer in range", name);
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        if (!reader.isNumber())
+        {
+            return jsonBindingError(reader, "expected number", name);
+        }
+        value = static_cast<T>(reader.getFloat());
+        return true;
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+        if (token != Token::STRING)
+        {
+            return jsonBindingError(reader, "expected string", name);
+        }
+        value = reader.getString();
+        return true;
+    }
+    else if constexpr (IsStdOptional<T>::value)
+    {
+        return readJsonValue(reader, value.emplace(), name);
+    }
+    else if constexpr (IsStdVector<T>::value)
+    {
+        if (token != Token::START_ARRAY)
+        {
+            return jsonBindingError(reader, "expected array", name);
+        }
+        value.clear();
+        while (reader.nextElement())
+        {
+            if (!readJsonValue(reader, value.emplace_back(), name))
+            {
+                return false;
+            }
+        }
+        return reader.isValid();
+    }
+    else if constexpr (IsStdArray<T>::value)
+    {
+        if (token != Token::START_ARRAY)
+        {
+            return jsonBindingError(reader, "expected array", name);
+        }
+        u64 count = 0;
+        while (reader.nextElement())
+        {
+            if (count == value.size())
+            {
+                return jsonBindingError(reader, "too many elements", name);
+            }
+            if (!readJsonValue(reader, value[count++], name))
+            {
+                return false;
+            }
+        }
+        if (reader.isValid() && count != value.size())
+        {
+            return jsonBindingError(reader, "too few elements", name);
+        }
+        return reader.isValid();
+    }
+    else if constexpr (JsonBound<T>)
+    {
+        if (token != Token::START_OBJECT)
+        {
+            return jsonBindingError(reader, "expected object", name);
+        }
+        return readJson(reader, value);
+    }
+    else
+    {
+        static_assert(sizeof(T) == 0, "Type has no json binding");
+    }
+}
+
+// The current token of the reader has to be START_OBJECT, on success the END_OBJECT token has been consumed
+template <typename T>
+bool readJson(JsonReader& reader, T& value)
+{
+    static_assert(JsonBound<T>, "Type has no json binding");
+    constexpr auto& fields = JsonBinding<T>::fields;
+    constexpr u64 fieldCount = std::tuple_size_v<std::remove_cvref_t<decltype(fields)>>;
+    static_assert(fieldCount <= 64, "Json bindings are limited to 64 fields");
+
+    u64 found = 0;
+    while (reader.nextMember())
+    {
+        std::string_view key = reader.getKey();
+        u64 hash = hashJsonKey(key);
+
+        // Compare against every field, the hashes are compile time constants so this is a chain of integer compares
+        bool matched = false;
+        bool success = true;
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (([&] {
+                 const auto& field = std::get<I>(fields);
+                 if (matched || field.hash != hash || field.name != key)
+                 {
+                     return;
+                 }
+                 matched = true;
+                 found |= 1ull << I;
+                 success = readJsonValue(reader, value.*field.member, field.name);
+             }()),
+             ...);
+        }(std::make_index_sequence<fieldCount>());
+
+        if (!success)
+        {
+            return false;
+        }
+        if (!matched)
+        {
+            reader.skip();
+        }
+    }
+    if (!reader.isValid())
+    {
+        return false;
+    }
+
+    bool complete = true;
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        (([&] {
+             const auto& field = std::get<I>(fields);
+             if (field.required && (found & (1ull << I)) == 0)
+             {
+                 complete = jsonBindingError(reader, "missing required member", field.name);
+             }
+         }()),
+         ...);
+    }(std::make_index_sequence<fieldCount>());
+    return complete;
+}
+
+// Reads a whole document, the root value has to be an object
+template <typename T>
+bool deserializeJson(const u8* bytes, u64 size, T& value)
+{
+    JsonReader reader(bytes, size);
+    if (reader.next() != JsonReader::Token::START_OBJECT)
+    {
+        log(LogLevel::WARNING, "deserializeJson(): json data is not encapsulated by an object => {{ ... }}");
+        return false;
+    }
+    return readJson(reader, value) && reader.next() == JsonReader::Token::END;
+}
+
+template <typename T>
+bool deserializeJson(const std::vector<u8>& bytes, T& value)
+{
+    return deserializeJson(bytes.data(), bytes.size(), value);
+}
+
+} // namespace huedra
@@ -0,0 +1,143 @@
+#include "json_number.hpp"
+
+#include <charconv>
+
+namespace huedra {
+
+const char* parseJsonNumber(const char* first, const char* last, JsonNumber& number, const char*& error)
+{
+    // Powers of ten that are exactly representable as doubles
+    constexpr std::array<double, 23> exactPowers{1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    constexpr u64 maxExactMantissa = 1ull << 53;
+
+    const char* cur = first;
+    auto isDigit = [&]() { return cur < last && *cur >= '0' && *cur <= '9'; };
+
+    bool negative = false;
+    if (cur < last && *cur == '-')
+    {
+        negative = true;
+        ++cur;
+    }
+
+    if (!isDigit())
+    {
+        error = "Unexpected character";
+        return nullptr;
+    }
+
+    // All digits (integer and fraction) are accumulated in a single scan, the decimal point only moves the exponent
+    u64 mantissa = 0;
+    bool overflow = false;
+    auto addDigit = [&]() {
+        u64 digit = static_cast<u64>(*cur++ - '0');
+        if (overflow || mantissa > (std::numeric_limits<u64>::max() - digit) / 10)
+        {
+            overflow = true;
+            return;
+        }
+        mantissa = (mantissa * 10) + digit;
+    };
+
+    if (*cur == '0')
+    {
+        ++cur;
+    }
+    else
+    {
+        while (isDigit())
+        {
+            addDigit();
+        }
+    }
+
+    bool isFloat = false;
+    i64 exponent = 0;
+
+    // Fraction
+    if (cur < last && *cur == '.')
+    {
+        isFloat = true;
+        ++cur;
+        if (!isDigit())
+        {
+            error = "No number defined in fraction";
+            return nullptr;
+        }
+        while (isDigit())
+        {
+            addDigit();
+            --exponent;
+        }
+    }
+
+    // Exponent
+    if (cur < last && (*cur == 'e' || *cur == 'E'))
+    {
+        isFloat = true;
+        ++cur;
+        bool negativeExponent = false;
+        if (cur < last && (*cur == '-' || *cur == '+'))
+        {
+            negativeExponent = *cur++ == '-';
+        }
+        if (!isDigit())
+        {
+            error = "No number defined in exponent";
+            return nullptr;
+        }
+        i64 explicitExponent = 0;
+        while (isDigit())
+        {
+            // Clamped, anything this large is out of range for doubles anyway
+            explicitExponent = std::min<i64>((explicitExponent * 10) + (*cur++ - '0'), 1'000'000);
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+
+    if (!isFloat && !overflow)
+    {
+        if (!negative)
+        {
+            number.type = JsonNumber::Type::UINT;
+            number.uNum = mantissa;
+            return cur;
+        }
+        if (mantissa <= static_cast<u64>(std::numeric_limits<i64>::max()) + 1)
+        {
+            number.type = JsonNumber::Type::INT;
+            number.iNum = static_cast<i64>(0ull - mantissa);
+            return cur;
+        }
+    }
+
+    number.type = JsonNumber::Type::FLOAT;
+
+    // Fast path: both mantissa and power of ten are exact doubles, a single multiplication/division is then correctly
+    // rounded
+    if (!overflow && mantissa <= maxExactMantissa && exponent >= -22 && exponent <= 22)
+    {
+        auto value = static_cast<double>(mantissa);
+        if (exponent < 0)
+        {
+            value /= exactPowers[static_cast<u64>(-exponent)];
+        }
+        else
+        {
+            value *= exactPowers[static_cast<u64>(exponent)];
+        }
+        number.dNum = negative ? -value : value;
+        return cur;
+    }
+
+    auto [ptr, ec] = std::from_chars(first, cur, number.dNum);
+    if (ec != std::errc() || ptr != cur)
+    {
+        error = "Number out of range";
+        return nullptr;
+    }
+    return cur;
+}
+
+} // namespace huedra
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "core/types.hpp"
+
+namespace huedra {
+
+struct JsonNumber
+{
+    enum class Type
+    {
+        INT,
+        UINT,
+        FLOAT
+    };
+
+    Type type{Type::UINT};
+    union
+    {
+        i64 iNum{0};
+        u64 uNum;
+        double dNum;
+    };
+};
+
+// Locale independent parsing of a json number in [first, last). The type is decided while scanning: integers without
+// fraction/exponent become UINT (or INT if negative) as long as they fit in 64 bits, everything else becomes FLOAT.
+// Returns a pointer past the last character of the number, or nullptr with an error message on failure
+const char* parseJsonNumber(const char* first, const char* last, JsonNumber& number, const char*& error);
+
+} // namespace huedra
@@ -0,0 +1,445 @@
+#include "json_reader.hpp"
+
+#include "core/log.hpp"
+
+#include <charconv>
+#include <cstring>
+
+namespace huedra {
+
+JsonReader::JsonReader(const u8* bytes, u64 size) : m_bytes(bytes), m_size(size) {}
+
+JsonReader::JsonReader(const std::vector<u8>& bytes) : m_bytes(bytes.data()), m_size(bytes.size()) {}
+
+JsonReader::Token JsonReader::next()
+{
+    if (m_token == Token::ERROR)
+    {
+        return m_token;
+    }
+
+    for (;;)
+    {
+        skipWhitespace();
+        if (m_index >= m_size)
+        {
+            if (m_state == State::AFTER_VALUE && m_inObject.empty())
+            {
+                m_token = Token::END;
+                return m_token;
+            }
+            return fail("Unexpected end of data");
+        }
+
+        char c = static_cast<char>(m_bytes[m_index]);
+        switch (m_state)
+        {
+        case State::AFTER_VALUE:
+            if (m_inObject.empty())
+            {
+                return fail("Unexpected character after end of document");
+            }
+            if (c == ',')
+            {
+                ++m_index;
+                m_state = m_inObject.back() ? State::KEY : State::VALUE;
+                continue;
+            }
+            if (c == '}' && m_inObject.back())
+            {
+                ++m_index;
+                m_inObject.pop_back();
+                m_token = Token::END_OBJECT;
+                return m_token;
+            }
+            if (c == ']' && !m_inObject.back())
+            {
+                ++m_index;
+                m_inObject.pop_back();
+                m_token = Token::END_ARRAY;
+                return m_token;
+            }
+            return fail(m_inObject.back() ? "Expected ',' or '}'" : "Expected ',' or ']'");
+
+        case State::KEY_OR_END:
+            if (c == '}')
+            {
+                ++m_index;
+                m_inObject.pop_back();
+                m_state = State::AFTER_VALUE;
+                m_token = Token::END_OBJECT;
+                return m_token;
+            }
+            [[fallthrough]];
+        case State::KEY:
+            if (c != '\"')
+            {
+                return fail("Expected identifier");
+            }
+            if (!readString(m_keyScratch, m_key))
+            {
+                return m_token;
+            }
+            skipWhitespace();
+            if (m_index >= m_size || static_cast<char>(m_bytes[m_index]) != ':')
+            {
+                return fail("Expected ':' after identifier");
+            }
+            ++m_index;
+            m_state = State::VALUE;
+            m_token = Token::KEY;
+            return m_token;
+
+        case State::VALUE_OR_END:
+            if (c == ']')
+            {
+                ++m_index;
+                m_inObject.pop_back();
+                m_state = State::AFTER_VALUE;
+                m_token = Token::END_ARRAY;
+                return m_token;
+            }
+            [[fallthrough]];
+        case State::VALUE:
+            return readValue();
+        }
+    }
+}
+
+void JsonReader::skip()
+{
+    if (m_token == Token::KEY)
+    {
+        next();
+    }
+
+    if (m_token != Token::START_OBJECT && m_token != Token::START_ARRAY)
+    {
+        return;
+    }
+
+    // Only brackets and strings are relevant for finding the end of the subtree, everything else is passed over
+    u64 depth = 1;
+    while (m_index < m_size)
+    {
+        switch (static_cast<char>(m_bytes[m_index++]))
+        {
+        case '\"':
+            while (m_index < m_size && static_cast<char>(m_bytes[m_index]) != '\"')
+            {
+                m_index += static_cast<char>(m_bytes[m_index]) == '\\' ? 2 : 1;
+            }
+            ++m_index;
+            break;
+        case '{':
+        case '[':
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            if (--depth == 0)
+            {
+                m_token = m_inObject.back() ? Token::END_OBJECT : Token::END_ARRAY;
+                m_inObject.pop_back();
+                m_state = State::AFTER_VALUE;
+                return;
+            }
+            break;
+        case '\n':
+            ++m_line;
+            m_lineStart = m_index;
+            break;
+        default:
+            break;
+        }
+    }
+
+    fail("Unexpected end of data while skipping value");
+}
+
+bool JsonReader::nextMember()
+{
+    if (next() != Token::KEY)
+    {
+        if (m_token != Token::END_OBJECT && m_token != Token::ERROR)
+        {
+            fail("Expected identifier");
+        }
+        return false;
+    }
+    return next() != Token::ERROR;
+}
+
+bool JsonReader::nextElement()
+{
+    next();
+    return m_token != Token::END_ARRAY && m_token != Token::ERROR && m_token != Token::END;
+}
+
+double JsonReader::getFloat() const
+{
+    switch (m_token)
+    {
+    case Token::INT:
+        return static_cast<double>(m_number.iNum);
+    case Token::UINT:
+        return static_cast<double>(m_number.uNum);
+    default:
+        return m_number.dNum;
+    }
+}
+
+JsonReader::Token JsonReader::fail(const char* message)
+{
+    log(LogLevel::WARNING, "JsonReader: ({}, {}) {}", m_line, getColumn(), message);
+    m_token = Token::ERROR;
+    return m_token;
+}
+
+void JsonReader::skipWhitespace()
+{
+    while (m_index < m_size)
+    {
+        char c = static_cast<char>(m_bytes[m_index]);
+        if (c == '\n')
+        {
+            ++m_line;
+            m_lineStart = m_index + 1;
+        }
+        else if (c != ' ' && c != '\r' && c != '\t')
+        {
+            return;
+        }
+        ++m_index;
+    }
+}
+
+bool JsonReader::readString(std::string& scratch, std::string_view& str)
+{
+    const char* data = reinterpret_cast<const char*>(m_bytes);
+    u64 start = ++m_index;
+
+    // Fast path, strings without escape characters are returned as views into the source
+    while (m_index < m_size && data[m_index] != '\"' && data[m_index] != '\\')
+    {
+        ++m_index;
+    }
+    if (m_index >= m_size)
+    {
+        fail("Could not find closing \" for string/identifier");
+        return false;
+    }
+    if (data[m_index] == '\"')
+    {
+        str = std::string_view(&data[start], m_index - start);
+        ++m_index;
+        return true;
+    }
+
+    scratch.assign(&data[start], m_index - start);
+    auto readHex = [&](u32& value) -> bool {
+        if (m_index + 4 > m_size)
+        {
+            return false;
+        }
+        auto [ptr, ec] = std::from_chars(&data[m_index], &data[m_index + 4], value, 16);
+        m_index += 4;
+        return ec == std::errc() && ptr == &data[m_index];
+    };
+
+    while (m_index < m_size && data[m_index] != '\"')
+    {
+        if (data[m_index] != '\\')
+        {
+            scratch.push_back(data[m_index++]);
+            continue;
+        }
+
+        if (++m_index >= m_size)
+        {
+            break;
+        }
+        switch (data[m_index++])
+        {
+        case '\"':
+            scratch.push_back('\"');
+            break;
+        case '\\':
+            scratch.push_back('\\');
+            break;
+        case '/':
+            scratch.push_back('/');
+            break;
+        case 'b':
+            scratch.push_back('\b');
+            break;
+        case 'f':
+            scratch.push_back('\f');
+            break;
+        case 'n':
+            scratch.push_back('\n');
+            break;
+        case 'r':
+            scratch.push_back('\r');
+            break;
+        case 't':
+            scratch.push_back('\t');
+            break;
+        case 'u': {
+            u32 codePoint = 0;
+            if (!readHex(codePoint))
+            {
+                fail("Incorrect \\u escape sequence");
+                return false;
+            }
+
+            // Surrogate pair
+            if (codePoint >= 0xd800 && codePoint <= 0xdbff)
+            {
+                u32 low = 0;
+                if (m_index + 2 > m_size || data[m_index] != '\\' || data[m_index + 1] != 'u')
+                {
+                    fail("Missing low surrogate in \\u escape sequence");
+                    return false;
+                }
+                m_index += 2;
+                if (!readHex(low) || low < 0xdc00 || low > 0xdfff)
+                {
+                    fail("Incorrect low surrogate in \\u escape sequence");
+                    return false;
+                }
+                codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+            }
+
+            // Encode as UTF-8
+            if (codePoint < 0x80)
+            {
+                scratch.push_back(static_cast<char>(codePoint));
+            }
+            else if (codePoint < 0x800)
+            {
+                scratch.push_back(static_cast<char>(0xc0 | (codePoint >> 6)));
+                scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+            }
+            else if (codePoint < 0x10000)
+            {
+                scratch.push_back(static_cast<char>(0xe0 | (codePoint >> 12)));
+                scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+                scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+            }
+            else
+            {
+                scratch.push_back(static_cast<char>(0xf0 | (codePoint >> 18)));
+                scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f)));
+                scratch.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+                scratch.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+            }
+            break;
+        }
+        default:
+            --m_index;
+            fail("Unexpected control character");
+            return false;
+        }
+    }
+
+    if (m_index >= m_size)
+    {
+        fail("Could not find closing \" for string/identifier");
+        return false;
+    }
+    ++m_index;
+    str = scratch;
+    return true;
+}
+
+JsonReader::Token JsonReader::readValue()
+{
+    m_state = State::AFTER_VALUE;
+    switch (static_cast<char>(m_bytes[m_index]))
+    {
+    case '{':
+        ++m_index;
+        m_inObject.push_back(true);
+        m_state = State::KEY_OR_END;
+        m_token = Token::START_OBJECT;
+        return m_token;
+    case '[':
+        ++m_index;
+        m_inObject.push_back(false);
+        m_state = State::VALUE_OR_END;
+        m_token = Token::START_ARRAY;
+        return m_token;
+    case '\"':
+        if (readString(m_stringScratch, m_string))
+        {
+            m_token = Token::STRING;
+        }
+        return m_token;
+    case 't':
+    case 'f':
+    case 'n':
+        return readKeyword();
+    default:
+        return readNumber();
+    }
+}
+
+JsonReader::Token JsonReader::readKeyword()
+{
+    auto matches = [&](std::string_view keyword) {
+        return m_size - m_index >= keyword.length() &&
+               std::memcmp(&m_bytes[m_index], keyword.data(), keyword.length()) == 0;
+    };
+
+    if (matches("true"))
+    {
+        m_index += 4;
+        m_boolean = true;
+        m_token = Token::BOOL;
+    }
+    else if (matches("false"))
+    {
+        m_index += 5;
+        m_boolean = false;
+        m_token = Token::BOOL;
+    }
+    else if (matches("null"))
+    {
+        m_index += 4;
+        m_token = Token::NIL;
+    }
+    else
+    {
+        return fail("Unexpected keyword");
+    }
+    return m_token;
+}
+
+JsonReader::Token JsonReader::readNumber()
+{
+    const char* data = reinterpret_cast<const char*>(m_bytes);
+    const char* error = nullptr;
+    const char* end = parseJsonNumber(&data[m_index], &data[m_size], m_number, error);
+    if (end == nullptr)
+    {
+        return fail(error);
+    }
+    m_index = static_cast<u64>(end - data);
+
+    switch (m_number.type)
+    {
+    case JsonNumber::Type::INT:
+        m_token = Token::INT;
+        break;
+    case JsonNumber::Type::UINT:
+        m_token = Token::UINT;
+        break;
+    case JsonNumber::Type::FLOAT:
+        m_token = Token::FLOAT;
+        break;
+    }
+    return m_token;
+}
+
+} // namespace huedra
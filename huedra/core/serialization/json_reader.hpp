@@ -0,0 +1,111 @@
+#pragma once
+
+#include "core/serialization/json_number.hpp"
+#include "core/types.hpp"
+
+#include <string_view>
+
+namespace huedra {
+
+// Pull based json parser. Tokens are read directly from the byte stream on demand, no JsonObject tree is built.
+// Memory usage only depends on the nesting depth of the document, strings are returned as views into the source
+// bytes (or into an internal buffer if they contain escape characters) and are only valid until the next read.
+class JsonReader
+{
+public:
+    enum class Token
+    {
+        NONE,
+        START_OBJECT,
+        END_OBJECT,
+        START_ARRAY,
+        END_ARRAY,
+        KEY,
+        NIL,
+        INT,
+        UINT,
+        FLOAT,
+        BOOL,
+        STRING,
+        END, // End of document
+        ERROR
+    };
+
+    JsonReader(const u8* bytes, u64 size);
+    explicit JsonReader(const std::vector<u8>& bytes);
+    ~JsonReader() = default;
+
+    JsonReader(const JsonReader& rhs) = default;
+    JsonReader& operator=(const JsonReader& rhs) = default;
+    JsonReader(JsonReader&& rhs) = default;
+    JsonReader& operator=(JsonReader&& rhs) = default;
+
+    // Reads the next token, ERROR is returned for every call after the first error
+    Token next();
+
+    // Skips the current value. If the current token starts an object/array, the whole subtree is skipped without
+    // tokenizing it and the current token becomes the matching END_OBJECT/END_ARRAY. If the current token is a KEY,
+    // the value of the member is skipped
+    void skip();
+
+    // Iterates the members of the current object, on success the current token is the first token of the member value
+    // and the key can be retrieved with getKey(). Each member value has to be fully read or skipped before calling
+    // nextMember() again. Returns false at the end of the object or on error
+    bool nextMember();
+
+    // Iterates the elements of the current array, on success the current token is the first token of the element.
+    // Each element has to be fully read or skipped before calling nextElement() again. Returns false at the end of the
+    // array or on error
+    bool nextElement();
+
+    Token getToken() const { return m_token; }
+    bool isValid() const { return m_token != Token::ERROR; }
+
+    std::string_view getKey() const { return m_key; }
+    std::string_view getString() const { return m_string; }
+    i64 getInt() const { return m_number.iNum; }
+    u64 getUint() const { return m_number.uNum; }
+    double getFloat() const; // Any number token
+    bool getBool() const { return m_boolean; }
+
+    bool isNumber() const { return m_token == Token::INT || m_token == Token::UINT || m_token == Token::FLOAT; }
+
+    u64 getLine() const { return m_line; }
+    u64 getColumn() const { return m_index - m_lineStart; }
+
+private:
+    enum class State
+    {
+        VALUE,          // Expects value
+        VALUE_OR_END,   // Expects value or ']', directly after '['
+        KEY,            // Expects key
+        KEY_OR_END,     // Expects key or '}', directly after '{'
+        AFTER_VALUE     // Expects ',', ']', '}' or end of document
+    };
+
+    Token fail(const char* message);
+    void skipWhitespace();
+    bool readString(std::string& scratch, std::string_view& str);
+    Token readValue();
+    Token readKeyword();
+    Token readNumber();
+
+    const u8* m_bytes{nullptr};
+    u64 m_size{0};
+    u64 m_index{0};
+    u64 m_line{1};
+    u64 m_lineStart{0};
+
+    Token m_token{Token::NONE};
+    State m_state{State::VALUE};
+    std::vector<bool> m_inObject; // Stack of open containers, true for objects and false for arrays
+
+    std::string_view m_key;
+    std::string_view m_string;
+    std::string m_keyScratch;
+    std::string m_stringScratch;
+    JsonNumber m_number;
+    bool m_boolean{false};
+};
+
+} // namespace huedra
@@ -0,0 +1,230 @@
+#include "json_writer.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace huedra {
+
+JsonWriter::JsonWriter(JsonSink& sink, Format format) : m_sink(sink), m_format(format), m_buffer(BUFFER_SIZE) {}
+
+JsonWriter::~JsonWriter() { flush(); }
+
+void JsonWriter::beginObject() { beginContainer('{'); }
+
+void JsonWriter::endObject() { endContainer('}'); }
+
+void JsonWriter::beginArray() { beginContainer('['); }
+
+void JsonWriter::endArray() { endContainer(']'); }
+
+void JsonWriter::key(std::string_view key)
+{
+    beginValue();
+    writeEscaped(key);
+    if (m_format == Format::PRETTY)
+    {
+        put(": ", 2);
+    }
+    else
+    {
+        put(':');
+    }
+    m_afterKey = true;
+}
+
+void JsonWriter::writeNull()
+{
+    beginValue();
+    put("null", 4);
+}
+
+void JsonWriter::writeInt(i64 value)
+{
+    beginValue();
+    std::array<char, 24> buf{};
+    auto [ptr, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), value);
+    put(buf.data(), static_cast<u64>(ptr - buf.data()));
+}
+
+void JsonWriter::writeUint(u64 value)
+{
+    beginValue();
+    std::array<char, 24> buf{};
+    auto [ptr, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), value);
+    put(buf.data(), static_cast<u64>(ptr - buf.data()));
+}
+
+void JsonWriter::writeFloat(double value)
+{
+    if (!std::isfinite(value))
+    {
+        writeNull();
+        return;
+    }
+
+    beginValue();
+    std::array<char, 32> buf{};
+    auto [ptr, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), value);
+    u64 len = static_cast<u64>(ptr - buf.data());
+    put(buf.data(), len);
+
+    // Integral values would otherwise be read back as integers
+    if (std::memchr(buf.data(), '.', len) == nullptr && std::memchr(buf.data(), 'e', len) == nullptr)
+    {
+        put(".0", 2);
+    }
+}
+
+void JsonWriter::writeBool(bool value)
+{
+    beginValue();
+    if (value)
+    {
+        put("true", 4);
+    }
+    else
+    {
+        put("false", 5);
+    }
+}
+
+void JsonWriter::writeString(std::string_view value)
+{
+    beginValue();
+    writeEscaped(value);
+}
+
+void JsonWriter::flush()
+{
+    if (m_size != 0)
+    {
+        m_sink.write(m_buffer.data(), m_size);
+        m_size = 0;
+    }
+}
+
+void JsonWriter::beginValue()
+{
+    // Values directly after a key continue on the same line
+    if (m_afterKey)
+    {
+        m_afterKey = false;
+        return;
+    }
+    if (m_empty.empty())
+    {
+        return;
+    }
+
+    if (!m_empty.back())
+    {
+        put(',');
+    }
+    m_empty.back() = false;
+    newLine(m_empty.size());
+}
+
+void JsonWriter::beginContainer(u8 bracket)
+{
+    beginValue();
+    put(bracket);
+    m_empty.push_back(true);
+}
+
+void JsonWriter::endContainer(u8 bracket)
+{
+    bool empty = m_empty.back();
+    m_empty.pop_back();
+    if (!empty)
+    {
+        newLine(m_empty.size());
+    }
+    put(bracket);
+}
+
+void JsonWriter::newLine(u64 depth)
+{
+    if (m_format == Format::COMPACT)
+    {
+        return;
+    }
+
+    put('\n');
+    for (u64 i = 0; i < depth * 4; ++i)
+    {
+        put(' ');
+    }
+}
+
+void JsonWriter::writeEscaped(std::string_view str)
+{
+    put('\"');
+
+    // Characters that don't need escaping are written in runs
+    u64 runStart = 0;
+    for (u64 i = 0; i < str.length(); ++i)
+    {
+        auto c = static_cast<u8>(str[i]);
+        if (c >= 0x20 && c != '\"' && c != '\\')
+        {
+            continue;
+        }
+
+        put(str.data() + runStart, i - runStart);
+        runStart = i + 1;
+        put('\\');
+        switch (c)
+        {
+        case '\"':
+            put('\"');
+            break;
+        case '\\':
+            put('\\');
+            break;
+        case '\b':
+            put('b');
+            break;
+        case '\f':
+            put('f');
+            break;
+        case '\n':
+            put('n');
+            break;
+        case '\r':
+            put('r');
+            break;
+        case '\t':
+            put('t');
+            break;
+        default: {
+            constexpr std::string_view hexDigits = "0123456789abcdef";
+            put("u00", 3);
+            put(hexDigits[c >> 4]);
+            put(hexDigits[c & 0x0f]);
+        }
+        break;
+        }
+    }
+    put(str.data() + runStart, str.length() - runStart);
+
+    put('\"');
+}
+
+void JsonWriter::put(const char* data, u64 size)
+{
+    while (size != 0)
+    {
+        if (m_size == BUFFER_SIZE)
+        {
+            flush();
+        }
+        u64 count = std::min(size, BUFFER_SIZE - m_size);
+        std::memcpy(&m_buffer[m_size], data, count);
+        m_size += count;
+        data += count;
+        size -= count;
+    }
+}
+
+} // namespace huedra
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "core/types.hpp"
+
+#include <fstream>
+#include <string_view>
+
+namespace huedra {
+
+// Destination of serialized data, receives the output of JsonWriter in chunks
+class JsonSink
+{
+public:
+    JsonSink() = default;
+    virtual ~JsonSink() = default;
+
+    JsonSink(const JsonSink& rhs) = default;
+    JsonSink& operator=(const JsonSink& rhs) = default;
+    JsonSink(JsonSink&& rhs) = default;
+    JsonSink& operator=(JsonSink&& rhs) = default;
+
+    virtual void write(const u8* data, u64 size) = 0;
+};
+
+// Appends to a growable byte buffer
+class JsonBufferSink : public JsonSink
+{
+public:
+    explicit JsonBufferSink(std::vector<u8>& bytes) : m_bytes(bytes) {}
+
+    void write(const u8* data, u64 size) override { m_bytes.insert(m_bytes.end(), data, data + size); }
+
+private:
+    std::vector<u8>& m_bytes;
+};
+
+// Streams directly to a file
+class JsonFileSink : public JsonSink
+{
+public:
+    explicit JsonFileSink(const std::string& path) : m_file(path, std::ios::binary) {}
+
+    void write(const u8* data, u64 size) override
+    {
+        m_file.write(reinterpret_cast<const char*>(data), static_cast<i64>(size));
+    }
+
+    bool isOpen() const { return m_file.is_open(); }
+    bool good() const { return m_file.good(); }
+
+private:
+    std::ofstream m_file;
+};
+
+// Serializes json tokens into a fixed size buffer that is flushed to the sink when full, the whole document is never
+// held in memory. Commas, whitespace and indentation are handled by the writer
+class JsonWriter
+{
+public:
+    enum class Format
+    {
+        COMPACT,
+        PRETTY // Members and elements on separate lines, indented by 4 spaces per level
+    };
+
+    explicit JsonWriter(JsonSink& sink, Format format = Format::PRETTY);
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter& rhs) = delete;
+    JsonWriter& operator=(const JsonWriter& rhs) = delete;
+    JsonWriter(JsonWriter&& rhs) = delete;
+    JsonWriter& operator=(JsonWriter&& rhs) = delete;
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    // Has to be followed by exactly one value (or object/array)
+    void key(std::string_view key);
+
+    void writeNull();
+    void writeInt(i64 value);
+    void writeUint(u64 value);
+    void writeFloat(double value); // Shortest representation that round trips, non finite values are written as null
+    void writeBool(bool value);
+    void writeString(std::string_view value);
+
+    // Hands the buffered bytes to the sink, also done automatically on destruction
+    void flush();
+
+private:
+    static constexpr u64 BUFFER_SIZE = 1 << 16;
+
+    void beginValue();
+    void beginContainer(u8 bracket);
+    void endContainer(u8 bracket);
+    void newLine(u64 depth);
+    void writeEscaped(std::string_view str);
+
+    void put(u8 c)
+    {
+        if (m_size == BUFFER_SIZE)
+        {
+            flush();
+        }
+        m_buffer[m_size++] = c;
+    }
+    void put(const char* data, u64 size);
+
+    JsonSink& m_sink;
+    Format m_format{Format::PRETTY};
+
+    std::vector<u8> m_buffer;
+    u64 m_size{0};
+
+    std::vector<bool> m_empty; // Per open container, true until the first member/element has been written
+    bool m_afterKey{false};
+};
+
+} // namespace huedra
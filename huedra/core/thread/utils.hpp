@@ -0,0 +1,56 @@
+#pragma once
+
+#include "core/types.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace huedra {
+
+inline u32 getHardwareThreadCount()
+{
+    u32 count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+// Calls func(index) for every index in [0, count) spread over worker threads and blocks until all calls have returned.
+// Indices are handed out one at a time, so uneven work per index is balanced automatically. The calling thread takes
+// part in the work and nothing is spawned when there is only one index (or one hardware thread)
+template <typename Func>
+void parallelFor(u64 count, Func&& func, u32 maxThreads = 0)
+{
+    u64 threadCount = std::min<u64>(count, maxThreads == 0 ? getHardwareThreadCount() : maxThreads);
+    if (threadCount <= 1)
+    {
+        for (u64 i = 0; i < count; ++i)
+        {
+            func(i);
+        }
+        return;
+    }
+
+    std::atomic<u64> nextIndex{0};
+    auto worker = [&]() {
+        for (u64 i = nextIndex.fetch_add(1); i < count; i = nextIndex.fetch_add(1))
+        {
+            func(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (u64 i = 1; i < threadCount; ++i)
+    {
+        threads.emplace_back(worker);
+    }
+    worker();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+} // namespace huedra
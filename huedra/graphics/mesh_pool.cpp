@@ -0,0 +1,130 @@
+#include "mesh_pool.hpp"
+#include "core/global.hpp"
+
+#include <cstring>
+
+namespace huedra {
+
+void MeshPool::init(u64 vertexSize, u64 pageSize)
+{
+    m_vertexSize = vertexSize;
+    m_pageSize = pageSize;
+}
+
+void MeshPool::cleanup()
+{
+    for (Page& page : m_pages)
+    {
+        global::graphicsManager.removeBuffer(page.vertexBuffer);
+        global::graphicsManager.removeBuffer(page.indexBuffer);
+    }
+    m_pages.clear();
+    m_stagedVertices.clear();
+    m_stagedIndices.clear();
+}
+
+MeshPoolHandle MeshPool::add(const void* vertices, u64 vertexCount, std::span<const u32> indices)
+{
+    if (m_vertexSize == 0)
+    {
+        log(LogLevel::WARNING, "MeshPool::add(): pool has not been initialized");
+        return {};
+    }
+    if (vertexCount == 0 || indices.empty())
+    {
+        log(LogLevel::WARNING, "MeshPool::add(): mesh has no vertices or indices");
+        return {};
+    }
+    if (vertexCount > std::numeric_limits<u32>::max() || indices.size() > std::numeric_limits<u32>::max())
+    {
+        log(LogLevel::WARNING, "MeshPool::add(): mesh with {} vertices and {} indices is too large", vertexCount,
+            indices.size());
+        return {};
+    }
+    for (u32 index : indices)
+    {
+        if (index >= vertexCount)
+        {
+            log(LogLevel::WARNING, "MeshPool::add(): index {} out of range, mesh has {} vertices", index, vertexCount);
+            return {};
+        }
+    }
+
+    // Starts a new page when the mesh does not fit in the staged one, a mesh larger than a page gets its own
+    u64 stagedVertexCount = m_stagedVertices.size() / m_vertexSize;
+    if (!m_stagedIndices.empty() && (m_stagedVertices.size() + (vertexCount * m_vertexSize) > m_pageSize ||
+                                     stagedVertexCount + vertexCount > std::numeric_limits<u32>::max() ||
+                                     m_stagedIndices.size() + indices.size() > std::numeric_limits<u32>::max()))
+    {
+        flush();
+        stagedVertexCount = 0;
+    }
+
+    MeshPoolHandle handle;
+    handle.page = static_cast<u32>(m_pages.size());
+    handle.firstIndex = static_cast<u32>(m_stagedIndices.size());
+    handle.indexCount = static_cast<u32>(indices.size());
+    handle.firstVertex = static_cast<u32>(stagedVertexCount);
+    handle.vertexCount = static_cast<u32>(vertexCount);
+
+    u64 vertexByteOffset = m_stagedVertices.size();
+    m_stagedVertices.resize(vertexByteOffset + (vertexCount * m_vertexSize));
+    std::memcpy(&m_stagedVertices[vertexByteOffset], vertices, vertexCount * m_vertexSize);
+
+    m_stagedIndices.reserve(m_stagedIndices.size() + indices.size());
+    for (u32 index : indices)
+    {
+        m_stagedIndices.push_back(handle.firstVertex + index);
+    }
+    return handle;
+}
+
+void MeshPool::flush()
+{
+    if (m_stagedIndices.empty())
+    {
+        return;
+    }
+
+    Page& page = m_pages.emplace_back();
+    page.vertexBuffer = global::graphicsManager.createBuffer(BufferType::STATIC, HU_BUFFER_USAGE_VERTEX_BUFFER,
+                                                             m_stagedVertices.size(), m_stagedVertices.data());
+    page.indexBuffer =
+        global::graphicsManager.createBuffer(BufferType::STATIC, HU_BUFFER_USAGE_INDEX_BUFFER,
+                                             sizeof(u32) * m_stagedIndices.size(), m_stagedIndices.data());
+
+    // The data lives in the buffers now, the staging memory is released instead of kept for the next page
+    m_stagedVertices = {};
+    m_stagedIndices = {};
+}
+
+void MeshPool::bindPage(RenderContext& renderContext, u32 page, std::span<const Ref<Buffer>> instanceBuffers)
+{
+    if (page >= m_pages.size())
+    {
+        log(LogLevel::WARNING, "MeshPool::bindPage(): page {} has not been flushed, pool has {} pages", page,
+            m_pages.size());
+        return;
+    }
+    std::vector<Ref<Buffer>> vertexBuffers{m_pages[page].vertexBuffer};
+    vertexBuffers.insert(vertexBuffers.end(), instanceBuffers.begin(), instanceBuffers.end());
+    renderContext.bindVertexBuffers(vertexBuffers);
+    renderContext.bindIndexBuffer(m_pages[page].indexBuffer);
+}
+
+void MeshPool::draw(RenderContext& renderContext, const MeshPoolHandle& handle, u32 instanceCount, u32 instanceOffset)
+{
+    renderContext.drawIndexed(handle.indexCount, instanceCount, handle.firstIndex, instanceOffset);
+}
+
+Ref<Buffer> MeshPool::getVertexBuffer(u32 page)
+{
+    return page < m_pages.size() ? m_pages[page].vertexBuffer : Ref<Buffer>(nullptr);
+}
+
+Ref<Buffer> MeshPool::getIndexBuffer(u32 page)
+{
+    return page < m_pages.size() ? m_pages[page].indexBuffer : Ref<Buffer>(nullptr);
+}
+
+} // namespace huedra
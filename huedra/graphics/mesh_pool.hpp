@@ -0,0 +1,90 @@
+#pragma once
+
+#include "core/log.hpp"
+#include "core/references/ref.hpp"
+#include "core/types.hpp"
+#include "graphics/buffer.hpp"
+#include "graphics/render_context.hpp"
+
+#include <span>
+
+namespace huedra {
+
+// Location of a mesh in a MeshPool. Indices are rebased onto the vertices of the page when the mesh is added, so a
+// draw only needs the page bound and the index range
+struct MeshPoolHandle
+{
+    u32 page{0};
+    u32 firstIndex{0};
+    u32 indexCount{0};
+    u32 firstVertex{0};
+    u32 vertexCount{0};
+};
+
+// Suballocates static meshes with the same vertex layout into a few large vertex and index buffers (pages), draws of
+// meshes in the same page share their bindings and only differ in their index range. Added meshes are staged on the
+// cpu and uploaded by flush(), which also happens when the staged page is full. Static data can't be freed one mesh at
+// a time, cleanup() removes all pages
+class MeshPool
+{
+public:
+    static constexpr u64 DEFAULT_PAGE_SIZE = 64ull << 20; // Vertex bytes, larger meshes get a page of their own
+
+    MeshPool() = default;
+    ~MeshPool() = default;
+
+    MeshPool(const MeshPool& rhs) = delete;
+    MeshPool& operator=(const MeshPool& rhs) = delete;
+    MeshPool(MeshPool&& rhs) = default;
+    MeshPool& operator=(MeshPool&& rhs) = default;
+
+    void init(u64 vertexSize, u64 pageSize = DEFAULT_PAGE_SIZE);
+    void cleanup();
+
+    // vertices holds vertexCount vertices of the size given to init(), indices are relative to them. The handle can be
+    // drawn once its page has been flushed, an empty handle is returned if the mesh could not be added
+    MeshPoolHandle add(const void* vertices, u64 vertexCount, std::span<const u32> indices);
+    template <typename T>
+    MeshPoolHandle add(std::span<const T> vertices, std::span<const u32> indices)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Vertices are copied as bytes");
+        if (sizeof(T) != m_vertexSize)
+        {
+            log(LogLevel::WARNING, "MeshPool::add(): vertex size {} does not match the pool vertex size {}", sizeof(T),
+                m_vertexSize);
+            return {};
+        }
+        return add(vertices.data(), vertices.size(), indices);
+    }
+
+    // Uploads the staged meshes into a new page
+    void flush();
+
+    // Draws of meshes in the same page can be issued back to back after binding it once. Instance buffers are bound
+    // after the vertex buffer of the page, in the order of the instance rate streams of the pipeline
+    void bindPage(RenderContext& renderContext, u32 page, std::span<const Ref<Buffer>> instanceBuffers = {});
+    void draw(RenderContext& renderContext, const MeshPoolHandle& handle, u32 instanceCount = 1,
+              u32 instanceOffset = 0);
+
+    u32 getPageCount() const { return static_cast<u32>(m_pages.size()); }
+    u64 getVertexSize() const { return m_vertexSize; }
+    Ref<Buffer> getVertexBuffer(u32 page);
+    Ref<Buffer> getIndexBuffer(u32 page);
+
+private:
+    struct Page
+    {
+        Ref<Buffer> vertexBuffer;
+        Ref<Buffer> indexBuffer;
+    };
+
+    u64 m_vertexSize{0};
+    u64 m_pageSize{DEFAULT_PAGE_SIZE};
+    std::vector<Page> m_pages;
+
+    // Meshes of the next page
+    std::vector<u8> m_stagedVertices;
+    std::vector<u32> m_stagedIndices;
+};
+
+} // namespace huedra
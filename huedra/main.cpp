@@ -4,6 +4,7 @@
 #include "core/serialization/json.hpp"
 #include "core/string/utils.hpp"
 #include "core/types.hpp"
+#include "graphics/mesh_pool.hpp"
 #include "graphics/pipeline_builder.hpp"
 #include "graphics/pipeline_data.hpp"
 #include "graphics/render_context.hpp"
@@ -15,11 +16,17 @@
 #include "math/matrix_transform.hpp"
 #include "math/vec2.hpp"
 #include "math/vec3.hpp"
-#include "resources/font/data.hpp"
-#include "resources/font/loader.hpp"
+#include "resources/font/font.hpp"
+#include "resources/font/glyph_atlas.hpp"
 #include "resources/mesh/loader.hpp"
+#include "resources/mesh/simplifier.hpp"
+#include "resources/mesh/vertex_stream.hpp"
 #include "resources/texture/loader.hpp"
+#include "scene/components/mesh_instance.hpp"
+#include "scene/components/parent.hpp"
 #include "scene/components/transform.hpp"
+#include "scene/mesh_importer.hpp"
+#include <algorithm>
 #include <cctype>
 
 using namespace huedra;
@@ -31,47 +38,72 @@ int main()
     global::graphicsManager.init();
     global::resourceManager.init();
 
-    FontData font = loadTtf("assets/fonts/ManufacturingConsent-Regular.ttf");
+    Font font;
+    if (!font.load("assets/fonts/ManufacturingConsent-Regular.ttf"))
+    {
+        log(LogLevel::ERR, "Could not load font, text is not drawn");
+    }
 
     Ref<Window> window = global::windowManager.addWindow("Main", WindowInput(1280, 720));
 
     // Draw data
-    std::vector<MeshData>& meshes = global::resourceManager.loadMeshData("assets/mesh/untitled.glb");
+    const std::string meshPath = "assets/mesh/untitled.glb";
+    const MeshLodSettings meshLodSettings{.lodCount = 3};
+    std::vector<MeshData>& meshes = global::resourceManager.loadMeshData(meshPath, meshLodSettings);
 
     if (meshes.empty())
     {
         log(LogLevel::ERR, "meshes array is empty");
     }
-    if (meshes[0].uvs.empty())
+
+    // Static meshes share the vertex and index buffers of the pool, every mesh is stored as the full mesh followed by
+    // its lods
+    struct GpuMesh
     {
-        log(LogLevel::ERR, "Imported mesh: {} has no uv coordinates", meshes[0].name.c_str());
-    }
-    if (meshes[0].normals.empty())
+        MeshPoolHandle handle;
+        Ref<Buffer> dequantizationBuffer;
+    };
+    MeshPool meshPool;
+    meshPool.init(sizeof(QuantizedVertex));
+    std::vector<GpuMesh> gpuMeshes;
+    for (MeshData& meshData : meshes)
     {
-        log(LogLevel::ERR, "Imported mesh: {} has no normals", meshes[0].name.c_str());
-    }
+        if (meshData.uvs.empty())
+        {
+            log(LogLevel::ERR, "Imported mesh: {} has no uv coordinates", meshData.name.c_str());
+        }
+
+        for (u64 i = 0; i < meshData.lods.size(); ++i)
+        {
+            log(LogLevel::INFO, "Mesh lod {}: {} triangles, error: {}", i + 1, meshData.lods[i].indexCount / 3,
+                meshData.lods[i].error);
+        }
 
-    Ref<Buffer> positionsBuffer =
-        global::graphicsManager.createBuffer(BufferType::STATIC, HU_BUFFER_USAGE_VERTEX_BUFFER,
-                                             sizeof(vec3) * meshes[0].positions.size(), meshes[0].positions.data());
+        log(LogLevel::INFO, "Mesh: {} has {} meshlets", meshData.name.c_str(), meshData.meshlets.size());
 
-    Ref<Buffer> uvsBuffer = global::graphicsManager.createBuffer(
-        BufferType::STATIC, HU_BUFFER_USAGE_VERTEX_BUFFER, sizeof(vec2) * meshes[0].uvs.size(), meshes[0].uvs.data());
+        // Single interleaved stream with quantized attributes, dequantized in the vertex shader
+        QuantizedVertexStream vertexStream = buildQuantizedVertexStream(meshData);
+        GpuMesh& gpuMesh = gpuMeshes.emplace_back();
+        gpuMesh.dequantizationBuffer =
+            global::graphicsManager.createBuffer(BufferType::STATIC, HU_BUFFER_USAGE_CONSTANT_BUFFER,
+                                                 sizeof(VertexDequantization), &vertexStream.dequantization);
 
-    Ref<Buffer> normalsBuffer =
-        global::graphicsManager.createBuffer(BufferType::STATIC, HU_BUFFER_USAGE_VERTEX_BUFFER,
-                                             sizeof(vec3) * meshes[0].normals.size(), meshes[0].normals.data());
-    Ref<Buffer> indexBuffer =
-        global::graphicsManager.createBuffer(BufferType::STATIC, HU_BUFFER_USAGE_INDEX_BUFFER,
-                                             sizeof(u32) * meshes[0].indices.size(), meshes[0].indices.data());
+        std::vector<u32> indices(meshData.indices);
+        indices.insert(indices.end(), meshData.lodIndices.begin(), meshData.lodIndices.end());
+        gpuMesh.handle = meshPool.add(std::span<const QuantizedVertex>(vertexStream.vertices), indices);
+    }
+    meshPool.flush();
 
-    // Scene Entities
+    // Scene Entities, every cell of the grid holds a copy of the node hierarchy of the mesh file. The copies share the
+    // mesh data, so all instances of a mesh at the same lod are drawn together
     const u32 numEnities = 7;
+    std::vector<Entity> cellEntities;
+    std::vector<Entity> meshEntities;
     for (u32 x = 0; x < numEnities; ++x)
     {
         for (u32 y = 0; y < numEnities; ++y)
         {
-            Entity e = global::sceneManager.addEntity();
+            Entity cell = global::sceneManager.addEntity();
             Transform transform;
             transform.position = vec3(-(numEnities / 2.0f) + static_cast<float>(x) + 0.5f,
                                       -(numEnities / 2.0f) + static_cast<float>(y) + 0.5f, 0.0f) *
@@ -79,10 +111,38 @@ int main()
             transform.rotation =
                 vec3(math::radians(15) * static_cast<float>(x), math::radians(15) * static_cast<float>(y), 0.0f);
             transform.scale = vec3(1.0f);
-            global::sceneManager.setComponent(e, transform);
+            global::sceneManager.setComponent(cell, transform);
+            cellEntities.push_back(cell);
+
+            for (Entity entity : importMeshScene(global::sceneManager, meshPath, meshLodSettings))
+            {
+                if (!global::sceneManager.hasComponents<Parent>(entity))
+                {
+                    global::sceneManager.setComponent(entity, Parent{.entity = cell});
+                }
+                if (global::sceneManager.hasComponents<MeshInstance>(entity))
+                {
+                    meshEntities.push_back(entity);
+                }
+            }
         }
     }
 
+    // Model matrices of the mesh instances, rewritten every frame sorted by mesh and lod
+    struct InstanceBatch
+    {
+        u32 mesh{0};
+        u32 lod{0};
+        u32 firstInstance{0};
+        u32 instanceCount{0};
+    };
+    std::vector<InstanceBatch> instanceBatches;
+    std::vector<std::pair<u64, matrix4>> sortedInstances; // Mesh in the high bits of the key, lod in the low bits
+    std::vector<matrix4> instanceMatrices;
+    Ref<Buffer> instanceBuffer =
+        global::graphicsManager.createBuffer(BufferType::DYNAMIC, HU_BUFFER_USAGE_VERTEX_BUFFER,
+                                             sizeof(matrix4) * std::max<u64>(meshEntities.size(), 1));
+
     // Shader Resources
     WindowRect rect = window->getRect();
     matrix4 viewProj = math::perspective(math::radians(45),
@@ -93,6 +153,8 @@ int main()
     Ref<Buffer> viewProjBuffer = global::graphicsManager.createBuffer(
         BufferType::DYNAMIC, HU_BUFFER_USAGE_CONSTANT_BUFFER, sizeof(viewProj), &viewProj);
 
+    vec3 eye(0.0f, 0.0f, 12.0f);
+
     TextureData& tex = global::resourceManager.loadTextureData("assets/textures/test.png", TexelChannelFormat::RGBA);
     Ref<Texture> texture = global::graphicsManager.createTexture(tex);
 
@@ -101,31 +163,44 @@ int main()
     builder.init(PipelineType::GRAPHICS)
         .addShader(shaderModule, "vertMain")
         .addShader(shaderModule, "fragMain")
-        .addVertexInputStream({.size = sizeof(vec3),
-                               .inputRate = VertexInputRate::VERTEX,
-                               .attributes{{.format = GraphicsDataFormat::RGB_32_FLOAT, .offset = 0}}})
-        .addVertexInputStream({.size = sizeof(vec2),
-                               .inputRate = VertexInputRate::VERTEX,
-                               .attributes{{.format = GraphicsDataFormat::RG_32_FLOAT, .offset = 0}}})
-        .addVertexInputStream({.size = sizeof(vec3),
-                               .inputRate = VertexInputRate::VERTEX,
-                               .attributes{{.format = GraphicsDataFormat::RGB_32_FLOAT, .offset = 0}}})
+        .addVertexInputStream(getQuantizedVertexInputStream())
+        .addVertexInputStream(
+            {.size = sizeof(matrix4),
+             .inputRate = VertexInputRate::INSTANCE,
+             .attributes = {{.format = GraphicsDataFormat::RGBA_32_FLOAT, .offset = 0},
+                            {.format = GraphicsDataFormat::RGBA_32_FLOAT, .offset = sizeof(vec4)},
+                            {.format = GraphicsDataFormat::RGBA_32_FLOAT, .offset = sizeof(vec4) * 2},
+                            {.format = GraphicsDataFormat::RGBA_32_FLOAT, .offset = sizeof(vec4) * 3}}})
         .setPrimitive(PrimitiveType::TRIANGLE, PrimitiveLayout::TRIANGLE_LIST);
 
-    RenderCommands commands = [&meshes, positionsBuffer, uvsBuffer, normalsBuffer, indexBuffer, viewProjBuffer, texture,
-                               numEnities](RenderContext& renderContext) {
-        renderContext.bindVertexBuffers({positionsBuffer, uvsBuffer, normalsBuffer});
-        renderContext.bindIndexBuffer(indexBuffer);
+    RenderCommands commands = [&meshes, &gpuMeshes, &meshPool, &instanceBatches, instanceBuffer, viewProjBuffer,
+                               texture](RenderContext& renderContext) {
         renderContext.bindBuffer(viewProjBuffer, "cameraMatrix");
         renderContext.bindTexture(texture, "resources.texture");
         renderContext.bindSampler(SAMPLER_LINEAR, "resources.sampler");
 
-        global::sceneManager.query<Transform>([&](Transform& transform) {
-            transform.rotation += vec3(math::radians(5), math::radians(10), 0.0f) * global::timer.dt();
-            matrix4 mat = transform.applyMatrix();
-            renderContext.setParameter(&mat, sizeof(matrix4), "modelMatrix");
-            renderContext.drawIndexed(static_cast<u32>(meshes[0].indices.size()), 1, 0, 0);
-        });
+        std::array<Ref<Buffer>, 1> instanceBuffers{instanceBuffer};
+        u32 boundPage = ~0u;
+        for (const InstanceBatch& batch : instanceBatches)
+        {
+            const GpuMesh& gpuMesh = gpuMeshes[batch.mesh];
+            if (gpuMesh.handle.page != boundPage)
+            {
+                meshPool.bindPage(renderContext, gpuMesh.handle.page, instanceBuffers);
+                boundPage = gpuMesh.handle.page;
+            }
+            renderContext.bindBuffer(gpuMesh.dequantizationBuffer, "dequantization");
+
+            const MeshData& meshData = meshes[batch.mesh];
+            u32 indexCount = static_cast<u32>(meshData.indices.size());
+            u32 indexOffset = gpuMesh.handle.firstIndex;
+            if (batch.lod > 0)
+            {
+                indexOffset += indexCount + meshData.lods[batch.lod - 1].indexOffset;
+                indexCount = meshData.lods[batch.lod - 1].indexCount;
+            }
+            renderContext.drawIndexed(indexCount, batch.instanceCount, indexOffset, batch.firstInstance);
+        }
     };
 
     // Deffered compute pass resources
@@ -162,7 +237,8 @@ int main()
     {
         vec2 position;
         vec2 size;
-        uvec2 contourRange;
+        vec2 uvMin;
+        vec2 uvMax;
     };
 
     ShaderModule& fontShaderModule = global::resourceManager.loadShaderModule("assets/shaders/font.slang");
@@ -175,92 +251,86 @@ int main()
              .inputRate = huedra::VertexInputRate::INSTANCE,
              .attributes = {{.format = GraphicsDataFormat::RG_32_FLOAT, .offset = 0},
                             {.format = GraphicsDataFormat::RG_32_FLOAT, .offset = sizeof(vec2)},
-                            {.format = GraphicsDataFormat::R_32_UINT, .offset = sizeof(vec2) * 2},
-                            {.format = GraphicsDataFormat::R_32_UINT, .offset = (sizeof(vec2) * 2) + sizeof(u32)}}});
+                            {.format = GraphicsDataFormat::RG_32_FLOAT, .offset = sizeof(vec2) * 2},
+                            {.format = GraphicsDataFormat::RG_32_FLOAT, .offset = sizeof(vec2) * 3}}});
 
     std::array<u32, 6> quadIndexValues{0, 1, 2, 1, 3, 2};
     Ref<Buffer> quadIndexBuffer = global::graphicsManager.createBuffer(
         BufferType::STATIC, HU_BUFFER_USAGE_INDEX_BUFFER, sizeof(u32) * quadIndexValues.size(), quadIndexValues.data());
 
+    // Distance fields of the printable ascii range, read from the disk cache after the first run
+    std::vector<u32> atlasGlyphIndices;
+    for (char32_t character = U' '; character <= U'~'; ++character)
+    {
+        atlasGlyphIndices.push_back(font.getGlyphIndex(character));
+    }
+    GlyphAtlas glyphAtlas = loadGlyphAtlas(font, atlasGlyphIndices);
+    Ref<Texture> glyphAtlasTexture;
+    if (glyphAtlas.pages.empty())
+    {
+        log(LogLevel::ERR, "Glyph atlas has no pages, text is not drawn");
+    }
+    else
+    {
+        if (glyphAtlas.pages.size() > 1)
+        {
+            log(LogLevel::WARNING, "Glyph atlas has {} pages, only the first one is drawn", glyphAtlas.pages.size());
+        }
+        glyphAtlasTexture = global::graphicsManager.createTexture(glyphAtlas.pages[0]);
+    }
+
     struct alignas(16)
     {
         vec2 position;
         vec2 size;
         matrix4 projection;
+        float pixelRange;
     } fontInfo{.position = vec2(static_cast<float>(window->getScreenSize().x / 2.0f) - 150.0f, 50.0f),
                .size = vec2(64.0f),
                .projection = math::ortho(vec2(0, static_cast<float>(window->getScreenSize().x)),
-                                         vec2(0, static_cast<float>(window->getScreenSize().y)), vec2(0.0f, 1.0f))};
+                                         vec2(0, static_cast<float>(window->getScreenSize().y)), vec2(0.0f, 1.0f)),
+               .pixelRange = glyphAtlas.settings.pixelRange};
     Ref<Buffer> fontInfoBuffer = global::graphicsManager.createBuffer(
         BufferType::DYNAMIC, HU_BUFFER_USAGE_CONSTANT_BUFFER, sizeof(fontInfo), &fontInfo);
 
-    std::vector<vec2> glyphPoints;
-
-    struct ContourRange
-    {
-        u32 start{0};
-        u32 end{0};
-    };
-    std::vector<ContourRange> contourPointRanges;
-    std::vector<ContourRange> glyphContourRanges(font.glyphs.size());
-    for (u32 i = 0; i < font.glyphs.size(); ++i)
-    {
-        glyphContourRanges[i].start = contourPointRanges.size();
-        glyphContourRanges[i].end = contourPointRanges.size() + font.glyphs[i].contourRanges.size() - 1;
-
-        ContourRange contourRange;
-        for (auto& range : font.glyphs[i].contourRanges)
-        {
-            contourRange.start = range.start + glyphPoints.size();
-            contourRange.end = range.end + glyphPoints.size();
-            contourPointRanges.push_back(contourRange);
-        }
-
-        auto min = static_cast<ivec2>(font.glyphs[i].min);
-        ivec2 dim = static_cast<ivec2>(font.glyphs[i].max) - min;
-        for (auto& point : font.glyphs[i].points)
-        {
-            glyphPoints.push_back(static_cast<vec2>((point.position - min)) / static_cast<vec2>(dim));
-        }
-    }
-
-    Ref<Buffer> fontPointDataBuffer = global::graphicsManager.createBuffer(
-        BufferType::STATIC, HU_BUFFER_USAGE_STRUCTURED_BUFFER, sizeof(vec2) * glyphPoints.size(), glyphPoints.data());
-    Ref<Buffer> fontContourPointRangesBuffer = global::graphicsManager.createBuffer(
-        BufferType::STATIC, HU_BUFFER_USAGE_STRUCTURED_BUFFER, sizeof(ContourRange) * contourPointRanges.size(),
-        contourPointRanges.data());
-
     std::string renderText{"Hello World!"};
+    std::u32string renderCharacters(renderText.begin(), renderText.end());
+
+    auto pageSize = static_cast<float>(glyphAtlas.settings.pageSize);
     vec2 cursor{0.0f};
     std::vector<TextData> textData;
     Ref<Buffer> textBuffer;
-    for (u32 i = 0; i < renderText.length(); ++i)
+    for (char32_t character : renderCharacters)
     {
-        u32 glyphIndex = font.characterMappings[static_cast<u32>(static_cast<unsigned char>(renderText[i]))];
-        if (renderText[i] == ' ')
+        if (character == '\n')
         {
-            cursor.x += 0.33f * static_cast<float>(font.unitsPerEm);
+            cursor.y -= 1.0f;
+            cursor.x = 0.0f;
+            continue;
         }
-        else if (renderText[i] == '\n')
+
+        const AtlasGlyph* glyph = glyphAtlas.findGlyph(font.getGlyphIndex(character));
+        if (glyph == nullptr)
         {
-            cursor.y -= 1.0f * static_cast<float>(font.unitsPerEm);
-            cursor.x = 0.0f;
+            continue;
         }
-        else
+        if (glyph->size.x > 0 && glyph->page == 0)
         {
             TextData text;
-            text.position =
-                (static_cast<vec2>(font.glyphs[glyphIndex].min) + cursor) / static_cast<float>(font.unitsPerEm);
-            text.size = static_cast<vec2>(font.glyphs[glyphIndex].max - font.glyphs[glyphIndex].min) /
-                        static_cast<float>(font.unitsPerEm);
-            text.contourRange.x = glyphContourRanges[glyphIndex].start;
-            text.contourRange.y = glyphContourRanges[glyphIndex].end;
+            text.position = glyph->planeMin + cursor;
+            text.size = glyph->planeMax - glyph->planeMin;
+            text.uvMin = static_cast<vec2>(glyph->position) / pageSize;
+            text.uvMax = static_cast<vec2>(glyph->position + glyph->size) / pageSize;
             textData.push_back(text);
-            cursor.x += static_cast<float>(font.glyphs[glyphIndex].advanceWidth);
         }
+        cursor.x += glyph->advance;
+    }
+    bool drawText = glyphAtlasTexture.valid() && !textData.empty();
+    if (drawText)
+    {
+        textBuffer = global::graphicsManager.createBuffer(BufferType::STATIC, HU_BUFFER_USAGE_VERTEX_BUFFER,
+                                                          sizeof(TextData) * textData.size(), textData.data());
     }
-    textBuffer = global::graphicsManager.createBuffer(BufferType::STATIC, HU_BUFFER_USAGE_VERTEX_BUFFER,
-                                                      sizeof(TextData) * textData.size(), textData.data());
 
     bool renderCursor{true};
     u32 cursorIndex{static_cast<u32>(renderText.length())};
@@ -268,17 +338,15 @@ int main()
     cursorBlinkTimer.init();
 
     RenderCommands fontRenderCommands = [&fontInfoBuffer, &fontInfo, &quadIndexBuffer, &cursorIndex, &textData,
-                                         &textBuffer, &fontPointDataBuffer,
-                                         &fontContourPointRangesBuffer](RenderContext& renderContext) {
+                                         &textBuffer, &glyphAtlasTexture](RenderContext& renderContext) {
         renderContext.bindVertexBuffers({textBuffer});
         renderContext.bindIndexBuffer(quadIndexBuffer);
         renderContext.bindBuffer(fontInfoBuffer, "info");
-        renderContext.bindBuffer(fontPointDataBuffer, "fontData.points");
-        renderContext.bindBuffer(fontContourPointRangesBuffer, "fontData.contourIndexRanges");
+        renderContext.bindTexture(glyphAtlasTexture, "fontData.atlas");
+        renderContext.bindSampler(SAMPLER_LINEAR, "fontData.sampler");
         renderContext.drawIndexed(6, textData.size(), 0, 0);
     };
 
-    vec3 eye(0.0f, 0.0f, 12.0f);
     vec3 rot(0.0f);
     uvec2 windowRenderTargetSize{window->getRenderTarget()->getSize()};
     while (global::windowManager.update())
@@ -432,11 +500,16 @@ int main()
             }
             renderGraph.addPass("Deffered pass", renderPass);
 
-            renderGraph.addPass("Fonts", RenderPassBuilder()
-                                             .init(RenderPassType::GRAPHICS, RenderTargetType::COLOR)
-                                             .addRenderTarget(window->getRenderTarget())
-                                             .setPipeline(fontPipeline)
-                                             .setCommands(fontRenderCommands));
+            if (drawText)
+            {
+                renderGraph.addPass("Fonts", RenderPassBuilder()
+                                                 .init(RenderPassType::GRAPHICS, RenderTargetType::COLOR)
+                                                 .addRenderTarget(window->getRenderTarget())
+                                                 .addResource(ResourceAccessType::READ, glyphAtlasTexture,
+                                                              ShaderStage::FRAGMENT)
+                                                 .setPipeline(fontPipeline)
+                                                 .setCommands(fontRenderCommands));
+            }
         }
 
         fontInfoBuffer->write(&fontInfo, sizeof(fontInfo));
@@ -448,6 +521,45 @@ int main()
                    math::lookTo(eye, -forward, up);
         viewProjBuffer->write(&viewProj, sizeof(viewProj));
 
+        for (Entity cell : cellEntities)
+        {
+            global::sceneManager.getComponent<Transform>(cell).rotation +=
+                vec3(math::radians(5), math::radians(10), 0.0f) * global::timer.dt();
+        }
+
+        // Instances of the same mesh and lod are contiguous in the instance buffer and drawn with one draw
+        float projectionScale = static_cast<float>(rect.screenHeight) * 0.5f; // Pixels per unit at distance 1
+        sortedInstances.clear();
+        for (Entity entity : meshEntities)
+        {
+            const MeshInstance& instance = global::sceneManager.getComponent<MeshInstance>(entity);
+            auto mesh = static_cast<u64>(instance.meshData - meshes.data());
+            matrix4 model = getWorldMatrix(global::sceneManager, entity);
+            vec3 position(model(0, 3), model(1, 3), model(2, 3));
+            u32 lod = selectMeshLod(meshes[mesh], math::length(position - eye), projectionScale);
+            sortedInstances.emplace_back((mesh << 32) | lod, model);
+        }
+        std::ranges::sort(sortedInstances, {}, &std::pair<u64, matrix4>::first);
+
+        instanceBatches.clear();
+        instanceMatrices.clear();
+        for (const auto& [key, model] : sortedInstances)
+        {
+            auto mesh = static_cast<u32>(key >> 32);
+            auto lod = static_cast<u32>(key);
+            if (instanceBatches.empty() || instanceBatches.back().mesh != mesh || instanceBatches.back().lod != lod)
+            {
+                instanceBatches.push_back(
+                    {.mesh = mesh, .lod = lod, .firstInstance = static_cast<u32>(instanceMatrices.size())});
+            }
+            ++instanceBatches.back().instanceCount;
+            instanceMatrices.push_back(model);
+        }
+        if (!instanceMatrices.empty())
+        {
+            instanceBuffer->write(instanceMatrices.data(), sizeof(matrix4) * instanceMatrices.size());
+        }
+
         global::graphicsManager.render(renderGraph);
 
         if (global::input.isKeyActive(KeyToggles::CAPS_LOCK))
@@ -480,7 +592,12 @@ int main()
     }
 
     global::graphicsManager.removeTexture(texture);
+    if (glyphAtlasTexture.valid())
+    {
+        global::graphicsManager.removeTexture(glyphAtlasTexture);
+    }
     global::graphicsManager.removeBuffer(viewProjBuffer);
+    meshPool.cleanup();
 
     global::resourceManager.cleanup();
     global::graphicsManager.cleanup();
@@ -389,7 +389,7 @@ void MetalRenderContext::drawIndexed(u32 indexCount, u32 instanceCount, u32 inde
                           indexCount:indexCount
                            indexType:MTLIndexTypeUInt32
                          indexBuffer:m_boundIndexBuffer
-                   indexBufferOffset:indexOffset
+                   indexBufferOffset:static_cast<NSUInteger>(indexOffset) * sizeof(u32)
                        instanceCount:instanceCount
                           baseVertex:0
                         baseInstance:instanceOffset];
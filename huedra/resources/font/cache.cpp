@@ -0,0 +1,162 @@
+#include "cache.hpp"
+#include "core/file/mapped_file.hpp"
+#include "core/file/utils.hpp"
+#include "core/log.hpp"
+#include "core/memory/hash.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+
+namespace huedra {
+
+namespace {
+
+static_assert(std::is_trivially_copyable_v<GlyphAtlasCacheHeader> && std::is_trivially_copyable_v<AtlasGlyph>);
+
+constexpr u64 alignOffset(u64 offset)
+{
+    return (offset + GLYPH_ATLAS_CACHE_ALIGNMENT - 1) & ~(GLYPH_ATLAS_CACHE_ALIGNMENT - 1);
+}
+
+u64 getPageByteSize(u32 pageSize) { return static_cast<u64>(pageSize) * pageSize * 4; }
+
+} // namespace
+
+u64 computeFontHash(std::span<const u8> fontBytes) { return hashBytes(fontBytes, GLYPH_ATLAS_CACHE_VERSION); }
+
+u64 computeGlyphAtlasCacheKey(u64 fontHash, std::span<const u32> glyphIndices, const GlyphAtlasSettings& settings)
+{
+    std::vector<u32> sortedIndices(glyphIndices.begin(), glyphIndices.end());
+    std::ranges::sort(sortedIndices);
+    sortedIndices.erase(std::ranges::unique(sortedIndices).begin(), sortedIndices.end());
+
+    u64 key = hashBytes(
+        std::span(reinterpret_cast<const u8*>(sortedIndices.data()), sortedIndices.size() * sizeof(u32)), fontHash);
+    key = hashValue(key, settings.glyphSize);
+    key = hashValue(key, std::bit_cast<u32>(settings.pixelRange));
+    key = hashValue(key, settings.pageSize);
+    return key == 0 ? 1 : key;
+}
+
+std::string getGlyphAtlasCachePath(u64 key)
+{
+    std::array<char, 16> hex{};
+    char* hexEnd = std::to_chars(hex.data(), hex.data() + hex.size(), key, 16).ptr;
+    return std::string(GLYPH_ATLAS_CACHE_DIRECTORY) + "/" + std::string(hex.data(), hexEnd) + ".hatlas";
+}
+
+std::optional<GlyphAtlas> readGlyphAtlasCache(const std::string& cachePath, u64 key)
+{
+    std::error_code error;
+    if (!std::filesystem::exists(cachePath, error))
+    {
+        return std::nullopt;
+    }
+
+    MappedFile file(cachePath);
+    if (!file.isOpen() || file.size() < sizeof(GlyphAtlasCacheHeader))
+    {
+        return std::nullopt;
+    }
+
+    GlyphAtlasCacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(GlyphAtlasCacheHeader));
+    if (header.magic != GLYPH_ATLAS_CACHE_MAGIC || header.version != GLYPH_ATLAS_CACHE_VERSION || header.key != key)
+    {
+        return std::nullopt;
+    }
+
+    u64 pageByteSize = getPageByteSize(header.pageSize);
+    bool valid = header.fileSize == file.size() && header.glyphEntrySize == sizeof(AtlasGlyph) &&
+                 header.glyphsOffset % GLYPH_ATLAS_CACHE_ALIGNMENT == 0 && header.glyphsOffset <= file.size() &&
+                 header.glyphCount <= (file.size() - header.glyphsOffset) / sizeof(AtlasGlyph) &&
+                 header.texelsOffset % GLYPH_ATLAS_CACHE_ALIGNMENT == 0 && header.texelsOffset <= file.size() &&
+                 (header.pageCount == 0 ||
+                  (pageByteSize > 0 && header.pageCount <= (file.size() - header.texelsOffset) / pageByteSize));
+    if (!valid)
+    {
+        log(LogLevel::WARNING, "readGlyphAtlasCache(): \"{}\" is malformed", cachePath.c_str());
+        return std::nullopt;
+    }
+
+    GlyphAtlas atlas;
+    atlas.settings = {.glyphSize = header.glyphSize, .pixelRange = header.pixelRange, .pageSize = header.pageSize};
+    atlas.glyphs.resize(header.glyphCount);
+    if (header.glyphCount > 0)
+    {
+        std::memcpy(atlas.glyphs.data(), file.data() + header.glyphsOffset, header.glyphCount * sizeof(AtlasGlyph));
+    }
+
+    atlas.pages.resize(header.pageCount);
+    for (u32 i = 0; i < header.pageCount; ++i)
+    {
+        TextureData& page = atlas.pages[i];
+        page.width = header.pageSize;
+        page.height = header.pageSize;
+        page.format = GraphicsDataFormat::RGBA_8_UNORM;
+        page.texelSize = 4;
+        const u8* texels = file.data() + header.texelsOffset + (i * pageByteSize);
+        page.texels.assign(texels, texels + pageByteSize);
+    }
+
+    for (const AtlasGlyph& glyph : atlas.glyphs)
+    {
+        if (glyph.size.x > 0 && (glyph.page >= header.pageCount || glyph.position.x + glyph.size.x > header.pageSize ||
+                                 glyph.position.y + glyph.size.y > header.pageSize))
+        {
+            log(LogLevel::WARNING, "readGlyphAtlasCache(): \"{}\" has glyphs out of bounds", cachePath.c_str());
+            return std::nullopt;
+        }
+    }
+    return atlas;
+}
+
+bool writeGlyphAtlasCache(const std::string& cachePath, u64 key, const GlyphAtlas& atlas)
+{
+    u64 pageByteSize = getPageByteSize(atlas.settings.pageSize);
+    for (const TextureData& page : atlas.pages)
+    {
+        if (page.texels.size() != pageByteSize)
+        {
+            log(LogLevel::WARNING, "writeGlyphAtlasCache(): atlas pages don't match the page size");
+            return false;
+        }
+    }
+
+    GlyphAtlasCacheHeader header;
+    header.key = key;
+    header.glyphSize = atlas.settings.glyphSize;
+    header.pixelRange = atlas.settings.pixelRange;
+    header.pageSize = atlas.settings.pageSize;
+    header.pageCount = static_cast<u32>(atlas.pages.size());
+    header.glyphCount = static_cast<u32>(atlas.glyphs.size());
+    header.glyphsOffset = alignOffset(sizeof(GlyphAtlasCacheHeader));
+    header.texelsOffset = alignOffset(header.glyphsOffset + (atlas.glyphs.size() * sizeof(AtlasGlyph)));
+    header.fileSize = header.texelsOffset + (atlas.pages.size() * pageByteSize);
+
+    std::vector<u8> bytes(header.fileSize, 0);
+    std::memcpy(bytes.data(), &header, sizeof(GlyphAtlasCacheHeader));
+    if (!atlas.glyphs.empty())
+    {
+        std::memcpy(bytes.data() + header.glyphsOffset, atlas.glyphs.data(), atlas.glyphs.size() * sizeof(AtlasGlyph));
+    }
+    for (u64 i = 0; i < atlas.pages.size(); ++i)
+    {
+        std::memcpy(bytes.data() + header.texelsOffset + (i * pageByteSize), atlas.pages[i].texels.data(),
+                    pageByteSize);
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), error);
+    if (error)
+    {
+        log(LogLevel::WARNING, "writeGlyphAtlasCache(): could not create directory for \"{}\"", cachePath.c_str());
+        return false;
+    }
+    return writeBytes(cachePath, bytes);
+}
+
+} // namespace huedra
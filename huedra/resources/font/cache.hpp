@@ -0,0 +1,54 @@
+#pragma once
+
+#include "core/types.hpp"
+#include "resources/font/glyph_atlas.hpp"
+
+#include <optional>
+#include <span>
+
+namespace huedra {
+
+// Binary glyph atlas cache (.hatlas), written after an atlas is built and mapped on later loads. Layout:
+//     GlyphAtlasCacheHeader
+//     AtlasGlyph[glyphCount]
+//     texels of every page, pageSize * pageSize * 4 bytes each
+// Blobs are aligned to GLYPH_ATLAS_CACHE_ALIGNMENT, offsets are relative to the start of the file. Data is stored in
+// native endianness, a file written on a machine with other endianness fails the magic check and is rebuilt
+constexpr u32 GLYPH_ATLAS_CACHE_MAGIC = 0x54414648; // "HFAT"
+constexpr u32 GLYPH_ATLAS_CACHE_VERSION = 1;        // Bump when the layout or the field generation changes
+constexpr u64 GLYPH_ATLAS_CACHE_ALIGNMENT = 16;
+constexpr const char* GLYPH_ATLAS_CACHE_DIRECTORY = "cache/fonts";
+
+struct GlyphAtlasCacheHeader
+{
+    u32 magic{GLYPH_ATLAS_CACHE_MAGIC};
+    u32 version{GLYPH_ATLAS_CACHE_VERSION};
+    u64 key{0};      // Hash of the font, the glyph set and the settings
+    u64 fileSize{0}; // Catches truncated writes
+    u32 glyphSize{0};
+    float pixelRange{0.0f};
+    u32 pageSize{0};
+    u32 pageCount{0};
+    u32 glyphCount{0};
+    u32 glyphEntrySize{sizeof(AtlasGlyph)};
+    u64 glyphsOffset{0};
+    u64 texelsOffset{0};
+};
+
+// Hash of the content of a font file
+u64 computeFontHash(std::span<const u8> fontBytes);
+
+// Cache key of an atlas, covers the font, the glyph set (order and duplicates don't matter) and the settings
+u64 computeGlyphAtlasCacheKey(u64 fontHash, std::span<const u32> glyphIndices, const GlyphAtlasSettings& settings);
+
+// Path of the cache file of an atlas, inside GLYPH_ATLAS_CACHE_DIRECTORY. Named after the cache key so that atlases
+// of different glyph sets or settings of the same font are kept side by side
+std::string getGlyphAtlasCachePath(u64 key);
+
+// Maps the cache file and copies the glyphs and pages out of it. Returns std::nullopt if the file is missing, stale
+// (key mismatch), from another version or malformed
+std::optional<GlyphAtlas> readGlyphAtlasCache(const std::string& cachePath, u64 key);
+
+bool writeGlyphAtlasCache(const std::string& cachePath, u64 key, const GlyphAtlas& atlas);
+
+} // namespace huedra
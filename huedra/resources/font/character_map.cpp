@@ -0,0 +1,274 @@
+#include "character_map.hpp"
+#include "core/log.hpp"
+#include "core/memory/utils.hpp"
+
+#include <bit>
+#include <utility>
+
+namespace huedra {
+
+CharacterMap::CharacterMap(CharacterMap&& rhs) noexcept
+    : m_planes(rhs.m_planes), m_blocks(std::move(rhs.m_blocks)), m_glyphIndices(std::move(rhs.m_glyphIndices)),
+      m_mappedCount(rhs.m_mappedCount)
+{
+    rhs.clear();
+}
+
+CharacterMap& CharacterMap::operator=(CharacterMap&& rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        m_planes = rhs.m_planes;
+        m_blocks = std::move(rhs.m_blocks);
+        m_glyphIndices = std::move(rhs.m_glyphIndices);
+        m_mappedCount = rhs.m_mappedCount;
+        rhs.clear();
+    }
+    return *this;
+}
+
+bool CharacterMap::build(std::span<const u8> cmapTable, u32 glyphCount)
+{
+    clear();
+    if (cmapTable.size() < 4)
+    {
+        log(LogLevel::WARNING, "CharacterMap::build(): \"cmap\" table is too small");
+        return false;
+    }
+
+    u16 numSubtables = parseFromBytes<u16>(&cmapTable[2], std::endian::big);
+    if (4 + (static_cast<u64>(numSubtables) * 8) > cmapTable.size())
+    {
+        log(LogLevel::WARNING, "CharacterMap::build(): \"cmap\" encoding records out of bounds");
+        return false;
+    }
+
+    // Look through the different subtables and find the best unicode encoding, subtables covering the full unicode
+    // range are preferred over the ones only covering the basic multilingual plane
+    u32 selectedSubtableOffset{0};
+    u32 selectedRank{0};
+    for (u16 i = 0; i < numSubtables; ++i)
+    {
+        u16 platformId = parseFromBytes<u16>(&cmapTable[4 + (i * 8)], std::endian::big);
+        u16 platformSpecificId = parseFromBytes<u16>(&cmapTable[4 + (i * 8) + 2], std::endian::big);
+        u32 offset = parseFromBytes<u32>(&cmapTable[4 + (i * 8) + 4], std::endian::big);
+        if (static_cast<u64>(offset) + 2 > cmapTable.size())
+        {
+            continue;
+        }
+        u16 format = parseFromBytes<u16>(&cmapTable[offset], std::endian::big);
+        if (format != 4 && format != 6 && format != 12 && format != 13)
+        {
+            continue;
+        }
+
+        u32 rank{0};
+        // Unicode platform
+        if (platformId == 0)
+        {
+            switch (platformSpecificId)
+            {
+            case 0:
+            case 1:
+            case 2:
+                rank = 2; // Older unicode versions
+                break;
+            case 3:
+                rank = 3; // Basic multilingual plane
+                break;
+            case 4:
+                rank = 4; // Full unicode range
+                break;
+            case 6:
+                rank = 1; // Full unicode range, format 13 many to one mappings
+                break;
+            default:
+                break;
+            }
+        }
+        // Windows platform
+        else if (platformId == 3)
+        {
+            if (platformSpecificId == 1)
+            {
+                rank = 3;
+            }
+            else if (platformSpecificId == 10)
+            {
+                rank = 4;
+            }
+        }
+
+        if (rank > selectedRank)
+        {
+            selectedSubtableOffset = offset;
+            selectedRank = rank;
+        }
+    }
+
+    if (selectedRank == 0)
+    {
+        log(LogLevel::WARNING, "CharacterMap::build(): Did not find suitable encoding in \"cmap\" table");
+        return false;
+    }
+
+    if (!readSubtable(cmapTable.subspan(selectedSubtableOffset), glyphCount))
+    {
+        clear();
+        return false;
+    }
+    return true;
+}
+
+void CharacterMap::clear()
+{
+    m_planes.fill(0);
+    m_blocks.assign(PAGE_SIZE, 0);
+    m_glyphIndices.assign(PAGE_SIZE, 0);
+    m_mappedCount = 0;
+}
+
+void CharacterMap::set(char32_t character, u32 glyphIndex)
+{
+    u16& block = m_planes[character >> 16];
+    if (block == 0)
+    {
+        block = static_cast<u16>(m_blocks.size() / PAGE_SIZE);
+        m_blocks.resize(m_blocks.size() + PAGE_SIZE, 0);
+    }
+
+    u64 blockIndex = (static_cast<u64>(block) * PAGE_SIZE) + ((character >> 8) & 0xff);
+    if (m_blocks[blockIndex] == 0)
+    {
+        m_blocks[blockIndex] = static_cast<u16>(m_glyphIndices.size() / PAGE_SIZE);
+        m_glyphIndices.resize(m_glyphIndices.size() + PAGE_SIZE, 0);
+    }
+
+    u16& glyph = m_glyphIndices[(static_cast<u64>(m_blocks[blockIndex]) * PAGE_SIZE) + (character & 0xff)];
+    if (glyph == 0)
+    {
+        ++m_mappedCount;
+    }
+    glyph = static_cast<u16>(glyphIndex);
+}
+
+bool CharacterMap::readSubtable(std::span<const u8> subtable, u32 glyphCount)
+{
+    u16 format = parseFromBytes<u16>(subtable.data(), std::endian::big);
+
+    auto outOfBounds = [&](u64 size) {
+        if (size > subtable.size())
+        {
+            log(LogLevel::WARNING, "CharacterMap::build(): \"cmap\" subtable format {} out of bounds", format);
+            return true;
+        }
+        return false;
+    };
+
+    // Glyph indices are 16 bit in true type fonts, indices past the glyph count are invalid and left unmapped
+    auto map = [&](u32 character, u32 glyphIndex) {
+        if (glyphIndex != 0 && glyphIndex < glyphCount)
+        {
+            set(character, glyphIndex);
+        }
+    };
+
+    if (format == 4)
+    {
+        if (outOfBounds(14))
+        {
+            return false;
+        }
+        u32 segCount = parseFromBytes<u16>(&subtable[6], std::endian::big) / 2;
+        // endCode[segCount], reservedPad, startCode[segCount], idDelta[segCount], idRangeOffset[segCount]
+        u32 endCodeOffset = 14;
+        u32 startCodeOffset = endCodeOffset + (segCount * 2) + 2;
+        u32 idDeltaOffset = startCodeOffset + (segCount * 2);
+        u32 idRangeOffsetOffset = idDeltaOffset + (segCount * 2);
+        if (outOfBounds(idRangeOffsetOffset + (segCount * 2)))
+        {
+            return false;
+        }
+
+        for (u32 i = 0; i < segCount; ++i)
+        {
+            u32 endCode = parseFromBytes<u16>(&subtable[endCodeOffset + (i * 2)], std::endian::big);
+            u32 startCode = parseFromBytes<u16>(&subtable[startCodeOffset + (i * 2)], std::endian::big);
+            u16 idDelta = parseFromBytes<u16>(&subtable[idDeltaOffset + (i * 2)], std::endian::big);
+            u32 idRangeOffsetLocation = idRangeOffsetOffset + (i * 2);
+            u16 idRangeOffset = parseFromBytes<u16>(&subtable[idRangeOffsetLocation], std::endian::big);
+
+            // Calculate code directly
+            if (idRangeOffset == 0)
+            {
+                for (u32 c = startCode; c <= endCode; ++c)
+                {
+                    map(c, static_cast<u16>(c + idDelta));
+                }
+            }
+            // Look up in glyph index array, idRangeOffset is relative to its own location
+            else
+            {
+                u64 glyphIndexArrayOffset = static_cast<u64>(idRangeOffsetLocation) + idRangeOffset;
+                if (endCode >= startCode && outOfBounds(glyphIndexArrayOffset + ((endCode - startCode + 1) * 2)))
+                {
+                    return false;
+                }
+                for (u32 c = startCode; c <= endCode; ++c)
+                {
+                    u16 index =
+                        parseFromBytes<u16>(&subtable[glyphIndexArrayOffset + ((c - startCode) * 2)], std::endian::big);
+                    if (index != 0)
+                    {
+                        map(c, static_cast<u16>(index + idDelta));
+                    }
+                }
+            }
+        }
+    }
+    else if (format == 6)
+    {
+        if (outOfBounds(10))
+        {
+            return false;
+        }
+        u32 firstCode = parseFromBytes<u16>(&subtable[6], std::endian::big);
+        u32 entryCount = parseFromBytes<u16>(&subtable[8], std::endian::big);
+        if (outOfBounds(10 + (entryCount * 2)) || firstCode + entryCount > 0x10000)
+        {
+            return false;
+        }
+        for (u32 i = 0; i < entryCount; ++i)
+        {
+            map(firstCode + i, parseFromBytes<u16>(&subtable[10 + (i * 2)], std::endian::big));
+        }
+    }
+    else if (format == 12 || format == 13)
+    {
+        if (outOfBounds(16))
+        {
+            return false;
+        }
+        u32 numGroups = parseFromBytes<u32>(&subtable[12], std::endian::big);
+        if (outOfBounds(16 + (static_cast<u64>(numGroups) * 12)))
+        {
+            return false;
+        }
+        for (u32 i = 0; i < numGroups; ++i)
+        {
+            u32 startCharCode = parseFromBytes<u32>(&subtable[16 + (i * 12)], std::endian::big);
+            u32 endCharCode = std::min<u32>(parseFromBytes<u32>(&subtable[16 + (i * 12) + 4], std::endian::big),
+                                            MAX_CODE_POINT);
+            u32 startGlyphCode = parseFromBytes<u32>(&subtable[16 + (i * 12) + 8], std::endian::big);
+
+            // Format 12 maps the group to consecutive glyphs, format 13 maps all of it to the same glyph
+            for (u32 c = startCharCode; c <= endCharCode; ++c)
+            {
+                map(c, format == 12 ? startGlyphCode + (c - startCharCode) : startGlyphCode);
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace huedra
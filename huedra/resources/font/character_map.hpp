@@ -0,0 +1,58 @@
+#pragma once
+
+#include "core/types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+
+namespace huedra {
+
+// Maps unicode code points to glyph indices through a three level page table: 32 planes of 64k code points, blocks of
+// 256 code points within a plane and the glyph indices of a block. Block and glyph index page 0 are kept empty and
+// shared by everything that is unmapped, so a lookup is three loads without branches and only mapped ranges take
+// memory. Code points above the unicode range land in the unused planes and return glyph 0
+class CharacterMap
+{
+public:
+    static constexpr char32_t MAX_CODE_POINT = 0x10ffff;
+
+    CharacterMap() { clear(); }
+    ~CharacterMap() = default;
+
+    CharacterMap(const CharacterMap& rhs) = default;
+    CharacterMap& operator=(const CharacterMap& rhs) = default;
+    // The moved from map is left empty, lookups need the shared empty pages
+    CharacterMap(CharacterMap&& rhs) noexcept;
+    CharacterMap& operator=(CharacterMap&& rhs) noexcept;
+
+    // Builds the map from the best unicode subtable of a "cmap" table (format 4, 6, 12 or 13), glyph indices outside of
+    // glyphCount are left unmapped
+    bool build(std::span<const u8> cmapTable, u32 glyphCount);
+    void clear();
+
+    // Returns 0 (the missing glyph) for unmapped code points
+    u32 getGlyphIndex(char32_t character) const
+    {
+        u32 block = m_planes[std::min<u32>(character >> 16, PLANE_COUNT - 1)];
+        u32 glyphPage = m_blocks[(block << 8) | ((character >> 8) & 0xff)];
+        return m_glyphIndices[(glyphPage << 8) | (character & 0xff)];
+    }
+
+    u64 getMappedCount() const { return m_mappedCount; }
+
+private:
+    static constexpr u32 PLANE_COUNT = 32;
+    static constexpr u32 PAGE_SIZE = 256;
+
+    void set(char32_t character, u32 glyphIndex);
+    bool readSubtable(std::span<const u8> subtable, u32 glyphCount);
+
+    std::array<u16, PLANE_COUNT> m_planes{};
+    std::vector<u16> m_blocks;       // Block pages, each holds the glyph index page of 256 blocks
+    std::vector<u16> m_glyphIndices; // Glyph index pages, each holds the glyph indices of 256 code points
+    u64 m_mappedCount{0};
+};
+
+} // namespace huedra
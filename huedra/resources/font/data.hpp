@@ -2,6 +2,7 @@
 
 #include "core/types.hpp"
 #include "math/vec2.hpp"
+#include "resources/font/character_map.hpp"
 #include <vector>
 
 namespace huedra {
@@ -31,7 +32,7 @@ struct Glyph
 
 struct FontData
 {
-    std::map<u16, u32> characterMappings; // std::map<unicode character, glyphIndex>
+    CharacterMap characterMap;
     std::vector<Glyph> glyphs;
     u16 unitsPerEm{0};
 };
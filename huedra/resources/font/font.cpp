@@ -0,0 +1,582 @@
+#include "font.hpp"
+#include "core/log.hpp"
+#include "core/memory/utils.hpp"
+#include "core/thread/utils.hpp"
+#include "math/matrix.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <utility>
+
+namespace huedra {
+
+// Used for true type, post type and open type fonts
+struct CommonFontHeader
+{
+    std::string scalerTypeString;
+    u32 scalerType{0};
+    u16 numTables{0};
+    u16 searchRange{0};
+    u16 entrySelector{0};
+    u16 rangeShift{0};
+
+    enum class Type
+    {
+        UNDEFINED,
+        TRUE_TYPE,
+        POSTSCRIPT,
+        OPEN_TYPE
+    };
+    Type type{Type::UNDEFINED};
+
+    // TODO: Create this automatically? Macro?
+    constexpr static std::array<std::string_view, 4> TypeNames{"Undefined", "True Type", "PostScript", "Open Type"};
+};
+
+namespace {
+
+// Used for true type, post type and open type fonts
+CommonFontHeader loadCommonFontHeader(const u8* bytes)
+{
+    CommonFontHeader header;
+    header.scalerTypeString = {static_cast<char>(bytes[0]), static_cast<char>(bytes[1]), static_cast<char>(bytes[2]),
+                               static_cast<char>(bytes[3])};
+    header.scalerType = parseFromBytes<u32>(bytes, std::endian::big);
+    header.numTables = parseFromBytes<u16>(&bytes[4], std::endian::big);
+    header.searchRange = parseFromBytes<u16>(&bytes[6], std::endian::big);
+    header.entrySelector = parseFromBytes<u16>(&bytes[8], std::endian::big);
+    header.rangeShift = parseFromBytes<u16>(&bytes[10], std::endian::big);
+
+    if (header.scalerTypeString == "true" || header.scalerType == 0x00010000)
+    {
+        header.type = CommonFontHeader::Type::TRUE_TYPE;
+    }
+    else if (header.scalerTypeString == "typ1")
+    {
+        header.type = CommonFontHeader::Type::POSTSCRIPT;
+    }
+    else if (header.scalerTypeString == "OTTO")
+    {
+        header.type = CommonFontHeader::Type::OPEN_TYPE;
+    }
+
+    return header;
+}
+
+struct FontTable
+{
+    u32 checkSum{0};
+    u32 offset{0};
+    u32 length{0};
+};
+
+// Splits the points of a glyph into contour ranges and adds the implied points between two consecutive on curve or off
+// curve points, so that contours alternate between on curve and off curve points
+void buildGlyphContours(Glyph& glyph, const std::vector<u16>& contourEndPointIndices,
+                        const std::vector<GlyphPoint>& points)
+{
+    glyph.contourRanges.resize(contourEndPointIndices.size());
+    u16 curStart{0};
+    for (u32 j = 0; j < contourEndPointIndices.size(); ++j)
+    {
+        glyph.contourRanges[j].start = curStart;
+        glyph.contourRanges[j].end = contourEndPointIndices[j];
+        curStart = contourEndPointIndices[j] + 1;
+    }
+
+    // Add implied points between onCurve/offCurve points
+    u32 curContourIndex{0};
+    u32 contourRangeOffset{0}; // When points are added, later ranges are offset by points added in previous ranges
+    std::vector<GlyphContourRange> origContourRanges{glyph.contourRanges};
+    for (u32 j = 0; j < points.size(); ++j)
+    {
+        glyph.points.push_back(points[j]);
+
+        if (j == origContourRanges[curContourIndex].end)
+        {
+            const GlyphPoint& startPoint = points[origContourRanges[curContourIndex].start];
+            const GlyphPoint& endPoint = points[origContourRanges[curContourIndex].end];
+            // On curve status is the same between the start and end point in range, add implied point in between
+            if (startPoint.onCurve == endPoint.onCurve)
+            {
+                GlyphPoint point{.position = (startPoint.position + endPoint.position) / 2,
+                                 .onCurve = !startPoint.onCurve};
+                glyph.points.push_back(point);
+                ++glyph.contourRanges[curContourIndex].end;
+                ++contourRangeOffset;
+            }
+
+            if (curContourIndex < origContourRanges.size() - 1)
+            {
+                glyph.contourRanges[++curContourIndex].start += contourRangeOffset;
+                glyph.contourRanges[curContourIndex].end += contourRangeOffset;
+            }
+        }
+        // On curve status is the same between the points, add implied point in between
+        else if (points[j].onCurve == points[(j + 1) % points.size()].onCurve)
+        {
+            GlyphPoint point{.position = (points[j].position + points[j + 1].position) / 2,
+                             .onCurve = !points[j].onCurve};
+            glyph.points.push_back(point);
+            ++glyph.contourRanges[curContourIndex].end;
+            ++contourRangeOffset;
+        }
+    }
+}
+
+} // namespace
+
+bool Font::load(const std::string& path)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        return false;
+    }
+    const u8* bytes = file.data();
+    u64 size = file.size();
+
+    if (size < 12)
+    {
+        log(LogLevel::WARNING, "Font::load(): {} is too small to be a font", path.c_str());
+        return false;
+    }
+    CommonFontHeader header = loadCommonFontHeader(bytes);
+
+    if (header.type != CommonFontHeader::Type::TRUE_TYPE)
+    {
+        log(LogLevel::WARNING, "Font::load(): Invalid font type, expected {}, but got {}",
+            CommonFontHeader::TypeNames[static_cast<u32>(CommonFontHeader::Type::TRUE_TYPE)],
+            CommonFontHeader::TypeNames[static_cast<u32>(header.type)]);
+        return false;
+    }
+
+    if (12 + (static_cast<u64>(header.numTables) * 16) > size)
+    {
+        log(LogLevel::WARNING, "Font::load(): {} table directory out of bounds", path.c_str());
+        return false;
+    }
+
+    std::map<std::string, FontTable> tables;
+    for (u32 i = 0; i < header.numTables; ++i)
+    {
+        std::string tag = {static_cast<char>(bytes[12 + (i * 16)]), static_cast<char>(bytes[13 + (i * 16)]),
+                           static_cast<char>(bytes[14 + (i * 16)]), static_cast<char>(bytes[15 + (i * 16)])};
+        u32 checkSum = parseFromBytes<u32>(&bytes[16 + (i * 16)], std::endian::big);
+        u32 offset = parseFromBytes<u32>(&bytes[20 + (i * 16)], std::endian::big);
+        u32 length = parseFromBytes<u32>(&bytes[24 + (i * 16)], std::endian::big);
+
+        // Check checksums?
+
+        if (static_cast<u64>(offset) + length > size)
+        {
+            log(LogLevel::WARNING, "Font::load(): {} table {} out of bounds", path.c_str(), tag.c_str());
+            return false;
+        }
+        tables.insert(
+            std::pair<std::string, FontTable>(tag, {.checkSum = checkSum, .offset = offset, .length = length}));
+    }
+
+    // TODO: Only check tables that are used by application?
+    // Check validity of font
+    constexpr std::array<std::string_view, 9> requiredTables{"cmap", "glyf", "head", "hhea", "hmtx",
+                                                             "loca", "maxp", "name", "post"};
+    for (const auto& required : requiredTables)
+    {
+        if (!tables.contains(std::string(required)))
+        {
+            log(LogLevel::WARNING, "Font::load(): Missing table name in file: {}", required);
+            return false;
+        }
+    }
+
+    if (tables["head"].length < 54 || tables["maxp"].length < 6 || tables["hhea"].length < 36)
+    {
+        log(LogLevel::WARNING, "Font::load(): {} has incorrect header tables", path.c_str());
+        return false;
+    }
+    u16 unitsPerEm = parseFromBytes<u16>(&bytes[tables["head"].offset + 18], std::endian::big);
+    i16 indexToLocFormat = parseFromBytes<i16>(&bytes[tables["head"].offset + 50], std::endian::big);
+    u16 numGlyphs = parseFromBytes<u16>(&bytes[tables["maxp"].offset + 4], std::endian::big);
+    u16 numLongHorMetrics = parseFromBytes<u16>(&bytes[tables["hhea"].offset + 34], std::endian::big);
+
+    // Glyph locations and metrics are read when a glyph is decoded, only their sizes are checked here
+    u32 bytesPerLocLookUp = indexToLocFormat == 0 ? 2 : 4;
+    u64 metricsSize = (static_cast<u64>(numLongHorMetrics) * 4) + ((numGlyphs - numLongHorMetrics) * 2ull);
+    if (numGlyphs == 0 || numLongHorMetrics == 0 || numLongHorMetrics > numGlyphs ||
+        tables["loca"].length < (numGlyphs + 1ull) * bytesPerLocLookUp || tables["hmtx"].length < metricsSize)
+    {
+        log(LogLevel::WARNING, "Font::load(): {} has incorrect glyph locations or metrics", path.c_str());
+        return false;
+    }
+
+    m_file = std::move(file);
+    m_glyfOffset = tables["glyf"].offset;
+    m_glyfLength = tables["glyf"].length;
+    m_locaOffset = tables["loca"].offset;
+    m_hmtxOffset = tables["hmtx"].offset;
+    m_longLocations = bytesPerLocLookUp == 4;
+    m_numLongHorMetrics = numLongHorMetrics;
+    m_glyphCount = numGlyphs;
+    m_unitsPerEm = unitsPerEm;
+    m_glyphs.clear();
+
+    const FontTable& cmap = tables["cmap"];
+    if (!m_characterMap.build(std::span<const u8>(&bytes[cmap.offset], cmap.length), m_glyphCount))
+    {
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+const Glyph& Font::getGlyph(u32 glyphIndex)
+{
+    if (glyphIndex >= m_glyphCount)
+    {
+        glyphIndex = 0;
+    }
+
+    auto it = m_glyphs.find(glyphIndex);
+    if (it == m_glyphs.end())
+    {
+        it = m_glyphs.emplace(glyphIndex, decodeGlyph(glyphIndex)).first;
+    }
+    return it->second;
+}
+
+void Font::warmUp(std::u32string_view characters)
+{
+    std::vector<u32> glyphIndices;
+    glyphIndices.reserve(characters.size());
+    for (char32_t character : characters)
+    {
+        glyphIndices.push_back(getGlyphIndex(character));
+    }
+    warmUpGlyphs(glyphIndices);
+}
+
+void Font::warmUpGlyphs(std::span<const u32> glyphIndices)
+{
+    std::vector<u32> missing;
+    for (u32 glyphIndex : glyphIndices)
+    {
+        if (glyphIndex < m_glyphCount && !m_glyphs.contains(glyphIndex))
+        {
+            missing.push_back(glyphIndex);
+        }
+    }
+    std::ranges::sort(missing);
+    missing.erase(std::ranges::unique(missing).begin(), missing.end());
+
+    // Decoding only reads the mapped file, the cache is filled afterwards on this thread
+    std::vector<Glyph> decoded(missing.size());
+    parallelFor(missing.size(), [&](u64 i) { decoded[i] = decodeGlyph(missing[i]); });
+
+    m_glyphs.reserve(m_glyphs.size() + missing.size());
+    for (u64 i = 0; i < missing.size(); ++i)
+    {
+        m_glyphs.emplace(missing[i], std::move(decoded[i]));
+    }
+}
+
+Glyph Font::decodeGlyph(u32 glyphIndex) const
+{
+    const u8* bytes = m_file.data();
+
+    // Remaining glyphs are monospace and are using the same advance width as the last in the hMetrics array
+    Glyph glyph;
+    u32 metricIndex = std::min<u32>(glyphIndex, m_numLongHorMetrics - 1);
+    glyph.advanceWidth = parseFromBytes<u16>(&bytes[m_hmtxOffset + (metricIndex * 4)], std::endian::big);
+    u32 bearingOffset = glyphIndex < m_numLongHorMetrics
+                            ? m_hmtxOffset + (glyphIndex * 4) + 2
+                            : m_hmtxOffset + (m_numLongHorMetrics * 4) + ((glyphIndex - m_numLongHorMetrics) * 2);
+    glyph.leftSideBearing = parseFromBytes<i16>(&bytes[bearingOffset], std::endian::big);
+
+    std::vector<u16> contourEndPointIndices;
+    std::vector<GlyphPoint> points;
+    if (!readGlyphOutline(glyphIndex, 0, contourEndPointIndices, points))
+    {
+        log(LogLevel::WARNING, "Font::getGlyph(): glyph {} has incorrect outline data", glyphIndex);
+        return glyph;
+    }
+
+    // Glyphs without an outline (ex: space) have no data in the glyf table and are simple glyphs without contours
+    glyph.isSimple = true;
+    auto [glyphOffset, glyphEnd] = getGlyphLocation(glyphIndex);
+    if (glyphEnd > glyphOffset)
+    {
+        u32 curByteIndex = m_glyfOffset + glyphOffset;
+        glyph.min.x = parseFromBytes<i16>(&bytes[curByteIndex + 2], std::endian::big);
+        glyph.min.y = parseFromBytes<i16>(&bytes[curByteIndex + 4], std::endian::big);
+        glyph.max.x = parseFromBytes<i16>(&bytes[curByteIndex + 6], std::endian::big);
+        glyph.max.y = parseFromBytes<i16>(&bytes[curByteIndex + 8], std::endian::big);
+        glyph.isSimple = parseFromBytes<i16>(&bytes[curByteIndex], std::endian::big) >= 0;
+    }
+
+    buildGlyphContours(glyph, contourEndPointIndices, points);
+    return glyph;
+}
+
+std::pair<u32, u32> Font::getGlyphLocation(u32 glyphIndex) const
+{
+    const u8* bytes = m_file.data();
+    if (m_longLocations)
+    {
+        return {parseFromBytes<u32>(&bytes[m_locaOffset + (glyphIndex * 4)], std::endian::big),
+                parseFromBytes<u32>(&bytes[m_locaOffset + (glyphIndex * 4) + 4], std::endian::big)};
+    }
+    // Short offsets are stored divided by two
+    return {static_cast<u32>(parseFromBytes<u16>(&bytes[m_locaOffset + (glyphIndex * 2)], std::endian::big)) * 2,
+            static_cast<u32>(parseFromBytes<u16>(&bytes[m_locaOffset + (glyphIndex * 2) + 2], std::endian::big)) * 2};
+}
+
+bool Font::readGlyphOutline(u32 glyphIndex, u32 depth, std::vector<u16>& contourEndPointIndices,
+                            std::vector<GlyphPoint>& points) const
+{
+    if (glyphIndex >= m_glyphCount || depth > MAX_COMPOUND_DEPTH)
+    {
+        return false;
+    }
+    const u8* bytes = m_file.data();
+
+    auto [glyphOffset, glyphEnd] = getGlyphLocation(glyphIndex);
+    if (glyphEnd <= glyphOffset)
+    {
+        return glyphEnd == glyphOffset; // No outline
+    }
+    if (glyphEnd > m_glyfLength || glyphEnd - glyphOffset < 10)
+    {
+        return false;
+    }
+
+    // Every read below is checked against the end of the glyph data
+    u32 curByteIndex = m_glyfOffset + glyphOffset;
+    const u32 endByteIndex = m_glyfOffset + glyphEnd;
+    auto hasBytes = [&](u64 count) { return curByteIndex + count <= endByteIndex; };
+
+    i16 numberOfContours = parseFromBytes<i16>(&bytes[curByteIndex], std::endian::big);
+    curByteIndex += 10;
+
+    // Simple glyphs
+    if (numberOfContours >= 0)
+    {
+        if (numberOfContours == 0)
+        {
+            return true;
+        }
+        if (!hasBytes((numberOfContours * 2ull) + 2))
+        {
+            return false;
+        }
+
+        u32 pointBase = static_cast<u32>(points.size());
+        for (u32 j = 0; j < static_cast<u32>(numberOfContours); ++j)
+        {
+            contourEndPointIndices.push_back(
+                parseFromBytes<u16>(&bytes[curByteIndex + (j * 2)], std::endian::big) + pointBase);
+        }
+
+        u32 lastEndPointIndex =
+            parseFromBytes<u16>(&bytes[curByteIndex + ((numberOfContours - 1) * 2)], std::endian::big);
+        u32 numPoints = lastEndPointIndex + 1;
+        points.resize(pointBase + numPoints);
+        GlyphPoint* glyphPoints = &points[pointBase];
+
+        // Skip instructionLength and instructions
+        u16 instructionLength = parseFromBytes<u16>(&bytes[curByteIndex + (numberOfContours * 2)], std::endian::big);
+        curByteIndex += (numberOfContours * 2) + 2 + instructionLength;
+
+        std::vector<u8> flags(numPoints, 0);
+        enum FlagBits
+        {
+            FLAG_ON_CURVE,
+            FLAG_X_SHORT_VECTOR,
+            FLAG_Y_SHORT_VECTOR,
+            FLAG_REPEAT,
+            FLAG_X_SPECIAL,
+            FLAG_Y_SPECIAL
+        };
+        for (u32 j = 0; j < numPoints; ++j)
+        {
+            if (!hasBytes(1))
+            {
+                return false;
+            }
+            u8 flag = bytes[curByteIndex++];
+            flags[j] = flag;
+
+            bool repeat = static_cast<bool>(readBits(&flag, FLAG_REPEAT, 1));
+            if (repeat)
+            {
+                if (!hasBytes(1))
+                {
+                    return false;
+                }
+                u32 numRepeats = std::min<u32>(bytes[curByteIndex++], numPoints - j - 1);
+                std::memset(&flags[j + 1], flag, numRepeats);
+                j += numRepeats;
+            }
+        }
+
+        // x and y coordinates are stored one after the other as deltas to the previous point
+        for (u32 axis = 0; axis < 2; ++axis)
+        {
+            u32 shortBit = axis == 0 ? FLAG_X_SHORT_VECTOR : FLAG_Y_SHORT_VECTOR;
+            u32 specialBit = axis == 0 ? FLAG_X_SPECIAL : FLAG_Y_SPECIAL;
+            i32 prevCoord = 0;
+            for (u32 j = 0; j < numPoints; ++j)
+            {
+                glyphPoints[j].onCurve = static_cast<bool>(readBits(&flags[j], FLAG_ON_CURVE, 1));
+
+                bool is8Bit = static_cast<bool>(readBits(&flags[j], shortBit, 1));
+                bool isSpecial = static_cast<bool>(readBits(&flags[j], specialBit, 1));
+
+                if (is8Bit)
+                {
+                    if (!hasBytes(1))
+                    {
+                        return false;
+                    }
+                    u8 coord = bytes[curByteIndex++];
+                    prevCoord += static_cast<i32>(coord) * (isSpecial ? 1 : -1);
+                }
+                else if (!isSpecial) // Special without 8 bit is the same coordinate as previous
+                {
+                    if (!hasBytes(2))
+                    {
+                        return false;
+                    }
+                    prevCoord += parseFromBytes<i16>(&bytes[curByteIndex], std::endian::big);
+                    curByteIndex += 2;
+                }
+                glyphPoints[j].position[axis] = prevCoord;
+            }
+        }
+        return true;
+    }
+
+    // Compound glyphs, loop until all component glyph parts have been parsed
+    enum FlagBits
+    {
+        ARG_1_AND_ARG_2_ARE_WORDS,
+        ARGS_ARE_XY_VALUES,
+        ROUND_XY_TO_GRID,
+        WE_HAVE_A_SCALE,
+        OBSOLETE,
+        MORE_COMPONENTS,
+        WE_HAVE_AN_X_AND_Y_SCALE,
+        WE_HAVE_A_TWO_BY_TWO,
+        WE_HAVE_INSTRUCTIONS,
+        USE_MY_METRICS,
+        OVERLAP_COMPOUND
+    };
+    auto readF2Dot14 = [&](u32 offset) {
+        return static_cast<float>(parseFromBytes<i16>(&bytes[curByteIndex + offset], std::endian::big)) /
+               static_cast<float>(1 << 14);
+    };
+
+    std::vector<u16> compContourEndPointIndices;
+    std::vector<GlyphPoint> compPoints;
+    for (;;)
+    {
+        if (!hasBytes(4))
+        {
+            return false;
+        }
+        u16 flags = parseFromBytes<u16>(&bytes[curByteIndex], std::endian::big);
+        u16 componentIndex = parseFromBytes<u16>(&bytes[curByteIndex + 2], std::endian::big);
+        curByteIndex += 4;
+        auto hasFlag = [flags](FlagBits bit) { return (flags & (1u << bit)) != 0; };
+
+        if (!hasFlag(ARGS_ARE_XY_VALUES))
+        {
+            log(LogLevel::WARNING, "Font::getGlyph(): Font not supported, compound glyph using xy points instead of "
+                                   "offset");
+            return false;
+        }
+
+        ivec2 offset;
+        if (hasFlag(ARG_1_AND_ARG_2_ARE_WORDS))
+        {
+            if (!hasBytes(4))
+            {
+                return false;
+            }
+            offset.x = parseFromBytes<i16>(&bytes[curByteIndex], std::endian::big);
+            offset.y = parseFromBytes<i16>(&bytes[curByteIndex + 2], std::endian::big);
+            curByteIndex += 4;
+        }
+        else
+        {
+            if (!hasBytes(2))
+            {
+                return false;
+            }
+            offset.x = static_cast<i8>(bytes[curByteIndex]);
+            offset.y = static_cast<i8>(bytes[curByteIndex + 1]);
+            curByteIndex += 2;
+        }
+
+        matrix2 scaleMatrix(1.0f);
+        if (hasFlag(WE_HAVE_A_SCALE))
+        {
+            if (!hasBytes(2))
+            {
+                return false;
+            }
+            scaleMatrix = matrix2(readF2Dot14(0));
+            curByteIndex += 2;
+        }
+        else if (hasFlag(WE_HAVE_AN_X_AND_Y_SCALE))
+        {
+            if (!hasBytes(4))
+            {
+                return false;
+            }
+            scaleMatrix(0, 0) = readF2Dot14(0);
+            scaleMatrix(1, 1) = readF2Dot14(2);
+            curByteIndex += 4;
+        }
+        else if (hasFlag(WE_HAVE_A_TWO_BY_TWO))
+        {
+            if (!hasBytes(8))
+            {
+                return false;
+            }
+            scaleMatrix(0, 0) = readF2Dot14(0);
+            scaleMatrix(0, 1) = readF2Dot14(2);
+            scaleMatrix(1, 0) = readF2Dot14(4);
+            scaleMatrix(1, 1) = readF2Dot14(6);
+            curByteIndex += 8;
+        }
+
+        compContourEndPointIndices.clear();
+        compPoints.clear();
+        if (!readGlyphOutline(componentIndex, depth + 1, compContourEndPointIndices, compPoints))
+        {
+            return false;
+        }
+
+        u32 pointBase = static_cast<u32>(points.size());
+        for (u16 endPointIndex : compContourEndPointIndices)
+        {
+            contourEndPointIndices.push_back(endPointIndex + pointBase);
+        }
+        for (const GlyphPoint& point : compPoints)
+        {
+            points.push_back({.position = static_cast<ivec2>(scaleMatrix * static_cast<vec2>(point.position)) + offset,
+                              .onCurve = point.onCurve});
+        }
+
+        if (!hasFlag(MORE_COMPONENTS))
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+} // namespace huedra
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "core/file/mapped_file.hpp"
+#include "core/types.hpp"
+#include "resources/font/character_map.hpp"
+#include "resources/font/data.hpp"
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace huedra {
+
+// True type font that decodes glyph outlines on first use. Loading only reads the table directory, the header tables
+// and the character mappings, the file stays mapped so glyphs can be decoded later. Fonts with tens of thousands of
+// glyphs (CJK) therefore load quickly and only hold the glyphs that are actually used.
+class Font
+{
+public:
+    Font() = default;
+    ~Font() = default;
+
+    Font(const Font& rhs) = delete;
+    Font& operator=(const Font& rhs) = delete;
+    Font(Font&& rhs) = default;
+    Font& operator=(Font&& rhs) = default;
+
+    bool load(const std::string& path);
+
+    // Glyph 0 (the missing glyph) is returned for unmapped characters and out of range glyph indices. Decoded glyphs
+    // are cached, references stay valid until the font is destroyed
+    const Glyph& getGlyph(u32 glyphIndex);
+    const Glyph& getCharacterGlyph(char32_t character) { return getGlyph(getGlyphIndex(character)); }
+    u32 getGlyphIndex(char32_t character) const { return m_characterMap.getGlyphIndex(character); }
+
+    // Decodes the glyphs up front on worker threads, for character sets that are known to be rendered
+    void warmUp(std::u32string_view characters);
+    void warmUpGlyphs(std::span<const u32> glyphIndices);
+
+    bool isLoaded() const { return m_file.isOpen(); }
+    std::span<const u8> getBytes() const { return m_file.getBytes(); } // Font file, used for cache keys
+    u32 getGlyphCount() const { return m_glyphCount; }
+    u16 getUnitsPerEm() const { return m_unitsPerEm; }
+    const CharacterMap& getCharacterMap() const { return m_characterMap; }
+
+private:
+    // Compound glyphs refer to other glyphs, the depth limit guards against fonts with cyclic references
+    static constexpr u32 MAX_COMPOUND_DEPTH = 16;
+
+    Glyph decodeGlyph(u32 glyphIndex) const;
+    std::pair<u32, u32> getGlyphLocation(u32 glyphIndex) const; // Byte range of the glyph in the glyf table
+    bool readGlyphOutline(u32 glyphIndex, u32 depth, std::vector<u16>& contourEndPointIndices,
+                          std::vector<GlyphPoint>& points) const;
+
+    MappedFile m_file;
+    u32 m_glyfOffset{0};
+    u32 m_glyfLength{0};
+    u32 m_locaOffset{0};
+    u32 m_hmtxOffset{0};
+    bool m_longLocations{false};
+    u16 m_numLongHorMetrics{0};
+    u32 m_glyphCount{0};
+    u16 m_unitsPerEm{0};
+
+    CharacterMap m_characterMap;
+    std::unordered_map<u32, Glyph> m_glyphs; // Decoded glyphs by glyph index
+};
+
+} // namespace huedra
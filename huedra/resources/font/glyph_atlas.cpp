@@ -0,0 +1,190 @@
+#include "glyph_atlas.hpp"
+#include "core/log.hpp"
+#include "core/thread/utils.hpp"
+#include "resources/font/cache.hpp"
+#include "resources/font/msdf.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace huedra {
+
+namespace {
+
+// Empty texels between glyphs so that linear filtering doesn't pick up the neighbours
+constexpr u32 GLYPH_SPACING = 1;
+
+} // namespace
+
+const AtlasGlyph* GlyphAtlas::findGlyph(u32 glyphIndex) const
+{
+    auto it = std::ranges::lower_bound(glyphs, glyphIndex, {}, &AtlasGlyph::glyphIndex);
+    return it != glyphs.end() && it->glyphIndex == glyphIndex ? &*it : nullptr;
+}
+
+GlyphAtlas buildGlyphAtlas(Font& font, std::span<const u32> glyphIndices, const GlyphAtlasSettings& settings)
+{
+    GlyphAtlas atlas;
+    atlas.settings = settings;
+    if (!font.isLoaded() || font.getUnitsPerEm() == 0)
+    {
+        log(LogLevel::WARNING, "buildGlyphAtlas(): font is not loaded or has no units per em");
+        return atlas;
+    }
+    if (settings.glyphSize == 0 || settings.pageSize == 0 || settings.pixelRange <= 0.0f)
+    {
+        log(LogLevel::WARNING, "buildGlyphAtlas(): settings are invalid");
+        return atlas;
+    }
+
+    std::vector<u32> indices;
+    indices.reserve(glyphIndices.size());
+    for (u32 glyphIndex : glyphIndices)
+    {
+        if (glyphIndex < font.getGlyphCount())
+        {
+            indices.push_back(glyphIndex);
+        }
+    }
+    std::ranges::sort(indices);
+    indices.erase(std::ranges::unique(indices).begin(), indices.end());
+    font.warmUpGlyphs(indices);
+
+    // Glyph boxes in texels, the outline is padded by half the distance range so the field fades out inside the box
+    double scale = static_cast<double>(settings.glyphSize) / font.getUnitsPerEm();
+    double unitsPerEm = font.getUnitsPerEm();
+    u32 padding = static_cast<u32>(std::ceil(settings.pixelRange * 0.5f)) + 1;
+    std::vector<dvec2> origins(indices.size()); // Top left corner of the box in font units
+    std::vector<const Glyph*> glyphs(indices.size());
+    atlas.glyphs.resize(indices.size());
+    for (u64 i = 0; i < indices.size(); ++i)
+    {
+        // The cache of the font is only read from the worker threads through these
+        glyphs[i] = &font.getGlyph(indices[i]);
+        const Glyph& glyph = *glyphs[i];
+        AtlasGlyph& atlasGlyph = atlas.glyphs[i];
+        atlasGlyph.glyphIndex = indices[i];
+        atlasGlyph.advance = static_cast<float>(glyph.advanceWidth / unitsPerEm);
+        if (glyph.contourRanges.empty() || glyph.max.x <= glyph.min.x || glyph.max.y <= glyph.min.y)
+        {
+            continue;
+        }
+
+        u32 width = static_cast<u32>(std::ceil((glyph.max.x - glyph.min.x) * scale)) + (padding * 2);
+        u32 height = static_cast<u32>(std::ceil((glyph.max.y - glyph.min.y) * scale)) + (padding * 2);
+        if (width + GLYPH_SPACING > settings.pageSize || height + GLYPH_SPACING > settings.pageSize)
+        {
+            log(LogLevel::WARNING, "buildGlyphAtlas(): glyph {} with {}x{} texels does not fit in a page", indices[i],
+                width, height);
+            continue;
+        }
+
+        origins[i] = dvec2(glyph.min.x - (padding / scale), glyph.max.y + (padding / scale));
+        atlasGlyph.size = u16vec2(static_cast<u16>(width), static_cast<u16>(height));
+        atlasGlyph.planeMin = vec2(static_cast<float>(origins[i].x / unitsPerEm),
+                                   static_cast<float>((origins[i].y - (height / scale)) / unitsPerEm));
+        atlasGlyph.planeMax = vec2(static_cast<float>((origins[i].x + (width / scale)) / unitsPerEm),
+                                   static_cast<float>(origins[i].y / unitsPerEm));
+    }
+
+    // Shelf packing, tallest glyphs first so that the shelves waste little height
+    std::vector<u32> packOrder;
+    for (u32 i = 0; i < atlas.glyphs.size(); ++i)
+    {
+        if (atlas.glyphs[i].size.x > 0)
+        {
+            packOrder.push_back(i);
+        }
+    }
+    std::ranges::sort(packOrder, [&](u32 lhs, u32 rhs) {
+        const AtlasGlyph& a = atlas.glyphs[lhs];
+        const AtlasGlyph& b = atlas.glyphs[rhs];
+        return a.size.y != b.size.y ? a.size.y > b.size.y : a.size.x > b.size.x;
+    });
+
+    u32 page = 0;
+    uvec2 cursor{0};
+    u32 shelfHeight = 0;
+    for (u32 i : packOrder)
+    {
+        AtlasGlyph& atlasGlyph = atlas.glyphs[i];
+        if (cursor.x + atlasGlyph.size.x + GLYPH_SPACING > settings.pageSize)
+        {
+            cursor = uvec2(0, cursor.y + shelfHeight);
+            shelfHeight = 0;
+        }
+        if (cursor.y + atlasGlyph.size.y + GLYPH_SPACING > settings.pageSize)
+        {
+            ++page;
+            cursor = uvec2(0);
+            shelfHeight = 0;
+        }
+        atlasGlyph.page = page;
+        atlasGlyph.position = u16vec2(static_cast<u16>(cursor.x), static_cast<u16>(cursor.y));
+        cursor.x += atlasGlyph.size.x + GLYPH_SPACING;
+        shelfHeight = std::max<u32>(shelfHeight, atlasGlyph.size.y + GLYPH_SPACING);
+    }
+
+    atlas.pages.resize(packOrder.empty() ? 0 : page + 1);
+    for (TextureData& pageData : atlas.pages)
+    {
+        pageData.width = settings.pageSize;
+        pageData.height = settings.pageSize;
+        pageData.format = GraphicsDataFormat::RGBA_8_UNORM;
+        pageData.texelSize = 4;
+        pageData.texels.assign(static_cast<u64>(settings.pageSize) * settings.pageSize * 4, 0);
+    }
+
+    // Glyphs own disjoint rectangles of the pages, so every glyph is generated and written on its own thread
+    parallelFor(packOrder.size(), [&](u64 i) {
+        u32 entry = packOrder[i];
+        const AtlasGlyph& atlasGlyph = atlas.glyphs[entry];
+        std::vector<float> field = generateGlyphMsdf(*glyphs[entry], atlasGlyph.size.x, atlasGlyph.size.y,
+                                                     origins[entry], scale, settings.pixelRange);
+
+        std::vector<u8>& texels = atlas.pages[atlasGlyph.page].texels;
+        for (u32 y = 0; y < atlasGlyph.size.y; ++y)
+        {
+            u64 rowStart =
+                ((static_cast<u64>(atlasGlyph.position.y + y) * settings.pageSize) + atlasGlyph.position.x) * 4;
+            for (u32 x = 0; x < atlasGlyph.size.x; ++x)
+            {
+                const float* value = &field[((static_cast<u64>(y) * atlasGlyph.size.x) + x) * 3];
+                u8* texel = &texels[rowStart + (x * 4)];
+                for (u32 c = 0; c < 3; ++c)
+                {
+                    texel[c] = static_cast<u8>(std::clamp(value[c] * 255.0f + 0.5f, 0.0f, 255.0f));
+                }
+                texel[3] = 255;
+            }
+        }
+    });
+
+    return atlas;
+}
+
+GlyphAtlas loadGlyphAtlas(Font& font, std::span<const u32> glyphIndices, const GlyphAtlasSettings& settings)
+{
+    if (!font.isLoaded())
+    {
+        return buildGlyphAtlas(font, glyphIndices, settings);
+    }
+
+    u64 fontHash = computeFontHash(font.getBytes());
+    u64 cacheKey = computeGlyphAtlasCacheKey(fontHash, glyphIndices, settings);
+    std::string cachePath = getGlyphAtlasCachePath(cacheKey);
+    std::optional<GlyphAtlas> cachedAtlas = readGlyphAtlasCache(cachePath, cacheKey);
+    if (cachedAtlas.has_value())
+    {
+        return std::move(cachedAtlas.value());
+    }
+
+    GlyphAtlas atlas = buildGlyphAtlas(font, glyphIndices, settings);
+    if (!atlas.glyphs.empty())
+    {
+        writeGlyphAtlasCache(cachePath, cacheKey, atlas);
+    }
+    return atlas;
+}
+
+} // namespace huedra
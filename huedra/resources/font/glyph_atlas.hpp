@@ -0,0 +1,51 @@
+#pragma once
+
+#include "core/types.hpp"
+#include "math/vec2.hpp"
+#include "resources/font/font.hpp"
+#include "resources/texture/data.hpp"
+
+#include <span>
+#include <vector>
+
+namespace huedra {
+
+struct GlyphAtlasSettings
+{
+    u32 glyphSize{48};      // Texels per em
+    float pixelRange{4.0f}; // Texels covered by the distance range, outlines can be offset by up to half of it
+    u32 pageSize{1024};     // Width and height of a page in texels
+};
+
+struct AtlasGlyph
+{
+    u32 glyphIndex{0};
+    u32 page{0};
+    u16vec2 position{0}; // Top left texel in the page
+    u16vec2 size{0};     // Texels, zero for glyphs without an outline
+    vec2 planeMin{0.0f}; // Quad covered by the texels relative to the pen position, in ems
+    vec2 planeMax{0.0f};
+    float advance{0.0f}; // Ems
+};
+
+// Multi-channel signed distance fields of a set of glyphs packed into pages. Text is drawn with a quad per glyph
+// sampling the page, the distance is the median of the rgb channels. Pages are RGBA_8_UNORM with alpha unused
+struct GlyphAtlas
+{
+    GlyphAtlasSettings settings;
+    std::vector<AtlasGlyph> glyphs; // Sorted by glyph index
+    std::vector<TextureData> pages;
+
+    // Returns nullptr for glyphs that are not in the atlas
+    const AtlasGlyph* findGlyph(u32 glyphIndex) const;
+};
+
+// Decodes the glyphs, packs them into pages and generates their fields in parallel. Duplicate and out of range glyph
+// indices are ignored
+GlyphAtlas buildGlyphAtlas(Font& font, std::span<const u32> glyphIndices, const GlyphAtlasSettings& settings = {});
+
+// Same as buildGlyphAtlas(), but reads the atlas from the disk cache if it was built before for the same font, glyphs
+// and settings. A built atlas is written to the cache
+GlyphAtlas loadGlyphAtlas(Font& font, std::span<const u32> glyphIndices, const GlyphAtlasSettings& settings = {});
+
+} // namespace huedra
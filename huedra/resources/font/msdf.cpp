@@ -0,0 +1,608 @@
+#include "msdf.hpp"
+#include "math/vec_transform.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+namespace huedra {
+
+namespace {
+
+// Channels an edge contributes to, one bit per channel
+enum EdgeColor : u8
+{
+    EDGE_COLOR_BLACK = 0,
+    EDGE_COLOR_RED = 1,
+    EDGE_COLOR_GREEN = 2,
+    EDGE_COLOR_YELLOW = 3,
+    EDGE_COLOR_BLUE = 4,
+    EDGE_COLOR_MAGENTA = 5,
+    EDGE_COLOR_CYAN = 6,
+    EDGE_COLOR_WHITE = 7
+};
+
+// Corners sharper than this angle (radians) between the tangents of two edges get different colours on both sides
+constexpr double CORNER_ANGLE_THRESHOLD = 3.0;
+// Neighbouring texels whose channels differ by more than this many texels of distance are treated as a clash
+constexpr double CLASH_THRESHOLD = 1.001;
+
+dvec2 normalizeOrUp(dvec2 vec)
+{
+    double len = math::length(vec);
+    return len == 0.0 ? dvec2(0.0, 1.0) : vec / len;
+}
+
+double nonZeroSign(double value) { return value > 0.0 ? 1.0 : -1.0; }
+
+// Linear or quadratic bezier segment of a contour, linear edges don't use control
+struct Edge
+{
+    dvec2 start{0.0};
+    dvec2 control{0.0};
+    dvec2 end{0.0};
+    bool quadratic{false};
+    u8 color{EDGE_COLOR_WHITE};
+
+    dvec2 point(double t) const
+    {
+        if (!quadratic)
+        {
+            return start + ((end - start) * t);
+        }
+        dvec2 a = start + ((control - start) * t);
+        dvec2 b = control + ((end - control) * t);
+        return a + ((b - a) * t);
+    }
+
+    dvec2 direction(double t) const
+    {
+        if (!quadratic)
+        {
+            return end - start;
+        }
+        dvec2 tangent = (control - start) + (((end - control) - (control - start)) * t);
+        return tangent == dvec2(0.0) ? end - start : tangent;
+    }
+
+    std::array<Edge, 3> splitInThirds() const
+    {
+        if (!quadratic)
+        {
+            return {Edge{.start = start, .end = point(1.0 / 3.0), .color = color},
+                    Edge{.start = point(1.0 / 3.0), .end = point(2.0 / 3.0), .color = color},
+                    Edge{.start = point(2.0 / 3.0), .end = end, .color = color}};
+        }
+        dvec2 firstControl = start + ((control - start) * (1.0 / 3.0));
+        dvec2 middleControl =
+            ((start + ((control - start) * (5.0 / 9.0))) + (control + ((end - control) * (4.0 / 9.0)))) * 0.5;
+        dvec2 lastControl = control + ((end - control) * (2.0 / 3.0));
+        return {Edge{.start = start,
+                     .control = firstControl,
+                     .end = point(1.0 / 3.0),
+                     .quadratic = true,
+                     .color = color},
+                Edge{.start = point(1.0 / 3.0),
+                     .control = middleControl,
+                     .end = point(2.0 / 3.0),
+                     .quadratic = true,
+                     .color = color},
+                Edge{.start = point(2.0 / 3.0), .control = lastControl, .end = end, .quadratic = true, .color = color}};
+    }
+};
+
+using Contour = std::vector<Edge>;
+
+// Distances are compared by magnitude, ties (the closest point is a shared end point) go to the edge that points more
+// directly away from the sample
+struct SignedDistance
+{
+    double distance{-std::numeric_limits<double>::max()};
+    double dot{1.0};
+
+    bool operator<(const SignedDistance& rhs) const
+    {
+        return std::abs(distance) < std::abs(rhs.distance) ||
+               (std::abs(distance) == std::abs(rhs.distance) && dot < rhs.dot);
+    }
+};
+
+u32 solveQuadratic(std::array<double, 3>& roots, double a, double b, double c)
+{
+    if (a == 0.0 || std::abs(b) > 1e12 * std::abs(a))
+    {
+        if (b == 0.0)
+        {
+            return 0;
+        }
+        roots[0] = -c / b;
+        return 1;
+    }
+    double discriminant = (b * b) - (4.0 * a * c);
+    if (discriminant > 0.0)
+    {
+        discriminant = std::sqrt(discriminant);
+        roots[0] = (-b + discriminant) / (2.0 * a);
+        roots[1] = (-b - discriminant) / (2.0 * a);
+        return 2;
+    }
+    if (discriminant == 0.0)
+    {
+        roots[0] = -b / (2.0 * a);
+        return 1;
+    }
+    return 0;
+}
+
+// Real roots of a * x^3 + b * x^2 + c * x + d, falls back to the quadratic when a is negligible
+u32 solveCubic(std::array<double, 3>& roots, double a, double b, double c, double d)
+{
+    if (a == 0.0 || std::abs(b / a) >= 1e6)
+    {
+        return solveQuadratic(roots, b, c, d);
+    }
+
+    // Normalized to x^3 + a * x^2 + b * x + c
+    double an = b / a;
+    double bn = c / a;
+    double cn = d / a;
+    double a2 = an * an;
+    double q = (a2 - (3.0 * bn)) / 9.0;
+    double r = ((an * ((2.0 * a2) - (9.0 * bn))) + (27.0 * cn)) / 54.0;
+    double r2 = r * r;
+    double q3 = q * q * q;
+    an /= 3.0;
+    if (r2 < q3)
+    {
+        double t = std::acos(std::clamp(r / std::sqrt(q3), -1.0, 1.0));
+        double m = -2.0 * std::sqrt(q);
+        roots[0] = (m * std::cos(t / 3.0)) - an;
+        roots[1] = (m * std::cos((t + (2.0 * std::numbers::pi)) / 3.0)) - an;
+        roots[2] = (m * std::cos((t - (2.0 * std::numbers::pi)) / 3.0)) - an;
+        return 3;
+    }
+    double u = (r < 0.0 ? 1.0 : -1.0) * std::cbrt(std::abs(r) + std::sqrt(r2 - q3));
+    double v = u == 0.0 ? 0.0 : q / u;
+    roots[0] = (u + v) - an;
+    if (u == v || std::abs(u - v) < 1e-12 * std::abs(u + v))
+    {
+        roots[1] = (-0.5 * (u + v)) - an;
+        return 2;
+    }
+    return 1;
+}
+
+// Signed distance from origin to the edge, param is the position of the closest point along the edge and is outside of
+// [0, 1] when the closest point is an end point
+SignedDistance signedDistance(const Edge& edge, dvec2 origin, double& param)
+{
+    if (!edge.quadratic)
+    {
+        dvec2 aq = origin - edge.start;
+        dvec2 ab = edge.end - edge.start;
+        param = math::dot(aq, ab) / math::dot(ab, ab);
+        dvec2 eq = (param > 0.5 ? edge.end : edge.start) - origin;
+        double endPointDistance = math::length(eq);
+        if (param > 0.0 && param < 1.0)
+        {
+            double orthoDistance = math::cross(aq, normalizeOrUp(ab));
+            if (std::abs(orthoDistance) < endPointDistance)
+            {
+                return {.distance = orthoDistance, .dot = 0.0};
+            }
+        }
+        return {.distance = nonZeroSign(math::cross(aq, ab)) * endPointDistance,
+                .dot = std::abs(math::dot(normalizeOrUp(ab), normalizeOrUp(eq)))};
+    }
+
+    // Closest point where the derivative of the squared distance is zero, a cubic in t
+    dvec2 qa = edge.start - origin;
+    dvec2 ab = edge.control - edge.start;
+    dvec2 br = edge.end - edge.control - ab;
+    std::array<double, 3> roots{};
+    u32 rootCount = solveCubic(roots, math::dot(br, br), 3.0 * math::dot(ab, br),
+                               (2.0 * math::dot(ab, ab)) + math::dot(qa, br), math::dot(qa, ab));
+
+    dvec2 startDirection = edge.direction(0.0);
+    double minDistance = nonZeroSign(math::cross(startDirection, qa)) * math::length(qa);
+    param = -math::dot(qa, startDirection) / math::dot(startDirection, startDirection);
+
+    dvec2 endDirection = edge.direction(1.0);
+    double endDistance = math::length(edge.end - origin);
+    if (endDistance < std::abs(minDistance))
+    {
+        minDistance = nonZeroSign(math::cross(endDirection, edge.end - origin)) * endDistance;
+        param = math::dot(origin - edge.control, endDirection) / math::dot(endDirection, endDirection);
+    }
+
+    for (u32 i = 0; i < rootCount; ++i)
+    {
+        double t = roots[i];
+        if (t > 0.0 && t < 1.0)
+        {
+            dvec2 qe = qa + (ab * (2.0 * t)) + (br * (t * t));
+            double distance = math::length(qe);
+            if (distance <= std::abs(minDistance))
+            {
+                minDistance = nonZeroSign(math::cross(ab + (br * t), qe)) * distance;
+                param = t;
+            }
+        }
+    }
+
+    if (param >= 0.0 && param <= 1.0)
+    {
+        return {.distance = minDistance, .dot = 0.0};
+    }
+    if (param < 0.5)
+    {
+        return {.distance = minDistance, .dot = std::abs(math::dot(normalizeOrUp(startDirection), normalizeOrUp(qa)))};
+    }
+    return {.distance = minDistance,
+            .dot = std::abs(math::dot(normalizeOrUp(endDirection), normalizeOrUp(edge.end - origin)))};
+}
+
+// Past the end points the distance to the extended tangent is used instead, so that the channels of two edges meeting
+// in a corner cross the outline at the corner itself
+void toPseudoDistance(const Edge& edge, SignedDistance& distance, dvec2 origin, double param)
+{
+    if (param < 0.0)
+    {
+        dvec2 direction = normalizeOrUp(edge.direction(0.0));
+        dvec2 aq = origin - edge.start;
+        if (math::dot(aq, direction) < 0.0)
+        {
+            double pseudoDistance = math::cross(aq, direction);
+            if (std::abs(pseudoDistance) <= std::abs(distance.distance))
+            {
+                distance = {.distance = pseudoDistance, .dot = 0.0};
+            }
+        }
+    }
+    else if (param > 1.0)
+    {
+        dvec2 direction = normalizeOrUp(edge.direction(1.0));
+        dvec2 bq = origin - edge.end;
+        if (math::dot(bq, direction) > 0.0)
+        {
+            double pseudoDistance = math::cross(bq, direction);
+            if (std::abs(pseudoDistance) <= std::abs(distance.distance))
+            {
+                distance = {.distance = pseudoDistance, .dot = 0.0};
+            }
+        }
+    }
+}
+
+// Converts the contours of a glyph to edges, consecutive off curve points get an implied on curve point in between
+std::vector<Contour> buildContours(const Glyph& glyph)
+{
+    std::vector<Contour> contours;
+    for (const GlyphContourRange& range : glyph.contourRanges)
+    {
+        if (range.end <= range.start || range.end >= glyph.points.size())
+        {
+            continue;
+        }
+        u32 count = range.end - range.start + 1;
+        u32 first = 0;
+        while (first < count && !glyph.points[range.start + first].onCurve)
+        {
+            ++first;
+        }
+        if (first == count)
+        {
+            continue;
+        }
+
+        Contour contour;
+        auto addEdge = [&contour](const Edge& edge) {
+            if (edge.start != edge.end || (edge.quadratic && edge.control != edge.start))
+            {
+                contour.push_back(edge);
+            }
+        };
+
+        auto getPoint = [&](u32 index) { return static_cast<dvec2>(glyph.points[range.start + index].position); };
+        dvec2 prevOnCurve = getPoint(first);
+        dvec2 control{0.0};
+        bool hasControl = false;
+        for (u32 i = 1; i <= count; ++i)
+        {
+            u32 index = (first + i) % count;
+            dvec2 point = getPoint(index);
+            if (glyph.points[range.start + index].onCurve)
+            {
+                addEdge(hasControl ? Edge{.start = prevOnCurve, .control = control, .end = point, .quadratic = true}
+                                   : Edge{.start = prevOnCurve, .end = point});
+                prevOnCurve = point;
+                hasControl = false;
+            }
+            else
+            {
+                if (hasControl)
+                {
+                    dvec2 implied = (control + point) * 0.5;
+                    addEdge(Edge{.start = prevOnCurve, .control = control, .end = implied, .quadratic = true});
+                    prevOnCurve = implied;
+                }
+                control = point;
+                hasControl = true;
+            }
+        }
+
+        if (!contour.empty())
+        {
+            contours.push_back(std::move(contour));
+        }
+    }
+    return contours;
+}
+
+void switchColor(u8& color, u8 banned = EDGE_COLOR_BLACK)
+{
+    u8 combined = color & banned;
+    if (combined == EDGE_COLOR_RED || combined == EDGE_COLOR_GREEN || combined == EDGE_COLOR_BLUE)
+    {
+        color = combined ^ EDGE_COLOR_WHITE;
+        return;
+    }
+    if (color == EDGE_COLOR_BLACK || color == EDGE_COLOR_WHITE)
+    {
+        color = EDGE_COLOR_CYAN;
+        return;
+    }
+    u32 shifted = static_cast<u32>(color) << 1;
+    color = static_cast<u8>((shifted | (shifted >> 3)) & EDGE_COLOR_WHITE);
+}
+
+// Every pair of edges meeting in a corner gets two colours that share exactly one channel, smooth contours stay white
+void colorEdges(std::vector<Contour>& contours)
+{
+    const double crossThreshold = std::sin(CORNER_ANGLE_THRESHOLD);
+    std::vector<u32> corners;
+    for (Contour& contour : contours)
+    {
+        corners.clear();
+        dvec2 prevDirection = contour.back().direction(1.0);
+        for (u32 i = 0; i < contour.size(); ++i)
+        {
+            dvec2 a = normalizeOrUp(prevDirection);
+            dvec2 b = normalizeOrUp(contour[i].direction(0.0));
+            if (math::dot(a, b) <= 0.0 || std::abs(math::cross(a, b)) > crossThreshold)
+            {
+                corners.push_back(i);
+            }
+            prevDirection = contour[i].direction(1.0);
+        }
+
+        if (corners.empty())
+        {
+            for (Edge& edge : contour)
+            {
+                edge.color = EDGE_COLOR_WHITE;
+            }
+        }
+        // Teardrop, a single corner needs three colours spread over the contour
+        else if (corners.size() == 1)
+        {
+            std::array<u8, 3> colors{EDGE_COLOR_WHITE, EDGE_COLOR_WHITE, EDGE_COLOR_WHITE};
+            switchColor(colors[0]);
+            colors[2] = colors[0];
+            switchColor(colors[2]);
+
+            u32 corner = corners[0];
+            if (contour.size() >= 3)
+            {
+                auto edgeCount = static_cast<double>(contour.size());
+                for (u32 i = 0; i < contour.size(); ++i)
+                {
+                    auto third = static_cast<i32>(3.0 + (2.875 * i / (edgeCount - 1.0)) - 1.4375 + 0.5) - 3;
+                    contour[(corner + i) % contour.size()].color = colors[third + 1];
+                }
+            }
+            // Fewer edges than colours, split them
+            else
+            {
+                Contour parts;
+                if (contour.size() == 1)
+                {
+                    std::array<Edge, 3> thirds = contour[0].splitInThirds();
+                    for (u32 i = 0; i < 3; ++i)
+                    {
+                        thirds[i].color = colors[i];
+                        parts.push_back(thirds[i]);
+                    }
+                }
+                else
+                {
+                    std::array<Edge, 3> cornerThirds = contour[corner].splitInThirds();
+                    std::array<Edge, 3> otherThirds = contour[1 - corner].splitInThirds();
+                    parts.insert(parts.end(), cornerThirds.begin(), cornerThirds.end());
+                    parts.insert(parts.end(), otherThirds.begin(), otherThirds.end());
+                    for (u32 i = 0; i < parts.size(); ++i)
+                    {
+                        parts[i].color = colors[i / 2];
+                    }
+                }
+                contour = std::move(parts);
+            }
+        }
+        // Switch colour at every corner, the last spline must not share a colour with the first one
+        else
+        {
+            u32 spline = 0;
+            u32 start = corners[0];
+            u8 color = EDGE_COLOR_WHITE;
+            switchColor(color);
+            u8 initialColor = color;
+            for (u32 i = 0; i < contour.size(); ++i)
+            {
+                u32 index = (start + i) % contour.size();
+                if (spline + 1 < corners.size() && corners[spline + 1] == index)
+                {
+                    ++spline;
+                    switchColor(color, spline == corners.size() - 1 ? initialColor : static_cast<u8>(EDGE_COLOR_BLACK));
+                }
+                contour[index].color = color;
+            }
+        }
+    }
+}
+
+float median(float a, float b, float c) { return std::max(std::min(a, b), std::min(std::max(a, b), c)); }
+
+// Two texels clash when a channel changes more than the distance between them allows, only the texel farther from the
+// outline is flagged
+bool detectClash(const float* a, const float* b, float threshold)
+{
+    std::array<float, 3> ac{a[0], a[1], a[2]};
+    std::array<float, 3> bc{b[0], b[1], b[2]};
+    // Sort channel pairs from the largest to the smallest difference
+    if (std::abs(bc[0] - ac[0]) < std::abs(bc[1] - ac[1]))
+    {
+        std::swap(ac[0], ac[1]);
+        std::swap(bc[0], bc[1]);
+    }
+    if (std::abs(bc[1] - ac[1]) < std::abs(bc[2] - ac[2]))
+    {
+        std::swap(ac[1], ac[2]);
+        std::swap(bc[1], bc[2]);
+        if (std::abs(bc[0] - ac[0]) < std::abs(bc[1] - ac[1]))
+        {
+            std::swap(ac[0], ac[1]);
+            std::swap(bc[0], bc[1]);
+        }
+    }
+    return std::abs(bc[1] - ac[1]) >= threshold && !(bc[0] == bc[1] && bc[0] == bc[2]) &&
+           std::abs(ac[2] - 0.5f) >= std::abs(bc[2] - 0.5f);
+}
+
+void correctErrors(std::vector<float>& texels, u32 width, u32 height, double pixelRange)
+{
+    auto threshold = static_cast<float>(CLASH_THRESHOLD / pixelRange);
+    auto diagonalThreshold = static_cast<float>(CLASH_THRESHOLD * std::numbers::sqrt2 / pixelRange);
+    auto texel = [&](u32 x, u32 y) { return &texels[((static_cast<u64>(y) * width) + x) * 3]; };
+
+    std::vector<u32> clashes;
+    auto flatten = [&]() {
+        for (u32 index : clashes)
+        {
+            float* value = &texels[static_cast<u64>(index) * 3];
+            float med = median(value[0], value[1], value[2]);
+            value[0] = med;
+            value[1] = med;
+            value[2] = med;
+        }
+        clashes.clear();
+    };
+
+    for (u32 y = 0; y < height; ++y)
+    {
+        for (u32 x = 0; x < width; ++x)
+        {
+            const float* value = texel(x, y);
+            if ((x > 0 && detectClash(value, texel(x - 1, y), threshold)) ||
+                (x < width - 1 && detectClash(value, texel(x + 1, y), threshold)) ||
+                (y > 0 && detectClash(value, texel(x, y - 1), threshold)) ||
+                (y < height - 1 && detectClash(value, texel(x, y + 1), threshold)))
+            {
+                clashes.push_back((y * width) + x);
+            }
+        }
+    }
+    flatten();
+
+    for (u32 y = 0; y < height; ++y)
+    {
+        for (u32 x = 0; x < width; ++x)
+        {
+            const float* value = texel(x, y);
+            if ((x > 0 && y > 0 && detectClash(value, texel(x - 1, y - 1), diagonalThreshold)) ||
+                (x < width - 1 && y > 0 && detectClash(value, texel(x + 1, y - 1), diagonalThreshold)) ||
+                (x > 0 && y < height - 1 && detectClash(value, texel(x - 1, y + 1), diagonalThreshold)) ||
+                (x < width - 1 && y < height - 1 && detectClash(value, texel(x + 1, y + 1), diagonalThreshold)))
+            {
+                clashes.push_back((y * width) + x);
+            }
+        }
+    }
+    flatten();
+}
+
+} // namespace
+
+std::vector<float> generateGlyphMsdf(const Glyph& glyph, u32 width, u32 height, dvec2 origin, double scale,
+                                     double pixelRange)
+{
+    std::vector<Contour> contours = buildContours(glyph);
+    // Without an outline every texel is outside
+    std::vector<float> texels(static_cast<u64>(width) * height * 3, 0.0f);
+    if (contours.empty())
+    {
+        return texels;
+    }
+    colorEdges(contours);
+
+    // True type outlines are clockwise with the filled area on the right, fonts with the opposite winding are flipped
+    double area = 0.0;
+    for (const Contour& contour : contours)
+    {
+        for (const Edge& edge : contour)
+        {
+            area += edge.quadratic ? math::cross(edge.start, edge.control) + math::cross(edge.control, edge.end)
+                                   : math::cross(edge.start, edge.end);
+        }
+    }
+    double orientation = area > 0.0 ? -1.0 : 1.0;
+
+    struct Channel
+    {
+        SignedDistance distance;
+        const Edge* edge{nullptr};
+        double param{0.0};
+    };
+
+    for (u32 y = 0; y < height; ++y)
+    {
+        for (u32 x = 0; x < width; ++x)
+        {
+            dvec2 point = origin + (dvec2(x + 0.5, -(y + 0.5)) / scale);
+            std::array<Channel, 3> channels{};
+            for (const Contour& contour : contours)
+            {
+                for (const Edge& edge : contour)
+                {
+                    double param = 0.0;
+                    SignedDistance distance = signedDistance(edge, point, param);
+                    for (u32 c = 0; c < 3; ++c)
+                    {
+                        if ((edge.color & (1u << c)) != 0 && distance < channels[c].distance)
+                        {
+                            channels[c] = {.distance = distance, .edge = &edge, .param = param};
+                        }
+                    }
+                }
+            }
+
+            float* texel = &texels[((static_cast<u64>(y) * width) + x) * 3];
+            for (u32 c = 0; c < 3; ++c)
+            {
+                if (channels[c].edge != nullptr)
+                {
+                    toPseudoDistance(*channels[c].edge, channels[c].distance, point, channels[c].param);
+                }
+                double distance = channels[c].edge != nullptr ? channels[c].distance.distance * orientation
+                                                              : -std::numeric_limits<double>::max();
+                texel[c] = static_cast<float>(std::max((distance * scale / pixelRange) + 0.5, -1e6));
+            }
+        }
+    }
+
+    correctErrors(texels, width, height, pixelRange);
+    return texels;
+}
+
+} // namespace huedra
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "core/types.hpp"
+#include "math/vec2.hpp"
+#include "resources/font/data.hpp"
+
+#include <vector>
+
+namespace huedra {
+
+// Generates the multi-channel signed distance field of a glyph outline into width * height texels of 3 floats (RGB),
+// row 0 is the top of the bitmap. Texel (x, y) samples the outline at origin + ((x + 0.5), -(y + 0.5)) / scale in font
+// units, so origin is the top left corner of the bitmap and scale is texels per font unit. Distances are stored as
+// distance * scale / pixelRange + 0.5, the outline is at 0.5 and the inside above it.
+// Edges are coloured so that the median of the three channels keeps corners sharp, texels where the channels of
+// neighbours clash are flattened to their median afterwards
+std::vector<float> generateGlyphMsdf(const Glyph& glyph, u32 width, u32 height, dvec2 origin, double scale,
+                                     double pixelRange);
+
+} // namespace huedra
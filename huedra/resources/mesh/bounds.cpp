@@ -0,0 +1,187 @@
+#include "bounds.hpp"
+#include "math/vec_transform.hpp"
+
+#include <array>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BOUNDS_SSE
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define BOUNDS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace huedra {
+
+namespace {
+
+static_assert(sizeof(vec3) == sizeof(float) * 3, "positions are read as a packed float array");
+
+// The SIMD paths handle 4 positions per iteration and return how many positions they processed, the rest is handled
+// by the scalar loops. SSE2 and NEON are part of the base instruction sets of x86-64 and arm64, so no runtime check is
+// needed
+#if defined(BOUNDS_SSE)
+
+// Transposes 4 packed positions into one register per component
+void loadPositions(const float* data, __m128& x, __m128& y, __m128& z)
+{
+    __m128 a = _mm_loadu_ps(data);     // x0 y0 z0 x1
+    __m128 b = _mm_loadu_ps(data + 4); // y1 z1 x2 y2
+    __m128 c = _mm_loadu_ps(data + 8); // z2 x3 y3 z3
+    __m128 xy23 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+    __m128 yz01 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+    x = _mm_shuffle_ps(a, xy23, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(yz01, xy23, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm_shuffle_ps(yz01, c, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+float reduceMin(__m128 value)
+{
+    value = _mm_min_ps(value, _mm_movehl_ps(value, value));
+    value = _mm_min_ss(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(value);
+}
+
+float reduceMax(__m128 value)
+{
+    value = _mm_max_ps(value, _mm_movehl_ps(value, value));
+    value = _mm_max_ss(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(value);
+}
+
+u64 reduceAabb(const float* data, u64 count, vec3& aabbMin, vec3& aabbMax)
+{
+    __m128 minX = _mm_set1_ps(aabbMin.x);
+    __m128 minY = _mm_set1_ps(aabbMin.y);
+    __m128 minZ = _mm_set1_ps(aabbMin.z);
+    __m128 maxX = _mm_set1_ps(aabbMax.x);
+    __m128 maxY = _mm_set1_ps(aabbMax.y);
+    __m128 maxZ = _mm_set1_ps(aabbMax.z);
+    u64 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x;
+        __m128 y;
+        __m128 z;
+        loadPositions(data + (i * 3), x, y, z);
+        minX = _mm_min_ps(minX, x);
+        minY = _mm_min_ps(minY, y);
+        minZ = _mm_min_ps(minZ, z);
+        maxX = _mm_max_ps(maxX, x);
+        maxY = _mm_max_ps(maxY, y);
+        maxZ = _mm_max_ps(maxZ, z);
+    }
+    aabbMin = vec3(reduceMin(minX), reduceMin(minY), reduceMin(minZ));
+    aabbMax = vec3(reduceMax(maxX), reduceMax(maxY), reduceMax(maxZ));
+    return i;
+}
+
+u64 reduceDistanceSq(const float* data, u64 count, const vec3& center, float& maxDistanceSq)
+{
+    __m128 centerX = _mm_set1_ps(center.x);
+    __m128 centerY = _mm_set1_ps(center.y);
+    __m128 centerZ = _mm_set1_ps(center.z);
+    __m128 maximum = _mm_set1_ps(maxDistanceSq);
+    u64 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x;
+        __m128 y;
+        __m128 z;
+        loadPositions(data + (i * 3), x, y, z);
+        x = _mm_sub_ps(x, centerX);
+        y = _mm_sub_ps(y, centerY);
+        z = _mm_sub_ps(z, centerZ);
+        __m128 distanceSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        maximum = _mm_max_ps(maximum, distanceSq);
+    }
+    maxDistanceSq = reduceMax(maximum);
+    return i;
+}
+
+#elif defined(BOUNDS_NEON)
+
+u64 reduceAabb(const float* data, u64 count, vec3& aabbMin, vec3& aabbMax)
+{
+    std::array<float32x4_t, 3> minimum{vdupq_n_f32(aabbMin.x), vdupq_n_f32(aabbMin.y), vdupq_n_f32(aabbMin.z)};
+    std::array<float32x4_t, 3> maximum{vdupq_n_f32(aabbMax.x), vdupq_n_f32(aabbMax.y), vdupq_n_f32(aabbMax.z)};
+    u64 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        // Loads and transposes 4 packed positions into one register per component
+        float32x4x3_t components = vld3q_f32(data + (i * 3));
+        for (u64 j = 0; j < 3; ++j)
+        {
+            minimum[j] = vminq_f32(minimum[j], components.val[j]);
+            maximum[j] = vmaxq_f32(maximum[j], components.val[j]);
+        }
+    }
+    for (u64 j = 0; j < 3; ++j)
+    {
+        aabbMin[j] = vminvq_f32(minimum[j]);
+        aabbMax[j] = vmaxvq_f32(maximum[j]);
+    }
+    return i;
+}
+
+u64 reduceDistanceSq(const float* data, u64 count, const vec3& center, float& maxDistanceSq)
+{
+    float32x4_t maximum = vdupq_n_f32(maxDistanceSq);
+    u64 i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        float32x4x3_t components = vld3q_f32(data + (i * 3));
+        float32x4_t x = vsubq_f32(components.val[0], vdupq_n_f32(center.x));
+        float32x4_t y = vsubq_f32(components.val[1], vdupq_n_f32(center.y));
+        float32x4_t z = vsubq_f32(components.val[2], vdupq_n_f32(center.z));
+        float32x4_t distanceSq = vmlaq_f32(vmlaq_f32(vmulq_f32(x, x), y, y), z, z);
+        maximum = vmaxq_f32(maximum, distanceSq);
+    }
+    maxDistanceSq = vmaxvq_f32(maximum);
+    return i;
+}
+
+#else
+
+u64 reduceAabb(const float*, u64, vec3&, vec3&) { return 0; }
+u64 reduceDistanceSq(const float*, u64, const vec3&, float&) { return 0; }
+
+#endif
+
+} // namespace
+
+MeshBounds computeMeshBounds(std::span<const vec3> positions)
+{
+    MeshBounds bounds;
+    if (positions.empty())
+    {
+        return bounds;
+    }
+
+    const float* data = &positions[0].x;
+    bounds.aabbMin = positions[0];
+    bounds.aabbMax = positions[0];
+    for (u64 i = reduceAabb(data, positions.size(), bounds.aabbMin, bounds.aabbMax); i < positions.size(); ++i)
+    {
+        for (u64 j = 0; j < 3; ++j)
+        {
+            bounds.aabbMin[j] = std::min(bounds.aabbMin[j], positions[i][j]);
+            bounds.aabbMax[j] = std::max(bounds.aabbMax[j], positions[i][j]);
+        }
+    }
+
+    bounds.center = (bounds.aabbMin + bounds.aabbMax) * 0.5f;
+    float maxDistanceSq = 0.0f;
+    for (u64 i = reduceDistanceSq(data, positions.size(), bounds.center, maxDistanceSq); i < positions.size(); ++i)
+    {
+        vec3 offset = positions[i] - bounds.center;
+        maxDistanceSq = std::max(maxDistanceSq, math::dot(offset, offset));
+    }
+    bounds.radius = std::sqrt(maxDistanceSq);
+    return bounds;
+}
+
+void updateMeshBounds(MeshData& meshData) { meshData.bounds = computeMeshBounds(meshData.positions); }
+
+} // namespace huedra
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "core/types.hpp"
+#include "resources/mesh/data.hpp"
+
+#include <span>
+
+namespace huedra {
+
+// Aabb of the positions and the sphere around its center. Empty positions give empty bounds at the origin
+MeshBounds computeMeshBounds(std::span<const vec3> positions);
+
+// Recomputes MeshData::bounds, call after the positions have been edited
+void updateMeshBounds(MeshData& meshData);
+
+} // namespace huedra
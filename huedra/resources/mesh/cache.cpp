@@ -0,0 +1,282 @@
+#include "cache.hpp"
+#include "core/file/mapped_file.hpp"
+#include "core/file/utils.hpp"
+#include "core/log.hpp"
+#include "core/memory/hash.hpp"
+#include "resources/mesh/loader.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+
+namespace huedra {
+
+namespace {
+
+static_assert(std::is_trivially_copyable_v<MeshCacheHeader> && std::is_trivially_copyable_v<MeshCacheEntry>);
+static_assert(std::is_trivially_copyable_v<vec3> && std::is_trivially_copyable_v<vec2>);
+static_assert(std::is_trivially_copyable_v<vec4>);
+static_assert(std::is_trivially_copyable_v<MeshLod> && std::is_trivially_copyable_v<Meshlet>);
+static_assert(std::is_trivially_copyable_v<MeshNode> && std::is_trivially_copyable_v<MeshBounds>);
+
+constexpr u64 alignOffset(u64 offset) { return (offset + MESH_CACHE_ALIGNMENT - 1) & ~(MESH_CACHE_ALIGNMENT - 1); }
+
+// The blobs are copied without parsing, every index is checked so a corrupt file can not index out of range later
+bool validateMeshData(const MeshData& meshData)
+{
+    u64 vertexCount = meshData.positions.size();
+    auto indicesInRange = [](const std::vector<u32>& indices, u64 count) {
+        return std::ranges::all_of(indices, [count](u32 index) { return index < count; });
+    };
+    if ((!meshData.uvs.empty() && meshData.uvs.size() != vertexCount) ||
+        (!meshData.normals.empty() && meshData.normals.size() != vertexCount) ||
+        (!meshData.tangents.empty() && meshData.tangents.size() != vertexCount) ||
+        !indicesInRange(meshData.indices, vertexCount) || !indicesInRange(meshData.lodIndices, vertexCount) ||
+        !indicesInRange(meshData.meshletVertices, vertexCount))
+    {
+        return false;
+    }
+
+    // Offsets and counts are u32, their sums can not overflow in u64
+    for (const MeshLod& lod : meshData.lods)
+    {
+        if (static_cast<u64>(lod.indexOffset) + lod.indexCount > meshData.lodIndices.size())
+        {
+            return false;
+        }
+    }
+    for (const Meshlet& meshlet : meshData.meshlets)
+    {
+        u64 triangleEnd = static_cast<u64>(meshlet.triangleOffset) + (static_cast<u64>(meshlet.triangleCount) * 3);
+        if (static_cast<u64>(meshlet.vertexOffset) + meshlet.vertexCount > meshData.meshletVertices.size() ||
+            triangleEnd > meshData.meshletTriangles.size())
+        {
+            return false;
+        }
+        for (u64 i = meshlet.triangleOffset; i < triangleEnd; ++i)
+        {
+            if (meshData.meshletTriangles[i] >= meshlet.vertexCount)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+u64 computeMeshCacheKey(const std::string& sourcePath, const MeshLodSettings& lodSettings)
+{
+    MappedFile source;
+    if (!source.open(sourcePath))
+    {
+        return 0;
+    }
+
+    u64 key = hashBytes(source.getBytes(), MESH_CACHE_VERSION);
+
+    // External buffers are part of the source, geometry edits only change the .bin files
+    if (transformFilePath(sourcePath).extension == "gltf")
+    {
+        std::vector<std::string> bufferPaths;
+        if (!getGltfBufferPaths(sourcePath, bufferPaths))
+        {
+            return 0;
+        }
+        for (const std::string& bufferPath : bufferPaths)
+        {
+            MappedFile buffer;
+            if (!buffer.open(bufferPath))
+            {
+                return 0;
+            }
+            key = hashBytes(buffer.getBytes(), key);
+        }
+    }
+
+    key = hashValue(key, lodSettings.lodCount);
+    key = hashValue(key, std::bit_cast<u32>(lodSettings.ratio));
+    key = hashValue(key, std::bit_cast<u32>(lodSettings.maxError));
+    key = hashValue(key, std::bit_cast<u32>(lodSettings.options.uvWeight));
+    key = hashValue(key, std::bit_cast<u32>(lodSettings.options.normalWeight));
+    key = hashValue(key, static_cast<u32>(lodSettings.options.lockBorder));
+    return key == 0 ? 1 : key;
+}
+
+std::string getMeshCachePath(const std::string& sourcePath)
+{
+    // The hash of the path keeps files with the same name in different directories apart
+    std::array<char, 16> hex{};
+    u64 pathHash = hashBytes(std::span(reinterpret_cast<const u8*>(sourcePath.data()), sourcePath.size()), 0);
+    char* hexEnd = std::to_chars(hex.data(), hex.data() + hex.size(), pathHash, 16).ptr;
+    FilePathInfo info = transformFilePath(sourcePath);
+    return std::string(MESH_CACHE_DIRECTORY) + "/" + info.fileName + "_" + std::string(hex.data(), hexEnd) + ".hmesh";
+}
+
+std::optional<std::vector<MeshData>> readMeshCache(const std::string& cachePath, u64 key, std::vector<MeshNode>& nodes)
+{
+    std::error_code error;
+    if (!std::filesystem::exists(cachePath, error))
+    {
+        return std::nullopt;
+    }
+
+    MappedFile file(cachePath);
+    if (!file.isOpen() || file.size() < sizeof(MeshCacheHeader))
+    {
+        return std::nullopt;
+    }
+
+    MeshCacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(MeshCacheHeader));
+    if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION || header.key != key)
+    {
+        return std::nullopt;
+    }
+    if (header.fileSize != file.size() || header.entrySize != sizeof(MeshCacheEntry) ||
+        header.meshCount > (file.size() - sizeof(MeshCacheHeader)) / sizeof(MeshCacheEntry))
+    {
+        log(LogLevel::WARNING, "readMeshCache(): \"{}\" is malformed", cachePath.c_str());
+        return std::nullopt;
+    }
+
+    // Blob offsets are resolved against the mapping and copied straight into the mesh data
+    auto readBlob = [&file]<typename Container>(const MeshCacheBlob& blob, Container& values) {
+        using T = Container::value_type;
+        if (blob.offset % MESH_CACHE_ALIGNMENT != 0 || blob.offset > file.size() ||
+            blob.count > (file.size() - blob.offset) / sizeof(T))
+        {
+            return false;
+        }
+        values.resize(blob.count);
+        if (blob.count > 0)
+        {
+            std::memcpy(values.data(), file.data() + blob.offset, blob.count * sizeof(T));
+        }
+        return true;
+    };
+
+    if (!readBlob(header.nodes, nodes))
+    {
+        log(LogLevel::WARNING, "readMeshCache(): \"{}\" has blobs out of bounds", cachePath.c_str());
+        return std::nullopt;
+    }
+
+    std::vector<MeshData> meshDatas(header.meshCount);
+    for (u32 i = 0; i < header.meshCount; ++i)
+    {
+        MeshCacheEntry entry;
+        std::memcpy(&entry, file.data() + sizeof(MeshCacheHeader) + (i * sizeof(MeshCacheEntry)),
+                    sizeof(MeshCacheEntry));
+
+        MeshData& meshData = meshDatas[i];
+        meshData.bounds = entry.bounds;
+        bool valid = readBlob(entry.name, meshData.name) && readBlob(entry.positions, meshData.positions) &&
+                     readBlob(entry.uvs, meshData.uvs) && readBlob(entry.normals, meshData.normals) &&
+                     readBlob(entry.tangents, meshData.tangents) && readBlob(entry.indices, meshData.indices) &&
+                     readBlob(entry.lods, meshData.lods) && readBlob(entry.lodIndices, meshData.lodIndices) &&
+                     readBlob(entry.meshlets, meshData.meshlets) &&
+                     readBlob(entry.meshletVertices, meshData.meshletVertices) &&
+                     readBlob(entry.meshletTriangles, meshData.meshletTriangles);
+        if (!valid)
+        {
+            log(LogLevel::WARNING, "readMeshCache(): \"{}\" has blobs out of bounds", cachePath.c_str());
+            return std::nullopt;
+        }
+        if (!validateMeshData(meshData))
+        {
+            log(LogLevel::WARNING, "readMeshCache(): \"{}\" has mesh data out of range", cachePath.c_str());
+            return std::nullopt;
+        }
+    }
+
+    // Parents are stored before their children
+    for (u64 i = 0; i < nodes.size(); ++i)
+    {
+        if ((nodes[i].parent != MESH_NODE_NONE && nodes[i].parent >= i) ||
+            (nodes[i].mesh != MESH_NODE_NONE && nodes[i].mesh >= header.meshCount))
+        {
+            log(LogLevel::WARNING, "readMeshCache(): \"{}\" has nodes out of range", cachePath.c_str());
+            return std::nullopt;
+        }
+    }
+    return meshDatas;
+}
+
+bool writeMeshCache(const std::string& cachePath, u64 key, const std::vector<MeshData>& meshDatas,
+                    const std::vector<MeshNode>& nodes)
+{
+    u64 offset = alignOffset(sizeof(MeshCacheHeader) + (meshDatas.size() * sizeof(MeshCacheEntry)));
+    auto reserveBlob = [&offset](const auto& values) {
+        MeshCacheBlob blob{.offset = offset, .count = values.size()};
+        offset = alignOffset(offset + (values.size() * sizeof(values[0])));
+        return blob;
+    };
+
+    MeshCacheHeader header;
+    header.key = key;
+    header.meshCount = static_cast<u32>(meshDatas.size());
+    header.nodes = reserveBlob(nodes);
+
+    std::vector<MeshCacheEntry> entries(meshDatas.size());
+    for (u64 i = 0; i < meshDatas.size(); ++i)
+    {
+        const MeshData& meshData = meshDatas[i];
+        MeshCacheEntry& entry = entries[i];
+        entry.name = reserveBlob(meshData.name);
+        entry.positions = reserveBlob(meshData.positions);
+        entry.uvs = reserveBlob(meshData.uvs);
+        entry.normals = reserveBlob(meshData.normals);
+        entry.tangents = reserveBlob(meshData.tangents);
+        entry.indices = reserveBlob(meshData.indices);
+        entry.lods = reserveBlob(meshData.lods);
+        entry.lodIndices = reserveBlob(meshData.lodIndices);
+        entry.meshlets = reserveBlob(meshData.meshlets);
+        entry.meshletVertices = reserveBlob(meshData.meshletVertices);
+        entry.meshletTriangles = reserveBlob(meshData.meshletTriangles);
+        entry.bounds = meshData.bounds;
+    }
+
+    header.fileSize = offset;
+
+    std::vector<u8> bytes(offset, 0);
+    std::memcpy(bytes.data(), &header, sizeof(MeshCacheHeader));
+    std::memcpy(bytes.data() + sizeof(MeshCacheHeader), entries.data(), entries.size() * sizeof(MeshCacheEntry));
+    auto writeBlob = [&bytes](const MeshCacheBlob& blob, const auto& values) {
+        if (!values.empty())
+        {
+            std::memcpy(bytes.data() + blob.offset, values.data(), values.size() * sizeof(values[0]));
+        }
+    };
+    writeBlob(header.nodes, nodes);
+    for (u64 i = 0; i < meshDatas.size(); ++i)
+    {
+        const MeshData& meshData = meshDatas[i];
+        const MeshCacheEntry& entry = entries[i];
+        writeBlob(entry.name, meshData.name);
+        writeBlob(entry.positions, meshData.positions);
+        writeBlob(entry.uvs, meshData.uvs);
+        writeBlob(entry.normals, meshData.normals);
+        writeBlob(entry.tangents, meshData.tangents);
+        writeBlob(entry.indices, meshData.indices);
+        writeBlob(entry.lods, meshData.lods);
+        writeBlob(entry.lodIndices, meshData.lodIndices);
+        writeBlob(entry.meshlets, meshData.meshlets);
+        writeBlob(entry.meshletVertices, meshData.meshletVertices);
+        writeBlob(entry.meshletTriangles, meshData.meshletTriangles);
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), error);
+    if (error)
+    {
+        log(LogLevel::WARNING, "writeMeshCache(): could not create directory for \"{}\"", cachePath.c_str());
+        return false;
+    }
+    return writeBytes(cachePath, bytes);
+}
+
+} // namespace huedra
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core/types.hpp"
+#include "resources/mesh/data.hpp"
+#include "resources/mesh/simplifier.hpp"
+
+#include <optional>
+
+namespace huedra {
+
+// Binary mesh cache (.hmesh), written after the first import of a source file and mapped on later loads. Layout:
+//     MeshCacheHeader
+//     MeshCacheEntry[meshCount]
+//     blobs, the nodes of the file followed by the data of every mesh
+// Every blob is aligned to MESH_CACHE_ALIGNMENT and stored as the in memory layout of its elements.
+// All offsets are relative to the start of the file. Data is stored in native endianness, a file written on a machine
+// with other endianness fails the magic check and is rebuilt
+constexpr u32 MESH_CACHE_MAGIC = 0x48534d48; // "HMSH"
+constexpr u32 MESH_CACHE_VERSION = 5;        // Bump when the layout or the processing of stored data changes
+constexpr u64 MESH_CACHE_ALIGNMENT = 16;
+constexpr const char* MESH_CACHE_DIRECTORY = "cache/meshes";
+
+struct MeshCacheBlob
+{
+    u64 offset{0};
+    u64 count{0}; // Elements, not bytes
+};
+
+struct MeshCacheEntry
+{
+    MeshCacheBlob name;
+    MeshCacheBlob positions;
+    MeshCacheBlob uvs;
+    MeshCacheBlob normals;
+    MeshCacheBlob tangents;
+    MeshCacheBlob indices;
+    MeshCacheBlob lods;
+    MeshCacheBlob lodIndices;
+    MeshCacheBlob meshlets;
+    MeshCacheBlob meshletVertices;
+    MeshCacheBlob meshletTriangles;
+    MeshBounds bounds;
+};
+
+struct MeshCacheHeader
+{
+    u32 magic{MESH_CACHE_MAGIC};
+    u32 version{MESH_CACHE_VERSION};
+    u64 key{0};      // Hash of the source file and the import settings
+    u64 fileSize{0}; // Catches truncated writes
+    u32 meshCount{0};
+    u32 entrySize{sizeof(MeshCacheEntry)};
+    MeshCacheBlob nodes;
+};
+
+// Cache key of a source file, hashes the content of the file together with the settings that change the imported
+// data. The key of a .gltf file also covers the content of its external buffers. Returns 0 if the source or one of
+// its buffers could not be read
+u64 computeMeshCacheKey(const std::string& sourcePath, const MeshLodSettings& lodSettings);
+
+// Path of the cache file of a source file, inside MESH_CACHE_DIRECTORY
+std::string getMeshCachePath(const std::string& sourcePath);
+
+// Maps the cache file and copies the blobs into mesh data, no parsing is done. Returns std::nullopt if the file is
+// missing, stale (key mismatch), from another version or malformed, including indices and ranges out of bounds
+std::optional<std::vector<MeshData>> readMeshCache(const std::string& cachePath, u64 key, std::vector<MeshNode>& nodes);
+
+bool writeMeshCache(const std::string& cachePath, u64 key, const std::vector<MeshData>& meshDatas,
+                    const std::vector<MeshNode>& nodes);
+
+} // namespace huedra
@@ -3,9 +3,50 @@
 #include "core/types.hpp"
 #include "math/vec2.hpp"
 #include "math/vec3.hpp"
+#include "math/vec4.hpp"
 
 namespace huedra {
 
+// Culling data of a meshlet. The cluster is facing away from a camera at position p if
+// dot(normalize(coneApex - p), coneAxis) >= coneCutoff, the cutoff is 1 if the normals are too spread out to ever cull
+struct MeshletBounds
+{
+    vec3 center{0.0f};
+    float radius{0.0f};
+    vec3 aabbMin{0.0f};
+    vec3 aabbMax{0.0f};
+    vec3 coneApex{0.0f};
+    vec3 coneAxis{0.0f};
+    float coneCutoff{1.0f}; // sin of the cone half angle, the angle is 90 degrees minus the spread of the normals
+};
+
+// Small cluster of triangles, indexes into the meshlet vertex and triangle arrays of the mesh data
+struct Meshlet
+{
+    u32 vertexOffset{0};   // Into MeshData::meshletVertices
+    u32 triangleOffset{0}; // Into MeshData::meshletTriangles, 3 local indices per triangle
+    u32 vertexCount{0};
+    u32 triangleCount{0};
+    MeshletBounds bounds;
+};
+
+// Simplified level of detail, a range of MeshData::lodIndices over the same vertices as the full mesh
+struct MeshLod
+{
+    u32 indexOffset{0};
+    u32 indexCount{0};
+    float error{0.0f}; // Object space deviation from the full mesh
+};
+
+// Object space bounds of all positions of a mesh
+struct MeshBounds
+{
+    vec3 aabbMin{0.0f};
+    vec3 aabbMax{0.0f};
+    vec3 center{0.0f}; // Center of the aabb
+    float radius{0.0f};
+};
+
 struct MeshData
 {
     std::string name;
@@ -13,6 +54,32 @@ struct MeshData
     std::vector<vec2> uvs;
     std::vector<vec3> normals;
     std::vector<u32> indices;
+    MeshBounds bounds; // Filled on import, updateMeshBounds() refreshes it after editing the positions
+
+    // Optional, filled by generateTangents(), w is the handedness of the bitangent
+    std::vector<vec4> tangents;
+
+    // Optional, filled by buildMeshLods(), coarser with every level
+    std::vector<MeshLod> lods;
+    std::vector<u32> lodIndices;
+
+    // Optional, filled by buildMeshlets()
+    std::vector<Meshlet> meshlets;
+    std::vector<u32> meshletVertices; // Vertex indices of every meshlet
+    std::vector<u8> meshletTriangles; // Indices into the vertices of the meshlet
+};
+
+// Marks nodes without a parent or without a mesh
+constexpr u32 MESH_NODE_NONE = ~0u;
+
+// Node of the hierarchy of an imported file, parents are always stored before their children
+struct MeshNode
+{
+    u32 parent{MESH_NODE_NONE};
+    u32 mesh{MESH_NODE_NONE}; // Index into the mesh data of the same file, nodes with the same mesh share it
+    vec3 position{0.0f};
+    vec3 rotation{0.0f}; // Euler angles in radians, applied in the same order as Transform
+    vec3 scale{1.0f};
 };
 
 } // namespace huedra
\ No newline at end of file
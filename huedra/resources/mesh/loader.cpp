@@ -1,166 +1,399 @@
 #include "loader.hpp"
+#include "core/file/mapped_file.hpp"
 #include "core/file/utils.hpp"
+#include "core/memory/strided_view.hpp"
 #include "core/memory/utils.hpp"
 #include "core/serialization/base64.hpp"
-#include "core/serialization/json.hpp"
+#include "core/serialization/json_binding.hpp"
 #include "core/string/utils.hpp"
+#include "core/thread/utils.hpp"
+#include "math/vec_transform.hpp"
+#include "resources/mesh/bounds.hpp"
+#include "resources/mesh/meshopt_decoder.hpp"
+#include "resources/mesh/vertex_welder.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
 
 namespace huedra {
 
-std::vector<MeshData> loadObj(const std::string& path)
+namespace {
+
+// Tokenizing helpers for obj lines, all of them advance str past what has been read
+
+void skipObjSpaces(std::string_view& str)
 {
-    std::vector<MeshData> meshDatas;
-    MeshData* curMesh = nullptr;
-    std::vector<u8> bytes = readBytes(path);
+    u64 i = 0;
+    while (i < str.length() && (str[i] == ' ' || str[i] == '\t'))
+    {
+        ++i;
+    }
+    str.remove_prefix(i);
+}
+
+std::string_view readObjToken(std::string_view& str)
+{
+    skipObjSpaces(str);
+    u64 i = 0;
+    while (i < str.length() && str[i] != ' ' && str[i] != '\t')
+    {
+        ++i;
+    }
+    std::string_view token = str.substr(0, i);
+    str.remove_prefix(i);
+    return token;
+}
+
+bool readObjFloat(std::string_view& str, float& value)
+{
+    skipObjSpaces(str);
+    if (!str.empty() && str[0] == '+')
+    {
+        str.remove_prefix(1);
+    }
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.length(), value);
+    if (ec != std::errc())
+    {
+        return false;
+    }
+    str.remove_prefix(static_cast<u64>(ptr - str.data()));
+    return true;
+}
+
+// Reads a 1-based, possibly negative (relative to the end) index and converts it to a 0-based one. An empty index is
+// returned as OBJ_NO_INDEX
+constexpr u32 OBJ_NO_INDEX = ~0u;
+bool readObjIndex(std::string_view& str, u64 count, u32& index)
+{
+    if (str.empty() || str[0] == '/')
+    {
+        index = OBJ_NO_INDEX;
+        return true;
+    }
+
+    i64 value = 0;
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.length(), value);
+    if (ec != std::errc())
+    {
+        return false;
+    }
+    str.remove_prefix(static_cast<u64>(ptr - str.data()));
+
+    if (value < 0)
+    {
+        value += static_cast<i64>(count);
+    }
+    else
+    {
+        --value;
+    }
+    if (value < 0 || value >= static_cast<i64>(count))
+    {
+        return false;
+    }
+    index = static_cast<u32>(value);
+    return true;
+}
+
+// Reads a face element: "p", "p/t", "p//n" or "p/t/n", the counts are the number of attributes defined before the face
+bool readObjFaceVertex(std::string_view element, u64 positionCount, u64 uvCount, u64 normalCount, uvec3& vertex)
+{
+    vertex = uvec3(OBJ_NO_INDEX);
+    if (!readObjIndex(element, positionCount, vertex[0]) || vertex[0] == OBJ_NO_INDEX)
+    {
+        return false;
+    }
+    if (!element.empty() && element[0] == '/')
+    {
+        element.remove_prefix(1);
+        if (!readObjIndex(element, uvCount, vertex[1]))
+        {
+            return false;
+        }
+        if (!element.empty() && element[0] == '/')
+        {
+            element.remove_prefix(1);
+            if (!readObjIndex(element, normalCount, vertex[2]) || vertex[2] == OBJ_NO_INDEX)
+            {
+                return false;
+            }
+        }
+    }
+    return element.empty();
+}
+
+constexpr u64 OBJ_NO_LINE = ~0ull;
+
+// Calls func for every non empty line with comments and line endings stripped. Returns the 0-based index of the first
+// line func returned false for, or OBJ_NO_LINE if all lines were accepted
+template <typename Func>
+u64 forEachObjLine(std::string_view data, Func&& func)
+{
+    for (u64 lineIndex = 0; !data.empty(); ++lineIndex)
+    {
+        u64 lineEnd = data.find('\n');
+        std::string_view line = data.substr(0, lineEnd);
+        data.remove_prefix(lineEnd == std::string_view::npos ? data.length() : lineEnd + 1);
+
+        line = line.substr(0, line.find('#'));
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t'))
+        {
+            line.remove_suffix(1);
+        }
+
+        if (!line.empty() && !func(line))
+        {
+            return lineIndex;
+        }
+    }
+    return OBJ_NO_LINE;
+}
+
+// Part of an obj file that is parsed on its own thread, chunks always start and end at line boundaries
+struct ObjChunk
+{
+    std::string_view data;
+    u64 errorLine{OBJ_NO_LINE}; // Relative to the start of the chunk
 
-    u64 lineStart = 0;
     std::vector<vec3> positions;
     std::vector<vec3> normals;
     std::vector<vec2> uvs;
-    std::map<uvec3, u32> vertices;
 
-    auto parseLine = [&](const std::string& line) {
-        std::vector<std::string> elements;
-        switch (line[0])
+    // Number of attributes defined in all earlier chunks
+    u64 positionBase{0};
+    u64 normalBase{0};
+    u64 uvBase{0};
+
+    std::vector<uvec3> corners;                            // Triangle corners as 0-based (position, uv, normal)
+    std::vector<std::pair<u64, std::string_view>> objects; // First corner and name of every object started here
+};
+
+// First pass, reads the attributes of the chunk
+void parseObjAttributes(ObjChunk& chunk)
+{
+    chunk.errorLine = forEachObjLine(chunk.data, [&](std::string_view line) -> bool {
+        std::string_view keyword = readObjToken(line);
+        if (keyword == "v") // Position
         {
-        case 'o': // Object
-            curMesh = &meshDatas.emplace_back();
-            curMesh->name = line.substr(2);
-            positions.clear();
-            normals.clear();
-            uvs.clear();
-            vertices.clear();
-            break;
-        case 'v': // Vertex
-            elements = splitByChar(line, ' ');
-            switch (line[1])
-            {
-            case 'n': // Normal
-                normals.emplace_back(std::stof(elements[1]), std::stof(elements[2]), std::stof(elements[3]));
-                break;
-            case 't': // Uv
+            vec3& position = chunk.positions.emplace_back();
+            return readObjFloat(line, position.x) && readObjFloat(line, position.y) && readObjFloat(line, position.z);
+        }
+        if (keyword == "vn") // Normal
+        {
+            vec3& normal = chunk.normals.emplace_back();
+            return readObjFloat(line, normal.x) && readObjFloat(line, normal.y) && readObjFloat(line, normal.z);
+        }
+        if (keyword == "vt") // Uv
+        {
+            vec2& uv = chunk.uvs.emplace_back();
+            if (!readObjFloat(line, uv.x))
+            {
+                return false;
+            }
+            // Second coordinate is optional and defaults to 0
+            skipObjSpaces(line);
+            if (!line.empty() && !readObjFloat(line, uv.y))
+            {
+                return false;
+            }
 #ifdef VULKAN
-                uvs.emplace_back(std::stof(elements[1]), 1.0f - std::stof(elements[2]));
-#else
-                uvs.emplace_back(std::stof(elements[1]), std::stof(elements[2]));
+            uv.y = 1.0f - uv.y;
 #endif
-                break;
-
-            default: // Position
-                positions.emplace_back(std::stof(elements[1]), std::stof(elements[2]), std::stof(elements[3]));
-                break;
-            }
-            break;
+        }
+        return true;
+    });
+}
 
-        case 'f': // Face
-            elements = splitByChar(line, ' ');
-            // Triangle (3 + 'f')
-            for (u64 i = 1; i < 3 + 1; ++i)
+// Second pass, reads objects and faces once the attribute bases of the chunk are known. Attribute lines are only
+// counted so that relative indices resolve against the attributes defined so far
+void parseObjFaces(ObjChunk& chunk)
+{
+    u64 positionCount = chunk.positionBase;
+    u64 normalCount = chunk.normalBase;
+    u64 uvCount = chunk.uvBase;
+    std::vector<uvec3> faceVertices; // Reused for every face
+
+    chunk.errorLine = forEachObjLine(chunk.data, [&](std::string_view line) -> bool {
+        std::string_view keyword = readObjToken(line);
+        if (keyword == "v")
+        {
+            ++positionCount;
+        }
+        else if (keyword == "vn")
+        {
+            ++normalCount;
+        }
+        else if (keyword == "vt")
+        {
+            ++uvCount;
+        }
+        else if (keyword == "o") // Object
+        {
+            skipObjSpaces(line);
+            chunk.objects.emplace_back(chunk.corners.size(), line);
+        }
+        else if (keyword == "f") // Face
+        {
+            faceVertices.clear();
+            for (std::string_view element = readObjToken(line); !element.empty(); element = readObjToken(line))
             {
-                std::vector<std::string> indices = splitByChar(elements[i], '/');
-
-                u32 uvIndex = 0;
-                u32 normalIndex = 0;
-
-                // positions and uvs, no normals
-                if (indices.size() == 2) // x/y
-                {
-                    uvIndex = std::stoul(indices[1]);
-                }
-                // All or positions and normals, no uvs
-                else if (indices.size() == 3) // x/y/z or x//z
-                {
-                    uvIndex = indices[1].empty() ? 0 : std::stoul(indices[1]);
-                    normalIndex = std::stoul(indices[2]);
-                }
-
-                uvec3 vertex(std::stoul(indices[0]), uvIndex, normalIndex);
-                if (!vertices.contains(vertex))
+                if (!readObjFaceVertex(element, positionCount, uvCount, normalCount, faceVertices.emplace_back()))
                 {
-                    vertices.insert(std::pair<uvec3, u32>(vertex, static_cast<u32>(vertices.size())));
-                    curMesh->positions.push_back(positions[vertex[0] - 1]);
-                    if (vertex[1] != 0)
-                    {
-                        curMesh->uvs.push_back(uvs[vertex[1] - 1]);
-                    }
-                    if (vertex[2] != 0)
-                    {
-                        curMesh->normals.push_back(normals[vertex[2] - 1]);
-                    }
+                    return false;
                 }
-                curMesh->indices.push_back(vertices[vertex]);
             }
-
-            if (elements.size() == 5) // Quad (4 + 'f')
+            if (faceVertices.size() < 3)
             {
-                // Create another triangle
-                std::vector<std::string> indices = splitByChar(elements[4], '/');
+                return false;
+            }
 
-                u32 uvIndex = 0;
-                u32 normalIndex = 0;
+            // Polygons are triangulated as a fan around the first vertex,
+            // (v0, v1, v2, v3) = (v0, v1, v2), (v0, v2, v3)
+            for (u64 i = 2; i < faceVertices.size(); ++i)
+            {
+                chunk.corners.push_back(faceVertices[0]);
+                chunk.corners.push_back(faceVertices[i - 1]);
+                chunk.corners.push_back(faceVertices[i]);
+            }
+        }
+        return true;
+    });
+}
 
-                // positions and uvs, no normals
-                if (indices.size() == 2) // x/y
-                {
-                    uvIndex = std::stoul(indices[1]);
-                }
-                // All or positions and normals, no uvs
-                else if (indices.size() == 3) // x/y/z or x//z
-                {
-                    uvIndex = indices[1].empty() ? 0 : std::stoul(indices[1]);
-                    normalIndex = std::stoul(indices[2]);
-                }
+// Smallest amount of data worth handing to a separate thread
+constexpr u64 OBJ_MIN_CHUNK_SIZE = 1ull << 20;
 
-                uvec3 vertex(std::stoul(indices[0]), uvIndex, normalIndex);
-                if (!vertices.contains(vertex))
-                {
-                    vertices.insert(std::pair<uvec3, u32>(vertex, static_cast<u32>(vertices.size())));
-                    curMesh->positions.push_back(positions[vertex[0] - 1]);
-                    if (vertex[1] != 0)
-                    {
-                        curMesh->uvs.push_back(uvs[vertex[1] - 1]);
-                    }
-                    if (vertex[2] != 0)
-                    {
-                        curMesh->normals.push_back(normals[vertex[2] - 1]);
-                    }
-                }
+std::vector<ObjChunk> splitObjChunks(std::string_view data)
+{
+    u64 chunkCount = std::clamp<u64>(data.length() / OBJ_MIN_CHUNK_SIZE, 1, getHardwareThreadCount() * 4ull);
+    std::vector<ObjChunk> chunks;
+    chunks.reserve(chunkCount);
 
-                // Quad (v0, v1, v2, v3) =
-                // Triangles (v0, v1, v2), (v0, v2, v3)
-                curMesh->indices.push_back(curMesh->indices[curMesh->indices.size() - 3]); // v0
-                curMesh->indices.push_back(curMesh->indices[curMesh->indices.size() - 2]); // v2
-                curMesh->indices.push_back(vertices[vertex]);
-            }
-            break;
+    u64 start = 0;
+    for (u64 i = 1; i <= chunkCount && start < data.length(); ++i)
+    {
+        u64 end = data.length();
+        if (i < chunkCount)
+        {
+            end = data.find('\n', std::max(start, data.length() * i / chunkCount));
+            end = end == std::string_view::npos ? data.length() : end + 1;
+        }
+        chunks.emplace_back().data = data.substr(start, end - start);
+        start = end;
+    }
+    return chunks;
+}
 
-        default:
-            break;
+// Logs the first error of the chunks with its line number in the whole file, returns false if there was one
+bool reportObjError(const std::string& path, const std::vector<ObjChunk>& chunks)
+{
+    u64 lineBase = 1;
+    for (const auto& chunk : chunks)
+    {
+        if (chunk.errorLine != OBJ_NO_LINE)
+        {
+            log(LogLevel::WARNING, "loadObj(): {} line {}: incorrect data", path.c_str(), lineBase + chunk.errorLine);
+            return true;
         }
-    };
+        lineBase += static_cast<u64>(std::count(chunk.data.begin(), chunk.data.end(), '\n'));
+    }
+    return false;
+}
+
+} // namespace
 
-    // Create lines
-    for (u64 i = 0; i < bytes.size(); ++i)
+std::vector<MeshData> loadObj(const std::string& path)
+{
+    MappedFile file;
+    if (!file.open(path))
     {
-        if (static_cast<char>(bytes[i]) == '\n')
+        return {};
+    }
+    std::string_view data(reinterpret_cast<const char*>(file.data()), file.size());
+
+    // The file is split at line boundaries and every chunk is parsed in two passes. The first one reads attributes,
+    // which gives every chunk the number of attributes defined before it. The second one can then resolve the face
+    // indices (global to the file, possibly relative) on its own
+    std::vector<ObjChunk> chunks = splitObjChunks(data);
+    parallelFor(chunks.size(), [&](u64 i) { parseObjAttributes(chunks[i]); });
+    if (reportObjError(path, chunks))
+    {
+        return {};
+    }
+
+    std::vector<vec3> positions;
+    std::vector<vec3> normals;
+    std::vector<vec2> uvs;
+    for (auto& chunk : chunks)
+    {
+        chunk.positionBase = positions.size();
+        chunk.normalBase = normals.size();
+        chunk.uvBase = uvs.size();
+        positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+        normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+        uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+        chunk.positions = {};
+        chunk.normals = {};
+        chunk.uvs = {};
+    }
+
+    parallelFor(chunks.size(), [&](u64 i) { parseObjFaces(chunks[i]); });
+    if (reportObjError(path, chunks))
+    {
+        return {};
+    }
+
+    // Welding runs in file order, so the result does not depend on the number of chunks
+    std::vector<MeshData> meshDatas;
+    MeshData* curMesh = nullptr;
+    VertexWelder vertices(sizeof(uvec3));
+
+    auto addCorners = [&](const std::vector<uvec3>& corners, u64 begin, u64 end) {
+        if (begin == end)
+        {
+            return;
+        }
+        if (curMesh == nullptr)
         {
-            std::string line(reinterpret_cast<char*>(&bytes[lineStart]), i - lineStart);
-            lineStart = i + 1;
+            curMesh = &meshDatas.emplace_back();
+        }
 
-            if (line.empty())
+        for (u64 i = begin; i < end; ++i)
+        {
+            const uvec3& vertex = corners[i];
+            auto [index, inserted] = vertices.insert(vertex);
+            curMesh->indices.push_back(index);
+            if (!inserted)
             {
                 continue;
             }
 
-            parseLine(line);
+            curMesh->positions.push_back(positions[vertex[0]]);
+            if (vertex[1] != OBJ_NO_INDEX)
+            {
+                curMesh->uvs.push_back(uvs[vertex[1]]);
+            }
+            if (vertex[2] != OBJ_NO_INDEX)
+            {
+                curMesh->normals.push_back(normals[vertex[2]]);
+            }
         }
-    }
+    };
 
-    // Parse left over line
-    std::string line(reinterpret_cast<char*>(&bytes[lineStart]), bytes.size() - lineStart);
-    if (!line.empty())
+    for (const auto& chunk : chunks)
     {
-        parseLine(line);
+        u64 corner = 0;
+        for (const auto& [firstCorner, name] : chunk.objects)
+        {
+            addCorners(chunk.corners, corner, firstCorner);
+            corner = firstCorner;
+
+            curMesh = &meshDatas.emplace_back();
+            curMesh->name = name;
+            vertices.clear();
+        }
+        addCorners(chunk.corners, corner, chunk.corners.size());
     }
 
     if (meshDatas.empty())
@@ -168,343 +401,1132 @@ std::vector<MeshData> loadObj(const std::string& path)
         log(LogLevel::WARNING, "loadObj(): {} has no mesh data", path.c_str());
     }
 
+    for (MeshData& meshData : meshDatas)
+    {
+        updateMeshBounds(meshData);
+    }
     return meshDatas;
 }
 
 namespace {
-std::vector<MeshData> loadGltf(const std::string& path, JsonObject& json,
-                               const std::vector<std::vector<u8>>& byteBuffers)
+
+enum class GltfComponentType
+{
+    INT8 = 5120,
+    UINT8 = 5121,
+    INT16 = 5122,
+    UINT16 = 5123,
+    UINT32 = 5125,
+    FLOAT = 5126,
+};
+
+// Marks optional indices that were not present in the json data
+constexpr u64 GLTF_MISSING = ~0ull;
+
+struct GltfMeshoptFallback
+{
+    bool fallback{false};
+};
+
+struct GltfBufferExtensions
+{
+    std::optional<GltfMeshoptFallback> meshoptCompression;
+};
+
+struct GltfBuffer
+{
+    u64 byteLength{0};
+    std::optional<std::string> uri;
+    GltfBufferExtensions extensions; // A meshopt fallback buffer has no data, all its views are compressed
+};
+
+// EXT_meshopt_compression data of a buffer view, the view itself describes the decompressed data
+struct GltfMeshoptCompression
+{
+    u64 buffer{0};
+    u64 byteOffset{0};
+    u64 byteLength{0};
+    u64 byteStride{0};
+    u64 count{0};
+    std::string mode;
+    std::string filter{"NONE"};
+};
+
+struct GltfBufferViewExtensions
+{
+    std::optional<GltfMeshoptCompression> meshoptCompression;
+};
+
+struct GltfBufferView
+{
+    u64 buffer{0};
+    u64 byteLength{0};
+    u64 byteOffset{0};
+    u64 byteStride{0};
+    GltfBufferViewExtensions extensions;
+};
+
+struct GltfSparseIndices
+{
+    u64 bufferView{GLTF_MISSING};
+    u64 byteOffset{0};
+    u64 componentType{0};
+};
+
+struct GltfSparseValues
+{
+    u64 bufferView{GLTF_MISSING};
+    u64 byteOffset{0};
+};
+
+// Elements that replace elements of the accessor, e.g. the few vertices that a morph target moves
+struct GltfSparse
+{
+    u64 count{0};
+    GltfSparseIndices indices;
+    GltfSparseValues values;
+};
+
+struct GltfAccessor
+{
+    u64 bufferView{GLTF_MISSING}; // Missing means all elements are zero, unless sparse elements replace them
+    u64 byteOffset{0};
+    u64 componentType{0};
+    bool normalized{false};
+    u64 count{0};
+    std::string type;
+    std::optional<GltfSparse> sparse;
+};
+
+struct GltfAttributes
+{
+    u64 position{GLTF_MISSING};
+    u64 normal{GLTF_MISSING};
+    u64 texCoord{GLTF_MISSING};
+};
+
+struct GltfPrimitive
+{
+    GltfAttributes attributes;
+    u64 indices{GLTF_MISSING};
+};
+
+struct GltfMesh
+{
+    std::string name;
+    std::vector<GltfPrimitive> primitives;
+};
+
+struct GltfNode
+{
+    std::vector<u64> children;
+    u64 mesh{GLTF_MISSING};
+    std::optional<std::array<float, 16>> matrix; // Column major, replaces translation, rotation and scale
+    std::array<float, 3> translation{0.0f, 0.0f, 0.0f};
+    std::array<float, 4> rotation{0.0f, 0.0f, 0.0f, 1.0f}; // Quaternion as x, y, z, w
+    std::array<float, 3> scale{1.0f, 1.0f, 1.0f};
+};
+
+struct GltfScene
+{
+    std::vector<u64> nodes;
+};
+
+// Only the parts of the gltf json data that are used for loading meshes, everything else is skipped while reading
+struct GltfDocument
 {
-    enum class ComponentType
+    u64 scene{GLTF_MISSING};
+    std::vector<GltfScene> scenes;
+    std::vector<GltfNode> nodes;
+    std::vector<GltfMesh> meshes;
+    std::vector<GltfAccessor> accessors;
+    std::vector<GltfBufferView> bufferViews;
+    std::vector<GltfBuffer> buffers;
+};
+
+} // namespace
+
+template <>
+struct JsonBinding<GltfMeshoptFallback>
+{
+    static constexpr auto fields = std::make_tuple(jsonOptional("fallback", &GltfMeshoptFallback::fallback));
+};
+
+template <>
+struct JsonBinding<GltfBufferExtensions>
+{
+    static constexpr auto fields =
+        std::make_tuple(jsonOptional("EXT_meshopt_compression", &GltfBufferExtensions::meshoptCompression));
+};
+
+template <>
+struct JsonBinding<GltfBuffer>
+{
+    static constexpr auto fields = std::make_tuple(jsonRequired("byteLength", &GltfBuffer::byteLength),
+                                                   jsonOptional("uri", &GltfBuffer::uri),
+                                                   jsonOptional("extensions", &GltfBuffer::extensions));
+};
+
+template <>
+struct JsonBinding<GltfMeshoptCompression>
+{
+    static constexpr auto fields = std::make_tuple(jsonRequired("buffer", &GltfMeshoptCompression::buffer),
+                                                   jsonOptional("byteOffset", &GltfMeshoptCompression::byteOffset),
+                                                   jsonRequired("byteLength", &GltfMeshoptCompression::byteLength),
+                                                   jsonRequired("byteStride", &GltfMeshoptCompression::byteStride),
+                                                   jsonRequired("count", &GltfMeshoptCompression::count),
+                                                   jsonRequired("mode", &GltfMeshoptCompression::mode),
+                                                   jsonOptional("filter", &GltfMeshoptCompression::filter));
+};
+
+template <>
+struct JsonBinding<GltfBufferViewExtensions>
+{
+    static constexpr auto fields =
+        std::make_tuple(jsonOptional("EXT_meshopt_compression", &GltfBufferViewExtensions::meshoptCompression));
+};
+
+template <>
+struct JsonBinding<GltfBufferView>
+{
+    static constexpr auto fields = std::make_tuple(jsonRequired("buffer", &GltfBufferView::buffer),
+                                                   jsonRequired("byteLength", &GltfBufferView::byteLength),
+                                                   jsonOptional("byteOffset", &GltfBufferView::byteOffset),
+                                                   jsonOptional("byteStride", &GltfBufferView::byteStride),
+                                                   jsonOptional("extensions", &GltfBufferView::extensions));
+};
+
+template <>
+struct JsonBinding<GltfSparseIndices>
+{
+    static constexpr auto fields = std::make_tuple(jsonRequired("bufferView", &GltfSparseIndices::bufferView),
+                                                   jsonOptional("byteOffset", &GltfSparseIndices::byteOffset),
+                                                   jsonRequired("componentType", &GltfSparseIndices::componentType));
+};
+
+template <>
+struct JsonBinding<GltfSparseValues>
+{
+    static constexpr auto fields = std::make_tuple(jsonRequired("bufferView", &GltfSparseValues::bufferView),
+                                                   jsonOptional("byteOffset", &GltfSparseValues::byteOffset));
+};
+
+template <>
+struct JsonBinding<GltfSparse>
+{
+    static constexpr auto fields = std::make_tuple(jsonRequired("count", &GltfSparse::count),
+                                                   jsonRequired("indices", &GltfSparse::indices),
+                                                   jsonRequired("values", &GltfSparse::values));
+};
+
+template <>
+struct JsonBinding<GltfAccessor>
+{
+    static constexpr auto fields = std::make_tuple(jsonOptional("bufferView", &GltfAccessor::bufferView),
+                                                   jsonOptional("byteOffset", &GltfAccessor::byteOffset),
+                                                   jsonRequired("componentType", &GltfAccessor::componentType),
+                                                   jsonOptional("normalized", &GltfAccessor::normalized),
+                                                   jsonRequired("count", &GltfAccessor::count),
+                                                   jsonRequired("type", &GltfAccessor::type),
+                                                   jsonOptional("sparse", &GltfAccessor::sparse));
+};
+
+template <>
+struct JsonBinding<GltfAttributes>
+{
+    static constexpr auto fields = std::make_tuple(jsonOptional("POSITION", &GltfAttributes::position),
+                                                   jsonOptional("NORMAL", &GltfAttributes::normal),
+                                                   jsonOptional("TEXCOORD_0", &GltfAttributes::texCoord));
+};
+
+template <>
+struct JsonBinding<GltfPrimitive>
+{
+    static constexpr auto fields = std::make_tuple(jsonRequired("attributes", &GltfPrimitive::attributes),
+                                                   jsonOptional("indices", &GltfPrimitive::indices));
+};
+
+template <>
+struct JsonBinding<GltfMesh>
+{
+    static constexpr auto fields = std::make_tuple(jsonOptional("name", &GltfMesh::name),
+                                                   jsonRequired("primitives", &GltfMesh::primitives));
+};
+
+template <>
+struct JsonBinding<GltfNode>
+{
+    static constexpr auto fields = std::make_tuple(
+        jsonOptional("children", &GltfNode::children), jsonOptional("mesh", &GltfNode::mesh),
+        jsonOptional("matrix", &GltfNode::matrix), jsonOptional("translation", &GltfNode::translation),
+        jsonOptional("rotation", &GltfNode::rotation), jsonOptional("scale", &GltfNode::scale));
+};
+
+template <>
+struct JsonBinding<GltfScene>
+{
+    static constexpr auto fields = std::make_tuple(jsonOptional("nodes", &GltfScene::nodes));
+};
+
+template <>
+struct JsonBinding<GltfDocument>
+{
+    static constexpr auto fields = std::make_tuple(jsonOptional("scene", &GltfDocument::scene),
+                                                   jsonOptional("scenes", &GltfDocument::scenes),
+                                                   jsonOptional("nodes", &GltfDocument::nodes),
+                                                   jsonRequired("meshes", &GltfDocument::meshes),
+                                                   jsonRequired("accessors", &GltfDocument::accessors),
+                                                   jsonRequired("bufferViews", &GltfDocument::bufferViews),
+                                                   jsonRequired("buffers", &GltfDocument::buffers));
+};
+
+namespace {
+
+// Builds indices for a non indexed primitive by welding vertices with identical attributes
+void appendWeldedVertices(MeshData& meshData, const StridedView<vec3>& positions, const StridedView<vec3>& normals,
+                          const StridedView<vec2>& uvs)
+{
+    struct WeldKey
     {
-        INT8 = 5120,
-        UINT8 = 5121,
-        INT16 = 5122,
-        UINT16 = 5123,
-        UINT32 = 5125,
-        FLOAT = 5126,
+        vec3 position;
+        vec3 normal;
+        vec2 uv;
     };
 
-    std::vector<MeshData> meshDatas;
-    JsonArray& meshes = json["meshes"].asArray();
-    JsonArray& accessors = json["accessors"].asArray();
-    JsonArray& bufferViews = json["bufferViews"].asArray();
-    JsonArray& buffers = json["buffers"].asArray();
+    u32 vertexOffset = static_cast<u32>(meshData.positions.size());
+    VertexWelder welder(sizeof(WeldKey), positions.size());
+    for (u64 i = 0; i < positions.size(); ++i)
+    {
+        WeldKey key{positions[i], normals.empty() ? vec3(0.0f) : normals[i], uvs.empty() ? vec2(0.0f) : uvs[i]};
+        auto [index, inserted] = welder.insert(key);
+        if (inserted)
+        {
+            meshData.positions.push_back(key.position);
+            if (!normals.empty())
+            {
+                meshData.normals.push_back(key.normal);
+            }
+            if (!uvs.empty())
+            {
+                meshData.uvs.push_back(key.uv);
+            }
+        }
+        meshData.indices.push_back(vertexOffset + index);
+    }
+}
 
-    auto readAccessor = [&](u64 accessorIndex, const std::string& type, u32 typeCount, ComponentType componentType,
-                            u32 componentTypeSize) -> std::vector<u8> {
-        std::vector<u8> bytes;
+template <typename T>
+void appendView(std::vector<T>& dst, const StridedView<T>& view)
+{
+    u64 offset = dst.size();
+    dst.resize(offset + view.size());
+    view.copyTo(dst.data() + offset);
+}
+
+// Attributes are either empty or have a value per position. When only some primitives of a mesh have an attribute the
+// vertices of the others get the fallback value
+template <typename T>
+void padAttribute(std::vector<T>& values, u64 vertexCount, bool primitiveHasAttribute, const T& fallback)
+{
+    if (primitiveHasAttribute || !values.empty())
+    {
+        values.resize(vertexCount, fallback);
+    }
+}
+
+bool parseGltfDocument(const std::string& path, const u8* bytes, u64 size, GltfDocument& document)
+{
+    if (!deserializeJson(bytes, size, document))
+    {
+        log(LogLevel::WARNING, "loadGltf(): {} has incorrect mesh data", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool isGltfMeshoptFallback(const GltfBuffer& buffer)
+{
+    return buffer.extensions.meshoptCompression.has_value() && buffer.extensions.meshoptCompression->fallback;
+}
+
+// Path of an external buffer, or the path transformed to bin extension without an uri,
+// ex: "dir1/dir2/file.gltf" -> "dir1/dir2/file.bin"
+std::string getGltfBufferPath(const std::string& path, const std::string& relPath, const GltfBuffer& buffer)
+{
+    return buffer.uri.has_value() ? relPath + *buffer.uri : splitByChar(path, '.')[0] + ".bin";
+}
 
-        if (accessorIndex >= accessors.size() || accessors[accessorIndex].getType() != JsonValue::Type::OBJECT)
+bool getMeshoptFilter(std::string_view name, MeshoptFilter& filter)
+{
+    if (name == "NONE")
+    {
+        filter = MeshoptFilter::NONE;
+    }
+    else if (name == "OCTAHEDRAL")
+    {
+        filter = MeshoptFilter::OCTAHEDRAL;
+    }
+    else if (name == "QUATERNION")
+    {
+        filter = MeshoptFilter::QUATERNION;
+    }
+    else if (name == "EXPONENTIAL")
+    {
+        filter = MeshoptFilter::EXPONENTIAL;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool decodeGltfMeshoptView(const GltfBufferView& bufferView, const std::vector<std::span<const u8>>& buffers,
+                           std::vector<u8>& decoded)
+{
+    const GltfMeshoptCompression& compression = *bufferView.extensions.meshoptCompression;
+    // The count is checked against the length before multiplying, values from the file could overflow
+    if (compression.buffer >= buffers.size() || compression.byteStride == 0 ||
+        compression.count > bufferView.byteLength / compression.byteStride ||
+        bufferView.byteLength != compression.count * compression.byteStride)
+    {
+        return false;
+    }
+    std::span<const u8> buffer = buffers[compression.buffer];
+    if (compression.byteOffset > buffer.size() || compression.byteLength > buffer.size() - compression.byteOffset)
+    {
+        return false;
+    }
+    std::span<const u8> src = buffer.subspan(compression.byteOffset, compression.byteLength);
+
+    decoded.resize(bufferView.byteLength);
+    MeshoptFilter filter = MeshoptFilter::NONE;
+    if (compression.mode == "ATTRIBUTES")
+    {
+        return getMeshoptFilter(compression.filter, filter) &&
+               decodeMeshoptVertices(src, compression.count, compression.byteStride, decoded) &&
+               applyMeshoptFilter(filter, compression.count, compression.byteStride, decoded);
+    }
+    if (compression.filter != "NONE")
+    {
+        return false;
+    }
+    if (compression.mode == "TRIANGLES")
+    {
+        return decodeMeshoptTriangles(src, compression.count, compression.byteStride, decoded);
+    }
+    if (compression.mode == "INDICES")
+    {
+        return decodeMeshoptIndices(src, compression.count, compression.byteStride, decoded);
+    }
+    return false;
+}
+
+// Decompresses the EXT_meshopt_compression buffer views on worker threads and appends the results to buffers, the views
+// are then pointed at them so accessors read compressed views like any other
+bool decodeGltfMeshoptViews(const std::string& path, GltfDocument& document, std::vector<std::span<const u8>>& buffers,
+                            std::vector<std::vector<u8>>& decodedViews)
+{
+    std::vector<u64> viewIndices;
+    for (u64 i = 0; i < document.bufferViews.size(); ++i)
+    {
+        if (document.bufferViews[i].extensions.meshoptCompression.has_value())
         {
-            log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: accessor is incorrect or out of bounds",
-                path.c_str(), accessorIndex);
-            return {};
+            viewIndices.push_back(i);
         }
-        JsonObject& accessor = accessors[accessorIndex].asObject();
+    }
 
-        if (!accessor.hasMember("componentType", JsonValue::Type::UINT) ||
-            accessor["componentType"].asUint() != static_cast<u32>(componentType))
+    decodedViews.resize(viewIndices.size());
+    std::vector<u8> decodedOk(viewIndices.size(), 0);
+    parallelFor(viewIndices.size(), [&](u64 i) {
+        decodedOk[i] = decodeGltfMeshoptView(document.bufferViews[viewIndices[i]], buffers, decodedViews[i]) ? 1 : 0;
+    });
+
+    for (u64 i = 0; i < viewIndices.size(); ++i)
+    {
+        if (decodedOk[i] == 0)
         {
-            log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: incorrect componentType", path.c_str(),
-                accessorIndex);
-            return {};
+            log(LogLevel::WARNING, "loadGltf(): {} with bufferView[{}]: incorrect meshopt compressed data",
+                path.c_str(), viewIndices[i]);
+            return false;
         }
 
-        if (!accessor.hasMember("type", JsonValue::Type::STRING) || accessor["type"].asString() != type)
+        GltfBufferView& bufferView = document.bufferViews[viewIndices[i]];
+        bufferView.buffer = buffers.size();
+        bufferView.byteOffset = 0;
+        buffers.push_back(decodedViews[i]);
+    }
+    return true;
+}
+
+u32 getGltfComponentSize(GltfComponentType componentType)
+{
+    return componentType == GltfComponentType::INT8 || componentType == GltfComponentType::UINT8 ? 1
+           : componentType == GltfComponentType::INT16 || componentType == GltfComponentType::UINT16
+               ? 2
+               : 4;
+}
+
+// Finds count elements of elementSize bytes at byteOffset in a buffer view after validating the byte ranges. Elements
+// are byteStride of the view apart if strided is set (accessors), otherwise tightly packed (sparse data)
+bool getGltfBufferViewData(const std::string& path, const GltfDocument& document,
+                           const std::vector<std::span<const u8>>& buffers, u64 bufferViewIndex, u64 byteOffset,
+                           u64 count, u64 elementSize, bool strided, const u8*& data, u64& stride)
+{
+    if (bufferViewIndex >= document.bufferViews.size())
+    {
+        log(LogLevel::WARNING, "loadGltf(): {} with bufferView[{}]: incorrect bufferView index/object", path.c_str(),
+            bufferViewIndex);
+        return false;
+    }
+    const GltfBufferView& bufferView = document.bufferViews[bufferViewIndex];
+
+    if (bufferView.buffer >= buffers.size())
+    {
+        log(LogLevel::WARNING, "loadGltf(): {} with bufferView[{}]: incorrect bufferView values", path.c_str(),
+            bufferViewIndex);
+        return false;
+    }
+    std::span<const u8> buffer = buffers[bufferView.buffer];
+
+    // Ranges are compared by subtracting from the sizes, sums and products of values from the file could overflow
+    if (bufferView.byteOffset > buffer.size() || bufferView.byteLength > buffer.size() - bufferView.byteOffset)
+    {
+        log(LogLevel::WARNING, "loadGltf(): {} with bufferView[{}]: byte range larger than buffer[{}]", path.c_str(),
+            bufferViewIndex, bufferView.buffer);
+        return false;
+    }
+
+    stride = strided && bufferView.byteStride != 0 ? bufferView.byteStride : elementSize;
+    bool fits = count == 0 || (elementSize <= bufferView.byteLength &&
+                               (count == 1 || stride <= (bufferView.byteLength - elementSize) / (count - 1)));
+    u64 viewByteLen = fits && count != 0 ? (stride * (count - 1)) + elementSize : 0;
+    if (!fits || byteOffset > bufferView.byteLength - viewByteLen)
+    {
+        log(LogLevel::WARNING, "loadGltf(): {} with bufferView[{}]: byte range larger than view buffer byte range",
+            path.c_str(), bufferViewIndex);
+        return false;
+    }
+
+    data = buffer.data() + bufferView.byteOffset + byteOffset;
+    return true;
+}
+
+// Creates a view of the accessor directly over the buffer data after validating its type and byte ranges
+template <typename T>
+bool getGltfAccessorView(const std::string& path, const GltfDocument& document,
+                         const std::vector<std::span<const u8>>& buffers, u64 accessorIndex, std::string_view type,
+                         GltfComponentType componentType, StridedView<T>& view)
+{
+    if (accessorIndex >= document.accessors.size())
+    {
+        log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: accessor is incorrect or out of bounds", path.c_str(),
+            accessorIndex);
+        return false;
+    }
+    const GltfAccessor& accessor = document.accessors[accessorIndex];
+
+    if (accessor.componentType != static_cast<u32>(componentType))
+    {
+        log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: incorrect componentType", path.c_str(),
+            accessorIndex);
+        return false;
+    }
+
+    if (accessor.type != type)
+    {
+        log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: incorrect type", path.c_str(), accessorIndex);
+        return false;
+    }
+
+    if (accessor.sparse.has_value())
+    {
+        log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: sparse accessor not supported here", path.c_str(),
+            accessorIndex);
+        return false;
+    }
+
+    const u8* data = nullptr;
+    u64 stride = 0;
+    if (!getGltfBufferViewData(path, document, buffers, accessor.bufferView, accessor.byteOffset, accessor.count,
+                               sizeof(T), true, data, stride))
+    {
+        return false;
+    }
+    view = StridedView<T>(data, accessor.count, stride, getGltfComponentSize(componentType));
+    return true;
+}
+
+// Converts a component to float, normalized integers are mapped to [0, 1] or [-1, 1] as defined by the gltf
+// specification and other integers keep their value
+float readGltfComponent(const u8* bytes, GltfComponentType componentType, bool normalized)
+{
+    switch (componentType)
+    {
+    case GltfComponentType::INT8: {
+        float value = static_cast<i8>(bytes[0]);
+        return normalized ? std::max(value / 127.0f, -1.0f) : value;
+    }
+    case GltfComponentType::UINT8: {
+        float value = bytes[0];
+        return normalized ? value / 255.0f : value;
+    }
+    case GltfComponentType::INT16: {
+        float value = static_cast<i16>(parseFromBytes<u16>(bytes, std::endian::little));
+        return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+    }
+    case GltfComponentType::UINT16: {
+        float value = parseFromBytes<u16>(bytes, std::endian::little);
+        return normalized ? value / 65535.0f : value;
+    }
+    default:
+        return std::bit_cast<float>(parseFromBytes<u32>(bytes, std::endian::little));
+    }
+}
+
+// Vertex attribute accessor of any component type allowed by KHR_mesh_quantization. Float accessors without sparse
+// data are viewed in place, anything else is decoded into storage: integers are converted to float, sparse elements
+// are applied on top of the base elements (or zeros without a buffer view). The view points into storage, which has
+// to outlive it
+template <typename T>
+bool getGltfAttributeView(const std::string& path, const GltfDocument& document,
+                          const std::vector<std::span<const u8>>& buffers, u64 accessorIndex, std::string_view type,
+                          std::vector<T>& storage, StridedView<T>& view)
+{
+    if (accessorIndex >= document.accessors.size())
+    {
+        log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: accessor is incorrect or out of bounds", path.c_str(),
+            accessorIndex);
+        return false;
+    }
+    const GltfAccessor& accessor = document.accessors[accessorIndex];
+
+    auto componentType = static_cast<GltfComponentType>(accessor.componentType);
+    if (componentType == GltfComponentType::FLOAT && accessor.bufferView != GLTF_MISSING &&
+        !accessor.sparse.has_value())
+    {
+        return getGltfAccessorView(path, document, buffers, accessorIndex, type, componentType, view);
+    }
+
+    if (componentType != GltfComponentType::INT8 && componentType != GltfComponentType::UINT8 &&
+        componentType != GltfComponentType::INT16 && componentType != GltfComponentType::UINT16 &&
+        componentType != GltfComponentType::FLOAT)
+    {
+        log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: incorrect componentType", path.c_str(),
+            accessorIndex);
+        return false;
+    }
+    if (accessor.type != type)
+    {
+        log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: incorrect type", path.c_str(), accessorIndex);
+        return false;
+    }
+
+    constexpr u64 componentCount = sizeof(T) / sizeof(float);
+    u64 componentSize = getGltfComponentSize(componentType);
+    u64 elementSize = componentSize * componentCount;
+    auto decode = [&](const u8* bytes, T& value) {
+        for (u64 i = 0; i < componentCount; ++i)
         {
-            log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: incorrect type", path.c_str(), accessorIndex);
-            return {};
+            value[i] = readGltfComponent(bytes + (i * componentSize), componentType, accessor.normalized);
         }
+    };
 
-        if (!accessor.hasMember("count", JsonValue::Type::UINT))
+    // The range of the view is validated before the storage is sized by the count
+    const u8* data = nullptr;
+    u64 stride = 0;
+    if (accessor.bufferView != GLTF_MISSING &&
+        !getGltfBufferViewData(path, document, buffers, accessor.bufferView, accessor.byteOffset, accessor.count,
+                               elementSize, true, data, stride))
+    {
+        return false;
+    }
+    storage.assign(accessor.count, T(0.0f));
+    if (data != nullptr)
+    {
+        for (u64 i = 0; i < accessor.count; ++i)
         {
-            log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: incorrect count", path.c_str(), accessorIndex);
-            return {};
+            decode(data + (i * stride), storage[i]);
         }
-        u32 typeSize = accessor["count"].asUint() * typeCount;
+    }
 
-        u32 accessorByteOffset =
-            accessor.hasMember("byteOffset", JsonValue::Type::UINT) ? accessor["byteOffset"].asUint() : 0;
-        u32 byteLen = componentTypeSize * typeSize;
+    if (accessor.sparse.has_value())
+    {
+        const GltfSparse& sparse = *accessor.sparse;
+        auto indexType = static_cast<GltfComponentType>(sparse.indices.componentType);
+        if (indexType != GltfComponentType::UINT8 && indexType != GltfComponentType::UINT16 &&
+            indexType != GltfComponentType::UINT32)
+        {
+            log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: incorrect sparse indices componentType",
+                path.c_str(), accessorIndex);
+            return false;
+        }
 
-        if (!accessor.hasMember("bufferView", JsonValue::Type::UINT) ||
-            accessor["bufferView"].asUint() >= bufferViews.size() ||
-            bufferViews[accessor["bufferView"].asUint()].getType() != JsonValue::Type::OBJECT)
+        u64 indexSize = getGltfComponentSize(indexType);
+        const u8* indices = nullptr;
+        const u8* values = nullptr;
+        u64 stride = 0;
+        if (!getGltfBufferViewData(path, document, buffers, sparse.indices.bufferView, sparse.indices.byteOffset,
+                                   sparse.count, indexSize, false, indices, stride) ||
+            !getGltfBufferViewData(path, document, buffers, sparse.values.bufferView, sparse.values.byteOffset,
+                                   sparse.count, elementSize, false, values, stride))
         {
-            log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: incorrect bufferView index/object", path.c_str(),
-                accessorIndex);
-            return {};
+            return false;
         }
-        JsonObject& bufferView = bufferViews[accessor["bufferView"].asUint()].asObject();
 
-        if (!bufferView.hasMember("buffer", JsonValue::Type::UINT) || bufferView["buffer"].asUint() >= buffers.size() ||
-            !bufferView.hasMember("byteLength", JsonValue::Type::UINT))
+        for (u64 i = 0; i < sparse.count; ++i)
         {
-            log(LogLevel::WARNING, "loadGltf(): {} with bufferView[{}]: incorrect bufferView values", path.c_str(),
-                accessor["bufferView"].asUint());
-            return {};
+            const u8* indexBytes = indices + (i * indexSize);
+            u64 index = indexSize == 1   ? indexBytes[0]
+                        : indexSize == 2 ? parseFromBytes<u16>(indexBytes, std::endian::little)
+                                         : parseFromBytes<u32>(indexBytes, std::endian::little);
+            if (index >= accessor.count)
+            {
+                log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: sparse index {} out of bounds", path.c_str(),
+                    accessorIndex, index);
+                return false;
+            }
+            decode(values + (i * elementSize), storage[index]);
         }
+    }
 
-        const std::vector<u8>& byteBuffer = byteBuffers[bufferView["buffer"].asUint()];
-        u32 viewByteLen = bufferView["byteLength"].asUint();
-        u32 viewByteOffset =
-            bufferView.hasMember("byteOffset", JsonValue::Type::UINT) ? bufferView["byteOffset"].asUint() : 0;
-        u32 byteStride =
-            bufferView.hasMember("byteStride", JsonValue::Type::UINT) ? bufferView["byteStride"].asUint() : 0;
+    // Storage is already in host byte order, a component size of 1 keeps the view from swapping it
+    view = StridedView<T>(reinterpret_cast<const u8*>(storage.data()), storage.size(), sizeof(T), 1);
+    return true;
+}
+
+template <typename T>
+bool appendGltfIndices(const std::string& path, const GltfDocument& document,
+                       const std::vector<std::span<const u8>>& buffers, u64 accessorIndex,
+                       GltfComponentType componentType, u32 vertexOffset, std::vector<u32>& indices)
+{
+    StridedView<T> view;
+    if (!getGltfAccessorView(path, document, buffers, accessorIndex, "SCALAR", componentType, view))
+    {
+        return false;
+    }
 
-        u32 byteOffset = accessorByteOffset + viewByteOffset;
-        if (accessorByteOffset + byteLen > viewByteLen)
+    u64 offset = indices.size();
+    indices.resize(offset + view.size());
+    for (u64 i = 0; i < view.size(); ++i)
+    {
+        indices[offset + i] = vertexOffset + view[i];
+    }
+    return true;
+}
+
+// Euler angles of a rotation matrix given as columns, in the order of Transform: x first, then y, then z
+vec3 getGltfEulerAngles(const std::array<vec3, 3>& columns)
+{
+    float sinY = std::clamp(-columns[0][2], -1.0f, 1.0f);
+    if (std::abs(sinY) > 0.99999f)
+    {
+        // Gimbal lock, the x and z rotations share an axis so all of it is put into z
+        return {0.0f, std::asin(sinY), std::atan2(-columns[1][0], columns[1][1])};
+    }
+    return {std::atan2(columns[1][2], columns[2][2]), std::asin(sinY), std::atan2(columns[0][1], columns[0][0])};
+}
+
+MeshNode convertGltfNode(const GltfNode& node)
+{
+    MeshNode meshNode;
+    std::array<vec3, 3> columns{vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f)};
+    if (node.matrix.has_value())
+    {
+        // Decomposed into translation, rotation and scale, shear can not be represented and is lost
+        const std::array<float, 16>& m = *node.matrix;
+        meshNode.position = vec3(m[12], m[13], m[14]);
+        for (u64 i = 0; i < 3; ++i)
         {
-            log(LogLevel::WARNING,
-                "loadGltf(): {} with accessor[{}] and bufferView[{}]: byte range larger than view buffer "
-                "byte range",
-                path.c_str(), accessorIndex, accessor["bufferView"].asUint());
-            return {};
+            vec3 column(m[i * 4], m[(i * 4) + 1], m[(i * 4) + 2]);
+            meshNode.scale[i] = math::length(column);
+            if (meshNode.scale[i] > 0.0f)
+            {
+                columns[i] = column / meshNode.scale[i];
+            }
         }
-
-        bytes.resize(byteLen);
-        if ((std::endian::native == std::endian::little || componentType == ComponentType::INT8 ||
-             componentType == ComponentType::UINT8) &&
-            byteStride == 0)
+        if (math::dot(math::cross(columns[0], columns[1]), columns[2]) < 0.0f)
+        {
+            meshNode.scale.x = -meshNode.scale.x;
+            columns[0] = -columns[0];
+        }
+    }
+    else
+    {
+        meshNode.position = vec3(node.translation[0], node.translation[1], node.translation[2]);
+        meshNode.scale = vec3(node.scale[0], node.scale[1], node.scale[2]);
+
+        float x = node.rotation[0];
+        float y = node.rotation[1];
+        float z = node.rotation[2];
+        float w = node.rotation[3];
+        float lengthSq = (x * x) + (y * y) + (z * z) + (w * w);
+        if (lengthSq > 0.0f)
         {
-            std::memcpy(bytes.data(), &byteBuffer[byteOffset], byteLen);
-            return bytes;
+            float s = 2.0f / lengthSq;
+            columns[0] = vec3(1.0f - (s * ((y * y) + (z * z))), s * ((x * y) + (w * z)), s * ((x * z) - (w * y)));
+            columns[1] = vec3(s * ((x * y) - (w * z)), 1.0f - (s * ((x * x) + (z * z))), s * ((y * z) + (w * x)));
+            columns[2] = vec3(s * ((x * z) + (w * y)), s * ((y * z) - (w * x)), 1.0f - (s * ((x * x) + (y * y))));
         }
+    }
+    meshNode.rotation = getGltfEulerAngles(columns);
+    if (node.mesh != GLTF_MISSING)
+    {
+        meshNode.mesh = static_cast<u32>(node.mesh);
+    }
+    return meshNode;
+}
 
-        // Set byteStrid to size per component
-        if (byteStride == 0)
+// Flattens the node tree of the default scene depth first, so that every parent is stored before its children
+bool buildGltfNodes(const std::string& path, const GltfDocument& document, std::vector<MeshNode>& nodes)
+{
+    std::vector<u64> roots;
+    u64 sceneIndex = document.scene != GLTF_MISSING ? document.scene : (document.scenes.empty() ? GLTF_MISSING : 0);
+    if (sceneIndex != GLTF_MISSING)
+    {
+        if (sceneIndex >= document.scenes.size())
         {
-            byteStride = componentTypeSize;
+            log(LogLevel::WARNING, "loadGltf(): {} with scene {}: scene out of bounds", path.c_str(), sceneIndex);
+            return false;
         }
-        for (u64 i = 0; i < typeSize; ++i)
+        roots = document.scenes[sceneIndex].nodes;
+    }
+    else
+    {
+        // Without scenes every node that is not the child of another node is a root
+        std::vector<bool> isChild(document.nodes.size(), false);
+        for (const GltfNode& node : document.nodes)
         {
-            switch (componentType)
+            for (u64 child : node.children)
             {
-            case ComponentType::INT8:
-            case ComponentType::UINT8:
-                bytes[i] = byteBuffer[byteOffset + i];
-                break;
-            case ComponentType::INT16:
-            case ComponentType::UINT16: {
-                u16 value = parseFromBytes<u16>(&byteBuffer[byteOffset + (i * byteStride)], std::endian::little);
-                bytes[i * sizeof(u16)] = static_cast<u8>(value & 0x00ff);
-                bytes[(i * sizeof(u16)) + 1] = static_cast<u8>(value >> 8);
-            }
-            break;
-            case ComponentType::UINT32:
-            case ComponentType::FLOAT: {
-                u32 value = parseFromBytes<u32>(&byteBuffer[byteOffset + (i * byteStride)], std::endian::little);
-                bytes[i * sizeof(u32)] = static_cast<u8>((value) & 0x000000ff);
-                bytes[(i * sizeof(u32)) + 1] = static_cast<u8>((value >> 8) & 0x000000ff);
-                bytes[(i * sizeof(u32)) + 2] = static_cast<u8>((value >> 16) & 0x000000ff);
-                bytes[(i * sizeof(u32)) + 3] = static_cast<u8>(value >> 24);
+                if (child < isChild.size())
+                {
+                    isChild[child] = true;
+                }
             }
-            break;
+        }
+        for (u64 i = 0; i < document.nodes.size(); ++i)
+        {
+            if (!isChild[i])
+            {
+                roots.push_back(i);
             }
         }
+    }
 
-        return bytes;
-    };
+    std::vector<bool> visited(document.nodes.size(), false);
+    std::vector<std::pair<u64, u32>> stack; // Node and the index of its parent in nodes
+    for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+    {
+        stack.emplace_back(*it, MESH_NODE_NONE);
+    }
 
-    for (u64 i = 0; i < meshes.size(); ++i)
+    nodes.clear();
+    while (!stack.empty())
     {
-        if (meshes[i].getType() != JsonValue::Type::OBJECT)
+        auto [index, parent] = stack.back();
+        stack.pop_back();
+        if (index >= document.nodes.size() || visited[index])
         {
-            log(LogLevel::WARNING, "loadGltf(): {} with mesh[{}]: not an object", path.c_str(), i);
-            return {};
+            log(LogLevel::WARNING, "loadGltf(): {} with node[{}]: node is out of bounds or not part of a tree",
+                path.c_str(), index);
+            return false;
         }
-        JsonObject& mesh = meshes[i].asObject();
+        visited[index] = true;
 
-        if (!mesh.hasMember("primitives", JsonValue::Type::ARRAY))
+        const GltfNode& node = document.nodes[index];
+        if (node.mesh != GLTF_MISSING && node.mesh >= document.meshes.size())
         {
-            log(LogLevel::WARNING, "loadGltf(): {} with mesh[{}]: incorrect primitives member", path.c_str(), i);
-            return {};
+            log(LogLevel::WARNING, "loadGltf(): {} with node[{}]: mesh out of bounds", path.c_str(), index);
+            return false;
+        }
+
+        MeshNode& meshNode = nodes.emplace_back(convertGltfNode(node));
+        meshNode.parent = parent;
+        u32 nodeIndex = static_cast<u32>(nodes.size() - 1);
+        for (auto it = node.children.rbegin(); it != node.children.rend(); ++it)
+        {
+            stack.emplace_back(*it, nodeIndex);
         }
-        JsonArray& primitives = mesh["primitives"].asArray();
+    }
+    return true;
+}
+
+// Buffers are views into the mapped glb/bin files or into decoded data uris, no copies are made before the mesh data
+// is built
+std::vector<MeshData> loadGltf(const std::string& path, const GltfDocument& document,
+                               const std::vector<std::span<const u8>>& buffers, std::vector<MeshNode>& nodes)
+{
+    if (!buildGltfNodes(path, document, nodes))
+    {
+        return {};
+    }
+
+    std::vector<MeshData> meshDatas;
+    for (u64 i = 0; i < document.meshes.size(); ++i)
+    {
+        const GltfMesh& mesh = document.meshes[i];
         MeshData& meshData = meshDatas.emplace_back();
+        meshData.name = mesh.name;
 
-        for (u64 j = 0; j < primitives.size(); ++j)
+        for (u64 j = 0; j < mesh.primitives.size(); ++j)
         {
-            if (primitives[j].getType() != JsonValue::Type::OBJECT)
+            const GltfPrimitive& primitive = mesh.primitives[j];
+            if (primitive.attributes.position == GLTF_MISSING)
             {
-                log(LogLevel::WARNING, "loadGltf(): {} with mesh[{}].primitives[{}]: not an object", path.c_str(), i,
-                    j);
+                log(LogLevel::WARNING, "loadGltf(): {} with mesh[{}].primitives[{}]: incorrect vertex data",
+                    path.c_str(), i, j);
                 return {};
             }
-            JsonObject& primitive = primitives[j].asObject();
 
-            if (!primitive.hasMember("attributes", JsonValue::Type::OBJECT))
+            // Quantized or sparse attributes are decoded into the storage, float attributes are read in place
+            StridedView<vec3> positions;
+            StridedView<vec3> normals;
+            StridedView<vec2> uvs;
+            std::vector<vec3> positionStorage;
+            std::vector<vec3> normalStorage;
+            std::vector<vec2> uvStorage;
+            if (!getGltfAttributeView(path, document, buffers, primitive.attributes.position, "VEC3", positionStorage,
+                                      positions) ||
+                (primitive.attributes.normal != GLTF_MISSING &&
+                 !getGltfAttributeView(path, document, buffers, primitive.attributes.normal, "VEC3", normalStorage,
+                                       normals)) ||
+                (primitive.attributes.texCoord != GLTF_MISSING &&
+                 !getGltfAttributeView(path, document, buffers, primitive.attributes.texCoord, "VEC2", uvStorage,
+                                       uvs)))
             {
-                log(LogLevel::WARNING, "loadGltf(): {} with mesh[{}].primitives[{}]: incorrect attributes member",
-                    path.c_str(), i, j);
                 return {};
             }
-            JsonObject& attribute = primitive["attributes"].asObject();
 
-            if (!attribute.hasMember("POSITION", JsonValue::Type::UINT) ||
-                !primitive.hasMember("indices", JsonValue::Type::UINT))
+            if ((!normals.empty() && normals.size() != positions.size()) ||
+                (!uvs.empty() && uvs.size() != positions.size()))
             {
-                log(LogLevel::WARNING, "loadGltf(): {} with mesh[{}].primitives[{}]: incorrect vertex data",
+                log(LogLevel::WARNING, "loadGltf(): {} with mesh[{}].primitives[{}]: attribute counts differ",
                     path.c_str(), i, j);
                 return {};
             }
+            if (!meshData.positions.empty() &&
+                (normals.empty() != meshData.normals.empty() || uvs.empty() != meshData.uvs.empty()))
+            {
+                log(LogLevel::INFO,
+                    "loadGltf(): {} with mesh[{}].primitives[{}]: missing normals are zero and missing uvs are (0, 0)",
+                    path.c_str(), i, j);
+            }
 
-            std::vector<u8> bytes = readAccessor(attribute["POSITION"].asUint(), "VEC3", 3, ComponentType::FLOAT, 4);
-            meshData.positions =
-                std::vector<vec3>(reinterpret_cast<vec3*>(bytes.data()), reinterpret_cast<vec3*>(&bytes[bytes.size()]));
-
-            if (primitive["indices"].asUint() >= accessors.size() ||
-                accessors[primitive["indices"].asUint()].getType() != JsonValue::Type::OBJECT)
+            // Primitives are appended into the same mesh
+            u32 vertexOffset = static_cast<u32>(meshData.positions.size());
+            padAttribute(meshData.normals, vertexOffset, !normals.empty(), vec3(0.0f));
+            padAttribute(meshData.uvs, vertexOffset, !uvs.empty(), vec2(0.0f));
+            if (primitive.indices == GLTF_MISSING)
             {
-                log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: accessor is incorrect or out of bounds",
-                    path.c_str(), primitive["indices"].asUint());
-                return {};
+                appendWeldedVertices(meshData, positions, normals, uvs);
+            }
+            else
+            {
+                appendView(meshData.positions, positions);
+                appendView(meshData.normals, normals);
+                appendView(meshData.uvs, uvs);
+            }
+            padAttribute(meshData.normals, meshData.positions.size(), false, vec3(0.0f));
+            padAttribute(meshData.uvs, meshData.positions.size(), false, vec2(0.0f));
+            if (primitive.indices == GLTF_MISSING)
+            {
+                continue;
             }
-            JsonObject& accessor = accessors[primitive["indices"].asUint()].asObject();
 
-            if (!accessor.hasMember("componentType", JsonValue::Type::UINT) ||
-                (accessor["componentType"].asUint() != static_cast<u32>(ComponentType::UINT8) &&
-                 accessor["componentType"].asUint() != static_cast<u32>(ComponentType::UINT16) &&
-                 accessor["componentType"].asUint() != static_cast<u32>(ComponentType::UINT32)))
+            if (primitive.indices >= document.accessors.size())
             {
-                log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: incorrect componentType", path.c_str(),
-                    primitive["indices"].asUint());
+                log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: accessor is incorrect or out of bounds",
+                    path.c_str(), primitive.indices);
                 return {};
             }
-            ComponentType indexType = static_cast<ComponentType>(accessor["componentType"].asUint());
 
-            if (indexType == ComponentType::UINT8)
+            bool success = false;
+            auto indexType = static_cast<GltfComponentType>(document.accessors[primitive.indices].componentType);
+            if (indexType == GltfComponentType::UINT8)
             {
-                bytes = readAccessor(primitive["indices"].asUint(), "SCALAR", 1, ComponentType::UINT8, 1);
-                meshData.indices = std::vector<u32>(bytes.begin(), bytes.end());
+                success = appendGltfIndices<u8>(path, document, buffers, primitive.indices, indexType, vertexOffset,
+                                                meshData.indices);
             }
-            else if (indexType == ComponentType::UINT16)
+            else if (indexType == GltfComponentType::UINT16)
             {
-                bytes = readAccessor(primitive["indices"].asUint(), "SCALAR", 1, ComponentType::UINT16, 2);
-                std::vector<u16> bytes16 = std::vector<u16>(reinterpret_cast<u16*>(bytes.data()),
-                                                            reinterpret_cast<u16*>(&bytes[bytes.size()]));
-                meshData.indices = std::vector<u32>(bytes16.begin(), bytes16.end());
+                success = appendGltfIndices<u16>(path, document, buffers, primitive.indices, indexType, vertexOffset,
+                                                 meshData.indices);
             }
-            else if (indexType == ComponentType::UINT32)
+            else if (indexType == GltfComponentType::UINT32)
             {
-                bytes = readAccessor(primitive["indices"].asUint(), "SCALAR", 1, ComponentType::UINT32, 4);
-                meshData.indices = std::vector<u32>(reinterpret_cast<u32*>(bytes.data()),
-                                                    reinterpret_cast<u32*>(&bytes[bytes.size()]));
+                success = appendGltfIndices<u32>(path, document, buffers, primitive.indices, indexType, vertexOffset,
+                                                 meshData.indices);
             }
-
-            if (attribute.hasMember("NORMAL", JsonValue::Type::UINT))
+            else
             {
-                bytes = readAccessor(attribute["NORMAL"].asUint(), "VEC3", 3, ComponentType::FLOAT, 4);
-                meshData.normals = std::vector<vec3>(reinterpret_cast<vec3*>(bytes.data()),
-                                                     reinterpret_cast<vec3*>(&bytes[bytes.size()]));
+                log(LogLevel::WARNING, "loadGltf(): {} with accessor[{}]: incorrect componentType", path.c_str(),
+                    primitive.indices);
             }
-            if (attribute.hasMember("TEXCOORD_0", JsonValue::Type::UINT))
+            if (!success)
             {
-                bytes = readAccessor(attribute["TEXCOORD_0"].asUint(), "VEC2", 2, ComponentType::FLOAT, 4);
-                meshData.uvs = std::vector<vec2>(reinterpret_cast<vec2*>(bytes.data()),
-                                                 reinterpret_cast<vec2*>(&bytes[bytes.size()]));
+                return {};
             }
         }
     }
 
+    for (MeshData& meshData : meshDatas)
+    {
+        updateMeshBounds(meshData);
+    }
     return meshDatas;
 }
 } // namespace
 
 std::vector<MeshData> loadGltf(const std::string& path)
 {
-    enum class ComponentType
-    {
-        INT8 = 5120,
-        UINT8 = 5121,
-        INT16 = 5122,
-        UINT16 = 5123,
-        UINT32 = 5125,
-        FLOAT = 5126,
-    };
+    std::vector<MeshNode> nodes;
+    return loadGltf(path, nodes);
+}
 
-    JsonObject json = parseJson(readBytes(path));
+std::vector<MeshData> loadGltf(const std::string& path, std::vector<MeshNode>& nodes)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        return {};
+    }
     std::string relPath = splitLastByChar(path, '/')[0] + "/";
 
-    if (!json.hasMember("meshes", JsonValue::Type::ARRAY) || !json.hasMember("accessors", JsonValue::Type::ARRAY) ||
-        !json.hasMember("bufferViews", JsonValue::Type::ARRAY) || !json.hasMember("buffers", JsonValue::Type::ARRAY))
+    GltfDocument document;
+    if (!parseGltfDocument(path, file.data(), file.size(), document))
     {
-        log(LogLevel::WARNING, "loadGltf(): {} has incorrect mesh data", path.c_str());
         return {};
     }
-    JsonArray& buffers = json["buffers"].asArray();
 
-    std::vector<std::vector<u8>> byteBuffers(buffers.size());
-    for (u64 i = 0; i < buffers.size(); ++i)
-    {
-        if (buffers[i].getType() != JsonValue::Type::OBJECT)
-        {
-            log(LogLevel::WARNING, "loadGltf(): {} with buffer[{}]: not an object", path.c_str(), i);
-            return {};
-        }
-        JsonObject& buffer = buffers[i].asObject();
+    // Storage of the buffers, external files are mapped and data uris are decoded
+    std::vector<MappedFile> bufferFiles;
+    std::vector<std::vector<u8>> decodedBuffers;
+    bufferFiles.reserve(document.buffers.size());
+    decodedBuffers.reserve(document.buffers.size());
 
-        if (!buffer.hasMember("byteLength", JsonValue::Type::UINT))
+    std::vector<std::span<const u8>> buffers(document.buffers.size());
+    for (u64 i = 0; i < document.buffers.size(); ++i)
+    {
+        const GltfBuffer& buffer = document.buffers[i];
+        if (isGltfMeshoptFallback(buffer))
         {
-            log(LogLevel::WARNING, "loadGltf(): {} with buffer[{}]: incorrect byteLength", path.c_str(), i);
-            return {};
+            continue; // Only referenced by compressed views, which are decoded from other buffers
         }
-
-        if (buffer.hasMember("uri", JsonValue::Type::STRING))
+        if (buffer.uri.has_value() && buffer.uri->starts_with("data:"))
         {
-            std::string& uri = buffer["uri"].asString();
-            if (uri.starts_with("data:"))
+            // TODO: Check support?
+            // std::string type = splitByChar(uri.substr(5), ';')[0];
+            std::string_view uri = *buffer.uri;
+            u64 dataStart = uri.find(',');
+            if (dataStart == std::string_view::npos)
             {
-                // TODO: Check support?
-                // std::string type = splitByChar(uri.substr(5), ';')[0];
-                byteBuffers[i] = decodeBase64(splitByChar(uri, ',')[1]);
+                log(LogLevel::WARNING, "loadGltf(): {} with buffer[{}]: incorrect data uri", path.c_str(), i);
+                return {};
             }
-            // Path
-            else
+
+            // Decoded in place from the uri, no copy of the base64 data is made
+            std::string_view base64 = uri.substr(dataStart + 1);
+            std::vector<u8>& bytes = decodedBuffers.emplace_back(decodedBase64Size(base64));
+            if (!decodeBase64(base64, bytes))
             {
-                byteBuffers[i] = readBytes(relPath + uri);
+                log(LogLevel::WARNING, "loadGltf(): {} with buffer[{}]: incorrect base64 data", path.c_str(), i);
+                return {};
             }
+            buffers[i] = bytes;
+            continue;
         }
-        else
+
+        std::string bufferPath = getGltfBufferPath(path, relPath, buffer);
+        MappedFile& bufferFile = bufferFiles.emplace_back();
+        if (!bufferFile.open(bufferPath))
         {
-            // Transforms path to bin extension, ex: "dir1/dir2/file.gltf" -> "dir1/dir2/file.bin"
-            byteBuffers[i] = readBytes(splitByChar(path, '.')[0] + ".bin");
+            log(LogLevel::WARNING, "loadGltf(): {} with buffer[{}]: could not open {}", path.c_str(), i,
+                bufferPath.c_str());
+            return {};
         }
+        buffers[i] = bufferFile.getBytes();
     }
 
-    return loadGltf(path, json, byteBuffers);
+    std::vector<std::vector<u8>> decodedViews;
+    if (!decodeGltfMeshoptViews(path, document, buffers, decodedViews))
+    {
+        return {};
+    }
+    return loadGltf(path, document, buffers, nodes);
+}
+
+bool getGltfBufferPaths(const std::string& path, std::vector<std::string>& bufferPaths)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        return false;
+    }
+    std::string relPath = splitLastByChar(path, '/')[0] + "/";
+
+    GltfDocument document;
+    if (!parseGltfDocument(path, file.data(), file.size(), document))
+    {
+        return false;
+    }
+
+    bufferPaths.clear();
+    for (const GltfBuffer& buffer : document.buffers)
+    {
+        if (!isGltfMeshoptFallback(buffer) && !(buffer.uri.has_value() && buffer.uri->starts_with("data:")))
+        {
+            bufferPaths.push_back(getGltfBufferPath(path, relPath, buffer));
+        }
+    }
+    return true;
 }
 
 std::vector<MeshData> loadGlb(const std::string& path)
 {
-    std::vector<MeshData> meshData;
-    std::vector<u8> bytes = readBytes(path);
+    std::vector<MeshNode> nodes;
+    return loadGlb(path, nodes);
+}
+
+std::vector<MeshData> loadGlb(const std::string& path, std::vector<MeshNode>& nodes)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        return {};
+    }
+    std::span<const u8> bytes = file.getBytes();
 
     const u32 gltfSignature = 0x46546c67; // "glTF"
     const u32 jsonSignature = 0x4e4f534a; // "JSON"
     const u32 binSignature = 0x004e4942;  // "\0BIN"
 
-    if (parseFromBytes<u32>(bytes.data(), std::endian::little) != gltfSignature)
+    if (bytes.size() < 12 || parseFromBytes<u32>(bytes.data(), std::endian::little) != gltfSignature)
     {
         log(LogLevel::WARNING, "loadGlb(): {} incorrect magic number: {}, expected {}", path.c_str(),
-            parseFromBytes<u32>(bytes.data(), std::endian::little), gltfSignature);
+            bytes.size() < 4 ? 0 : parseFromBytes<u32>(bytes.data(), std::endian::little), gltfSignature);
         return {};
     }
 
-    u32 byteIndex = 12;
+    u64 byteIndex = 12;
     u32 chunkIndex = 0;
 
-    JsonObject json;
-    std::vector<std::vector<u8>> byteBuffers;
+    GltfDocument document;
+    std::vector<std::span<const u8>> binChunks;
     bool foundJson = false;
 
-    while (byteIndex < bytes.size())
+    while (byteIndex + 8 <= bytes.size())
     {
         u32 chunkLen = parseFromBytes<u32>(&bytes[byteIndex], std::endian::little);
         u32 chunkType = parseFromBytes<u32>(&bytes[byteIndex + 4], std::endian::little);
         byteIndex += 8;
 
+        if (byteIndex + chunkLen > bytes.size())
+        {
+            log(LogLevel::WARNING, "loadGlb(): {} chunk[{}]: length out of bounds", path.c_str(), chunkIndex);
+            return {};
+        }
+
         if (chunkType == jsonSignature)
         {
             if (foundJson)
@@ -512,12 +1534,18 @@ std::vector<MeshData> loadGlb(const std::string& path)
                 log(LogLevel::WARNING, "loadGlb(): {} chunk[{}]: duplicate json data", path.c_str(), chunkIndex);
                 return {};
             }
-            json = parseJson(std::vector<u8>(bytes.begin() + byteIndex, bytes.begin() + byteIndex + chunkLen));
+
+            // Json chunk is read in place
+            if (!parseGltfDocument(path, &bytes[byteIndex], chunkLen, document))
+            {
+                return {};
+            }
             foundJson = true;
         }
         else if (chunkType == binSignature)
         {
-            byteBuffers.emplace_back(bytes.begin() + byteIndex, bytes.begin() + byteIndex + chunkLen);
+            // Accessors read straight from the mapped chunk
+            binChunks.push_back(bytes.subspan(byteIndex, chunkLen));
         }
         else
         {
@@ -530,15 +1558,29 @@ std::vector<MeshData> loadGlb(const std::string& path)
         ++chunkIndex;
     }
 
-    if (!json.hasMember("meshes", JsonValue::Type::ARRAY) || !json.hasMember("accessors", JsonValue::Type::ARRAY) ||
-        !json.hasMember("bufferViews", JsonValue::Type::ARRAY) || !json.hasMember("buffers", JsonValue::Type::ARRAY) ||
-        byteBuffers.size() != json["buffers"].asArray().size())
+    // Binary chunks belong to the buffers in order, meshopt fallback buffers have no chunk
+    std::vector<std::span<const u8>> buffers(document.buffers.size());
+    u64 chunkCount = 0;
+    for (u64 i = 0; i < document.buffers.size(); ++i)
+    {
+        if (!isGltfMeshoptFallback(document.buffers[i]) && chunkCount < binChunks.size())
+        {
+            buffers[i] = binChunks[chunkCount++];
+        }
+    }
+
+    if (!foundJson || chunkCount != binChunks.size())
     {
         log(LogLevel::WARNING, "loadGlb(): {} has incorrect mesh data", path.c_str());
         return {};
     }
 
-    return loadGltf(path, json, byteBuffers);
+    std::vector<std::vector<u8>> decodedViews;
+    if (!decodeGltfMeshoptViews(path, document, buffers, decodedViews))
+    {
+        return {};
+    }
+    return loadGltf(path, document, buffers, nodes);
 }
 
-} // namespace huedra
\ No newline at end of file
+} // namespace huedra
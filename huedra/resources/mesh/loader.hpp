@@ -10,4 +10,13 @@ std::vector<MeshData> loadGltf(const std::string& path);
 
 std::vector<MeshData> loadGlb(const std::string& path);
 
+// Also reads the node hierarchy of the default scene, or of every root node if the file has no scenes
+std::vector<MeshData> loadGltf(const std::string& path, std::vector<MeshNode>& nodes);
+
+std::vector<MeshData> loadGlb(const std::string& path, std::vector<MeshNode>& nodes);
+
+// Paths of the external buffer files a .gltf file reads, buffers in data uris and meshopt fallback buffers are
+// skipped. Returns false if the file can't be read or parsed
+bool getGltfBufferPaths(const std::string& path, std::vector<std::string>& bufferPaths);
+
 }
\ No newline at end of file
@@ -0,0 +1,336 @@
+#include "meshlet.hpp"
+#include "core/log.hpp"
+#include "math/vec_transform.hpp"
+
+#include <cmath>
+#include <numeric>
+
+namespace huedra {
+
+namespace {
+
+constexpr u32 NO_TRIANGLE = ~0u;
+constexpr u8 NO_LOCAL_VERTEX = 0xff;
+
+vec3 triangleNormal(const vec3& p0, const vec3& p1, const vec3& p2)
+{
+    vec3 normal = math::cross(p1 - p0, p2 - p0);
+    float length = math::length(normal);
+    return length > 0.0f ? normal * (1.0f / length) : vec3(0.0f);
+}
+
+} // namespace
+
+void buildMeshlets(MeshData& meshData, u32 maxVertices, u32 maxTriangles, float coneWeight)
+{
+    meshData.meshlets.clear();
+    meshData.meshletVertices.clear();
+    meshData.meshletTriangles.clear();
+
+    const std::vector<vec3>& positions = meshData.positions;
+    const std::vector<u32>& indices = meshData.indices;
+    u64 vertexCount = positions.size();
+    u64 triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+    if (std::ranges::any_of(indices, [&](u32 index) { return index >= vertexCount; }))
+    {
+        log(LogLevel::WARNING, "buildMeshlets(): {} has indices out of bounds", meshData.name.c_str());
+        return;
+    }
+    maxVertices = std::clamp(maxVertices, 3u, static_cast<u32>(NO_LOCAL_VERTEX));
+    maxTriangles = std::max(maxTriangles, 1u);
+
+    // Triangles using each vertex, laid out as offsets into one array
+    std::vector<u32> adjacencyOffsets(vertexCount + 1, 0);
+    for (u32 index : indices)
+    {
+        ++adjacencyOffsets[index + 1];
+    }
+    std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+    std::vector<u32> adjacency(indices.size());
+    std::vector<u32> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (u64 i = 0; i < indices.size(); ++i)
+    {
+        adjacency[fill[indices[i]]++] = static_cast<u32>(i / 3);
+    }
+
+    std::vector<u32> liveTriangles(vertexCount);
+    for (u64 i = 0; i < vertexCount; ++i)
+    {
+        liveTriangles[i] = adjacencyOffsets[i + 1] - adjacencyOffsets[i];
+    }
+
+    std::vector<vec3> centroids(triangleCount);
+    std::vector<vec3> normals(triangleCount);
+    for (u64 i = 0; i < triangleCount; ++i)
+    {
+        const vec3& p0 = positions[indices[i * 3]];
+        const vec3& p1 = positions[indices[(i * 3) + 1]];
+        const vec3& p2 = positions[indices[(i * 3) + 2]];
+        centroids[i] = (p0 + p1 + p2) * (1.0f / 3.0f);
+        normals[i] = triangleNormal(p0, p1, p2);
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<u8> localVertices(vertexCount, NO_LOCAL_VERTEX);
+    meshData.meshlets.reserve((triangleCount / maxTriangles) + 1);
+    meshData.meshletVertices.reserve(vertexCount + (vertexCount / 4));
+    meshData.meshletTriangles.reserve(indices.size());
+
+    Meshlet meshlet;
+    vec3 centroidSum(0.0f);
+    vec3 normalSum(0.0f);
+    vec3 center(0.0f);
+    vec3 axis(0.0f);
+    u64 scanTriangle = 0;
+
+    // Best unemitted triangle around the given meshlet vertices, optionally only the ones that fit in the current
+    // meshlet. Priorities follow the meshlet builder in meshoptimizer
+    auto findCandidate = [&](const Meshlet& around, bool mustFit) {
+        u32 best = NO_TRIANGLE;
+        u32 bestPriority = 6;
+        float bestScore = std::numeric_limits<float>::max();
+        for (u32 i = 0; i < around.vertexCount; ++i)
+        {
+            u32 vertex = meshData.meshletVertices[around.vertexOffset + i];
+            if (liveTriangles[vertex] == 0)
+            {
+                continue;
+            }
+            for (u32 j = adjacencyOffsets[vertex]; j < adjacencyOffsets[vertex + 1]; ++j)
+            {
+                u32 triangle = adjacency[j];
+                if (emitted[triangle])
+                {
+                    continue;
+                }
+
+                u32 extra = 0;
+                u32 dangling = 0;
+                u32 almostDangling = 0;
+                for (u64 k = 0; k < 3; ++k)
+                {
+                    u32 triangleVertex = indices[(triangle * 3ull) + k];
+                    extra += localVertices[triangleVertex] == NO_LOCAL_VERTEX ? 1 : 0;
+                    dangling += liveTriangles[triangleVertex] == 1 ? 1 : 0;
+                    almostDangling += liveTriangles[triangleVertex] == 2 ? 1 : 0;
+                }
+                if (mustFit && meshlet.vertexCount + extra > maxVertices)
+                {
+                    continue;
+                }
+
+                // Triangles without new vertices come first, then triangles that would be left dangling as they are
+                // expensive to add to a later meshlet, and triangles that leave a neighbour dangling for the next step
+                u32 priority = 2 + extra;
+                if (extra == 0)
+                {
+                    priority = 0;
+                }
+                else if (dangling > 0)
+                {
+                    priority = 1;
+                }
+                else if (almostDangling >= 2)
+                {
+                    priority = 1 + extra;
+                }
+
+                float spread = 1.0f - math::dot(normals[triangle], axis);
+                float score = math::length(centroids[triangle] - center) * (1.0f + (coneWeight * spread));
+                if (priority < bestPriority || (priority == bestPriority && score < bestScore))
+                {
+                    best = triangle;
+                    bestPriority = priority;
+                    bestScore = score;
+                }
+            }
+        }
+        return best;
+    };
+
+    while (true)
+    {
+        u32 triangle = NO_TRIANGLE;
+        if (meshlet.triangleCount > 0)
+        {
+            triangle = findCandidate(meshlet, true);
+            if (triangle == NO_TRIANGLE || meshlet.triangleCount == maxTriangles)
+            {
+                // Local vertex indices are reset before seeding, so the seed sees the previous meshlet as empty
+                for (u32 i = 0; i < meshlet.vertexCount; ++i)
+                {
+                    localVertices[meshData.meshletVertices[meshlet.vertexOffset + i]] = NO_LOCAL_VERTEX;
+                }
+                meshlet.bounds = computeMeshletBounds(
+                    positions, std::span(meshData.meshletVertices).subspan(meshlet.vertexOffset, meshlet.vertexCount),
+                    std::span(meshData.meshletTriangles)
+                        .subspan(meshlet.triangleOffset, static_cast<u64>(meshlet.triangleCount) * 3));
+                meshData.meshlets.push_back(meshlet);
+
+                // Seed the next meshlet next to the previous one, the scoring is relative to its center
+                triangle = findCandidate(meshlet, false);
+                meshlet = Meshlet();
+                meshlet.vertexOffset = static_cast<u32>(meshData.meshletVertices.size());
+                meshlet.triangleOffset = static_cast<u32>(meshData.meshletTriangles.size());
+                centroidSum = vec3(0.0f);
+                normalSum = vec3(0.0f);
+            }
+        }
+        for (; triangle == NO_TRIANGLE && scanTriangle < triangleCount; ++scanTriangle)
+        {
+            if (!emitted[scanTriangle])
+            {
+                triangle = static_cast<u32>(scanTriangle);
+            }
+        }
+        if (triangle == NO_TRIANGLE)
+        {
+            break;
+        }
+
+        emitted[triangle] = true;
+        for (u64 k = 0; k < 3; ++k)
+        {
+            u32 vertex = indices[(triangle * 3ull) + k];
+            if (localVertices[vertex] == NO_LOCAL_VERTEX)
+            {
+                localVertices[vertex] = static_cast<u8>(meshlet.vertexCount++);
+                meshData.meshletVertices.push_back(vertex);
+            }
+            meshData.meshletTriangles.push_back(localVertices[vertex]);
+            --liveTriangles[vertex];
+        }
+        ++meshlet.triangleCount;
+
+        centroidSum += centroids[triangle];
+        normalSum += normals[triangle];
+        center = centroidSum * (1.0f / static_cast<float>(meshlet.triangleCount));
+        float normalLength = math::length(normalSum);
+        axis = normalLength > 0.0f ? normalSum * (1.0f / normalLength) : vec3(0.0f);
+    }
+
+    if (meshlet.triangleCount > 0)
+    {
+        meshlet.bounds = computeMeshletBounds(
+            positions, std::span(meshData.meshletVertices).subspan(meshlet.vertexOffset, meshlet.vertexCount),
+            std::span(meshData.meshletTriangles)
+                .subspan(meshlet.triangleOffset, static_cast<u64>(meshlet.triangleCount) * 3));
+        meshData.meshlets.push_back(meshlet);
+    }
+}
+
+MeshletBounds computeMeshletBounds(std::span<const vec3> positions, std::span<const u32> vertices,
+                                   std::span<const u8> triangles)
+{
+    MeshletBounds bounds;
+    if (vertices.empty())
+    {
+        return bounds;
+    }
+
+    bounds.aabbMin = positions[vertices[0]];
+    bounds.aabbMax = positions[vertices[0]];
+    for (u32 vertex : vertices)
+    {
+        for (u64 j = 0; j < 3; ++j)
+        {
+            bounds.aabbMin[j] = std::min(bounds.aabbMin[j], positions[vertex][j]);
+            bounds.aabbMax[j] = std::max(bounds.aabbMax[j], positions[vertex][j]);
+        }
+    }
+
+    // Ritter's sphere, start from two distant points and grow the sphere to contain every point outside of it
+    auto farthestFrom = [&](const vec3& point) {
+        vec3 farthest = point;
+        float farthestDistance = 0.0f;
+        for (u32 vertex : vertices)
+        {
+            float distance = math::length(positions[vertex] - point);
+            if (distance > farthestDistance)
+            {
+                farthest = positions[vertex];
+                farthestDistance = distance;
+            }
+        }
+        return farthest;
+    };
+    vec3 a = farthestFrom(positions[vertices[0]]);
+    vec3 b = farthestFrom(a);
+    bounds.center = (a + b) * 0.5f;
+    bounds.radius = math::length(b - a) * 0.5f;
+    for (u32 vertex : vertices)
+    {
+        float distance = math::length(positions[vertex] - bounds.center);
+        if (distance > bounds.radius)
+        {
+            float radius = (bounds.radius + distance) * 0.5f;
+            bounds.center += (positions[vertex] - bounds.center) * ((radius - bounds.radius) / distance);
+            bounds.radius = radius;
+        }
+    }
+
+    // Normal cone, the axis is the average normal and the spread is the largest angle from it
+    u64 triangleCount = triangles.size() / 3;
+    std::vector<vec3> normals(triangleCount);
+    vec3 normalSum(0.0f);
+    for (u64 i = 0; i < triangleCount; ++i)
+    {
+        normals[i] = triangleNormal(positions[vertices[triangles[i * 3]]], positions[vertices[triangles[(i * 3) + 1]]],
+                                    positions[vertices[triangles[(i * 3) + 2]]]);
+        normalSum += normals[i];
+    }
+    bounds.coneApex = bounds.center;
+    float normalLength = math::length(normalSum);
+    if (normalLength <= 0.0f)
+    {
+        return bounds;
+    }
+    bounds.coneAxis = normalSum * (1.0f / normalLength);
+
+    float minDot = 1.0f;
+    for (const vec3& normal : normals)
+    {
+        if (normal != vec3(0.0f))
+        {
+            minDot = std::min(minDot, math::dot(normal, bounds.coneAxis));
+        }
+    }
+    if (minDot <= 0.0f)
+    {
+        // Normals spread over more than a hemisphere, there is always some triangle facing the camera
+        return bounds;
+    }
+
+    // Move the apex back along the axis until it is behind every triangle plane, then any view direction within the
+    // cone sees the back of every triangle
+    float maxOffset = std::numeric_limits<float>::lowest();
+    for (u64 i = 0; i < triangleCount; ++i)
+    {
+        if (normals[i] == vec3(0.0f))
+        {
+            continue;
+        }
+        const vec3& p0 = positions[vertices[triangles[i * 3]]];
+        float offset = math::dot(bounds.center - p0, normals[i]) / math::dot(bounds.coneAxis, normals[i]);
+        maxOffset = std::max(maxOffset, offset);
+    }
+    bounds.coneApex = bounds.center - (bounds.coneAxis * maxOffset);
+    bounds.coneCutoff = std::sqrt(1.0f - (minDot * minDot));
+    return bounds;
+}
+
+bool isMeshletBackfacing(const MeshletBounds& bounds, const vec3& cameraPosition)
+{
+    if (bounds.coneCutoff >= 1.0f)
+    {
+        return false;
+    }
+    vec3 direction = bounds.coneApex - cameraPosition;
+    return math::dot(direction, bounds.coneAxis) >= bounds.coneCutoff * math::length(direction);
+}
+
+} // namespace huedra
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "core/types.hpp"
+#include "resources/mesh/data.hpp"
+
+#include <span>
+
+namespace huedra {
+
+// Limits used by most mesh shader pipelines, 124 triangles keeps the primitive indices within 372 bytes
+constexpr u32 MESHLET_MAX_VERTICES = 64;
+constexpr u32 MESHLET_MAX_TRIANGLES = 124;
+
+// Splits the mesh into meshlets of at most maxVertices vertices (at most 255) and maxTriangles triangles. Triangles are
+// added greedily to the current meshlet, preferring triangles that reuse its vertices, then triangles close to its
+// center with normals close to its cone axis (scaled by coneWeight, 0 ignores the normals). A full meshlet seeds the
+// next one with a neighbouring triangle so that the meshlets stay spatially coherent.
+// The meshlets only reference vertices, so they stay valid when the index buffer is reordered
+void buildMeshlets(MeshData& meshData, u32 maxVertices = MESHLET_MAX_VERTICES,
+                   u32 maxTriangles = MESHLET_MAX_TRIANGLES, float coneWeight = 0.25f);
+
+// Bounding sphere (Ritter), aabb and backface normal cone of a cluster of triangles, triangles index into vertices
+MeshletBounds computeMeshletBounds(std::span<const vec3> positions, std::span<const u32> vertices,
+                                   std::span<const u8> triangles);
+
+// True if every triangle in the meshlet is facing away from the camera
+bool isMeshletBackfacing(const MeshletBounds& bounds, const vec3& cameraPosition);
+
+} // namespace huedra
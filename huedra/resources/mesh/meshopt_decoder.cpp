@@ -0,0 +1,598 @@
+#include "meshopt_decoder.hpp"
+
+#include "core/memory/utils.hpp"
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MESHOPT_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// Allows compiling the SIMD paths without enabling the instruction sets for the whole project, they are only called
+// after checking cpu support at runtime
+#if defined(__GNUC__) || defined(__clang__)
+#define MESHOPT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define MESHOPT_TARGET(isa)
+#endif
+
+namespace huedra {
+
+namespace {
+
+// Layout of the bitstreams, see the EXT_meshopt_compression specification
+constexpr u8 VERTEX_HEADER = 0xa0;
+constexpr u8 TRIANGLE_HEADER = 0xe0;
+constexpr u8 SEQUENCE_HEADER = 0xd0;
+constexpr u64 BYTE_GROUP_SIZE = 16;
+constexpr u64 BYTE_GROUP_DECODE_LIMIT = 24; // Largest group is 8 bytes of packed values and 16 bytes of escaped ones
+constexpr u64 VERTEX_BLOCK_SIZE_BYTES = 8192;
+constexpr u64 VERTEX_BLOCK_MAX_SIZE = 256;
+constexpr u64 VERTEX_TAIL_MIN_SIZE = 32;
+constexpr u64 MAX_VERTEX_STRIDE = 256;
+constexpr u64 CODEAUX_TABLE_SIZE = 16;
+constexpr u64 SEQUENCE_TAIL_SIZE = 4;
+
+bool hasSsse3()
+{
+#ifdef MESHOPT_X86
+    static const bool supported = [] {
+#if defined(_MSC_VER) && !defined(__clang__)
+        std::array<int, 4> info{};
+        __cpuid(info.data(), 1);
+        return (info[2] & (1 << 9)) != 0;
+#else
+        return __builtin_cpu_supports("ssse3") != 0;
+#endif
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+// Vertex data is split into groups of 16 byte deltas. Each group stores its values with 0, 2, 4 or 8 bits, packed most
+// significant bits first. A packed value with all bits set is an escape, the actual byte follows the packed values
+template <u32 BITS>
+const u8* decodeBytesGroupPacked(const u8* data, u8* dst)
+{
+    constexpr u64 valuesPerByte = 8 / BITS;
+    constexpr u8 escape = (1u << BITS) - 1;
+    const u8* escaped = data + (BYTE_GROUP_SIZE / valuesPerByte);
+    for (u64 i = 0; i < BYTE_GROUP_SIZE; ++i)
+    {
+        u8 value = (data[i / valuesPerByte] >> (8 - BITS - ((i % valuesPerByte) * BITS))) & escape;
+        dst[i] = value == escape ? *escaped++ : value;
+    }
+    return escaped;
+}
+
+const u8* decodeBytesGroup(const u8* data, u8* dst, u32 bitsLog2)
+{
+    switch (bitsLog2)
+    {
+    case 0:
+        std::memset(dst, 0, BYTE_GROUP_SIZE);
+        return data;
+    case 1:
+        return decodeBytesGroupPacked<2>(data, dst);
+    case 2:
+        return decodeBytesGroupPacked<4>(data, dst);
+    default:
+        std::memcpy(dst, data, BYTE_GROUP_SIZE);
+        return data + BYTE_GROUP_SIZE;
+    }
+}
+
+#ifdef MESHOPT_X86
+// The packed values are spread to one byte each with shifts and unpacks. Escaped bytes are moved into place with a
+// shuffle looked up from the escape mask of each half of the group, as done by meshoptimizer itself. Groups read at
+// most BYTE_GROUP_DECODE_LIMIT bytes, which decodeBytes checks before every group
+
+struct GroupShuffleTable
+{
+    std::array<std::array<u8, 8>, 256> shuffles{};
+    std::array<u8, 256> counts{};
+};
+
+constexpr GroupShuffleTable GROUP_SHUFFLE_TABLE = [] {
+    GroupShuffleTable table;
+    for (u32 mask = 0; mask < 256; ++mask)
+    {
+        u8 count = 0;
+        for (u32 i = 0; i < 8; ++i)
+        {
+            table.shuffles[mask][i] = (mask & (1u << i)) != 0 ? count++ : 0x80;
+        }
+        table.counts[mask] = count;
+    }
+    return table;
+}();
+
+MESHOPT_TARGET("ssse3") const u8* decodeBytesGroupEscaped(const u8* escaped, u8* dst, __m128i values, __m128i escape)
+{
+    __m128i mask = _mm_cmpeq_epi8(values, escape);
+    u32 mask16 = static_cast<u32>(_mm_movemask_epi8(mask));
+    u32 mask0 = mask16 & 0xff;
+    u32 mask1 = mask16 >> 8;
+
+    // The second half takes the escaped bytes after the ones of the first half, 0x80 entries stay negative
+    __m128i shuffle0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(GROUP_SHUFFLE_TABLE.shuffles[mask0].data()));
+    __m128i shuffle1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(GROUP_SHUFFLE_TABLE.shuffles[mask1].data()));
+    shuffle1 = _mm_add_epi8(shuffle1, _mm_set1_epi8(static_cast<char>(GROUP_SHUFFLE_TABLE.counts[mask0])));
+    __m128i shuffle = _mm_unpacklo_epi64(shuffle0, shuffle1);
+
+    __m128i rest = _mm_loadu_si128(reinterpret_cast<const __m128i*>(escaped));
+    __m128i result = _mm_or_si128(_mm_shuffle_epi8(rest, shuffle), _mm_andnot_si128(mask, values));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), result);
+    return escaped + GROUP_SHUFFLE_TABLE.counts[mask0] + GROUP_SHUFFLE_TABLE.counts[mask1];
+}
+
+MESHOPT_TARGET("ssse3") const u8* decodeBytesGroupSsse3(const u8* data, u8* dst, u32 bitsLog2)
+{
+    switch (bitsLog2)
+    {
+    case 1: {
+        // Each unpack step puts the higher bits of a byte in front of the lower ones
+        __m128i packed = _mm_cvtsi32_si128(static_cast<int>(parseFromBytes<u32>(data, std::endian::little)));
+        __m128i nibbles = _mm_unpacklo_epi8(_mm_srli_epi16(packed, 4), packed);
+        __m128i pairs = _mm_unpacklo_epi8(_mm_srli_epi16(nibbles, 2), nibbles);
+        __m128i values = _mm_and_si128(pairs, _mm_set1_epi8(3));
+        return decodeBytesGroupEscaped(data + 4, dst, values, _mm_set1_epi8(3));
+    }
+    case 2: {
+        __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data));
+        __m128i nibbles = _mm_unpacklo_epi8(_mm_srli_epi16(packed, 4), packed);
+        __m128i values = _mm_and_si128(nibbles, _mm_set1_epi8(15));
+        return decodeBytesGroupEscaped(data + 8, dst, values, _mm_set1_epi8(15));
+    }
+    default:
+        return decodeBytesGroup(data, dst, bitsLog2);
+    }
+}
+#endif
+
+using DecodeBytesGroupFunc = const u8* (*)(const u8*, u8*, u32);
+
+DecodeBytesGroupFunc getDecodeBytesGroupFunc()
+{
+#ifdef MESHOPT_X86
+    if (hasSsse3())
+    {
+        return decodeBytesGroupSsse3;
+    }
+#endif
+    return decodeBytesGroup;
+}
+
+// Decodes size bytes (a multiple of BYTE_GROUP_SIZE), the groups are preceded by their bit sizes as 2 bits each.
+// Returns nullptr if the data ends early
+const u8* decodeBytes(const u8* data, const u8* dataEnd, u8* dst, u64 size, DecodeBytesGroupFunc decodeGroup)
+{
+    const u8* header = data;
+    u64 headerSize = ((size / BYTE_GROUP_SIZE) + 3) / 4;
+    if (static_cast<u64>(dataEnd - data) < headerSize)
+    {
+        return nullptr;
+    }
+    data += headerSize;
+
+    for (u64 i = 0; i < size; i += BYTE_GROUP_SIZE)
+    {
+        if (static_cast<u64>(dataEnd - data) < BYTE_GROUP_DECODE_LIMIT)
+        {
+            return nullptr;
+        }
+        u64 group = i / BYTE_GROUP_SIZE;
+        u32 bitsLog2 = (header[group / 4] >> ((group % 4) * 2)) & 3;
+        data = decodeGroup(data, dst + i, bitsLog2);
+    }
+    return data;
+}
+
+// Variable length integer, 7 bits per byte starting with the lowest and the high bit set while more bytes follow
+u32 decodeVByte(const u8*& data)
+{
+    u8 lead = *data++;
+    if (lead < 128)
+    {
+        return lead;
+    }
+
+    u32 result = lead & 127;
+    u32 shift = 7;
+    for (u32 i = 0; i < 4; ++i)
+    {
+        u8 group = *data++;
+        result |= static_cast<u32>(group & 127) << shift;
+        shift += 7;
+        if (group < 128)
+        {
+            break;
+        }
+    }
+    return result;
+}
+
+// Free indices are zigzag encoded deltas to the previous free index
+u32 decodeIndexDelta(const u8*& data, u32 last)
+{
+    u32 value = decodeVByte(data);
+    return last + ((value >> 1) ^ (0u - (value & 1)));
+}
+
+void writeIndex(u8* dst, u64 index, u64 indexSize, u32 value)
+{
+    if (indexSize == 2)
+    {
+        parseToBytes<u16>(dst + (index * 2), static_cast<u16>(value), std::endian::little);
+    }
+    else
+    {
+        parseToBytes<u32>(dst + (index * 4), value, std::endian::little);
+    }
+}
+
+// Fifos of recently seen edges and vertices that triangles refer back to, wrapped around 16 entries
+struct TriangleFifos
+{
+    std::array<std::array<u32, 2>, 16> edges{};
+    std::array<u32, 16> vertices{};
+    u32 edgeOffset{0};
+    u32 vertexOffset{0};
+
+    TriangleFifos()
+    {
+        for (auto& edge : edges)
+        {
+            edge = {~0u, ~0u};
+        }
+        vertices.fill(~0u);
+    }
+
+    void pushEdge(u32 a, u32 b)
+    {
+        edges[edgeOffset] = {a, b};
+        edgeOffset = (edgeOffset + 1) & 15;
+    }
+
+    void pushVertex(u32 vertex, bool advance = true)
+    {
+        vertices[vertexOffset] = vertex;
+        vertexOffset = (vertexOffset + (advance ? 1 : 0)) & 15;
+    }
+
+    void pushTriangle(u32 a, u32 b, u32 c)
+    {
+        pushEdge(b, a);
+        pushEdge(c, b);
+        pushEdge(a, c);
+    }
+};
+
+template <typename T>
+void decodeOctahedral(u8* data, u64 count)
+{
+    constexpr u64 elementSize = sizeof(T) * 4;
+    constexpr float maxValue = static_cast<float>((1 << ((sizeof(T) * 8) - 1)) - 1);
+    for (u64 i = 0; i < count; ++i)
+    {
+        u8* element = data + (i * elementSize);
+        float x = parseFromBytes<T>(element, std::endian::little);
+        float y = parseFromBytes<T>(element + sizeof(T), std::endian::little);
+        // z is stored as 1.0 at the same bit count, it is reconstructed from the distance to the octahedron edge
+        float z = static_cast<float>(parseFromBytes<T>(element + (sizeof(T) * 2), std::endian::little)) -
+                  std::abs(x) - std::abs(y);
+
+        // Unfolds the lower hemisphere
+        float t = std::min(z, 0.0f);
+        x += x >= 0.0f ? t : -t;
+        y += y >= 0.0f ? t : -t;
+
+        float scale = maxValue / std::sqrt((x * x) + (y * y) + (z * z));
+        parseToBytes<T>(element, static_cast<T>(std::lround(x * scale)), std::endian::little);
+        parseToBytes<T>(element + sizeof(T), static_cast<T>(std::lround(y * scale)), std::endian::little);
+        parseToBytes<T>(element + (sizeof(T) * 2), static_cast<T>(std::lround(z * scale)), std::endian::little);
+    }
+}
+
+void decodeQuaternion(u8* data, u64 count)
+{
+    const float scale = 1.0f / std::sqrt(2.0f);
+    for (u64 i = 0; i < count; ++i)
+    {
+        u8* element = data + (i * 8);
+        i16 last = parseFromBytes<i16>(element + 6, std::endian::little);
+
+        // The high bits of the last component hold the range of the others, the low 2 bits the index of the largest
+        float componentScale = scale / static_cast<float>(last | 3);
+        std::array<float, 3> components{};
+        float lengthSq = 0.0f;
+        for (u64 j = 0; j < 3; ++j)
+        {
+            components[j] = parseFromBytes<i16>(element + (j * 2), std::endian::little) * componentScale;
+            lengthSq += components[j] * components[j];
+        }
+        float largest = std::sqrt(std::max(1.0f - lengthSq, 0.0f));
+
+        u32 largestIndex = static_cast<u32>(last) & 3;
+        for (u32 j = 0; j < 3; ++j)
+        {
+            parseToBytes<i16>(element + (((largestIndex + j + 1) & 3) * 2),
+                              static_cast<i16>(std::lround(components[j] * 32767.0f)), std::endian::little);
+        }
+        parseToBytes<i16>(element + (largestIndex * 2), static_cast<i16>(std::lround(largest * 32767.0f)),
+                          std::endian::little);
+    }
+}
+
+// value = mantissa * 2^exponent, with the exponent in the top 8 bits and the mantissa in the rest, both signed
+void decodeExponential(u8* data, u64 count)
+{
+    u64 i = 0;
+#ifdef MESHOPT_X86
+    // SSE2 is part of the base instruction set of x86-64, so no runtime check is needed
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + (i * 4)));
+        __m128i mantissa = _mm_srai_epi32(_mm_slli_epi32(value, 8), 8);
+        __m128i exponent = _mm_srai_epi32(value, 24);
+        __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(127)), 23));
+        _mm_storeu_ps(reinterpret_cast<float*>(data + (i * 4)), _mm_mul_ps(scale, _mm_cvtepi32_ps(mantissa)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        u32 value = parseFromBytes<u32>(data + (i * 4), std::endian::little);
+        i32 mantissa = static_cast<i32>(value << 8) >> 8;
+        i32 exponent = static_cast<i32>(value) >> 24;
+        float scale = std::bit_cast<float>(static_cast<u32>(exponent + 127) << 23);
+        parseToBytes<u32>(data + (i * 4), std::bit_cast<u32>(scale * static_cast<float>(mantissa)),
+                          std::endian::little);
+    }
+}
+
+} // namespace
+
+bool decodeMeshoptVertices(std::span<const u8> src, u64 count, u64 byteStride, std::span<u8> dst)
+{
+    if (byteStride == 0 || byteStride > MAX_VERTEX_STRIDE || byteStride % 4 != 0 || dst.size() < count * byteStride)
+    {
+        return false;
+    }
+
+    // The tail holds the element that the deltas of the first block are relative to, padded to at least 32 bytes
+    u64 tailSize = std::max(byteStride, VERTEX_TAIL_MIN_SIZE);
+    if (src.size() < 1 + tailSize || src[0] != VERTEX_HEADER)
+    {
+        return false;
+    }
+    std::array<u8, MAX_VERTEX_STRIDE> lastVertex{};
+    std::memcpy(lastVertex.data(), src.data() + src.size() - byteStride, byteStride);
+
+    const u8* data = src.data() + 1;
+    const u8* dataEnd = src.data() + src.size();
+    DecodeBytesGroupFunc decodeGroup = getDecodeBytesGroupFunc();
+
+    // Blocks store byte k of all their elements together as zigzag encoded deltas to byte k of the previous element
+    u64 blockSize = std::min((VERTEX_BLOCK_SIZE_BYTES / byteStride) & ~(BYTE_GROUP_SIZE - 1), VERTEX_BLOCK_MAX_SIZE);
+    std::array<u8, VERTEX_BLOCK_MAX_SIZE> deltas{};
+    for (u64 offset = 0; offset < count; offset += blockSize)
+    {
+        u64 blockCount = std::min(blockSize, count - offset);
+        u64 alignedCount = (blockCount + BYTE_GROUP_SIZE - 1) & ~(BYTE_GROUP_SIZE - 1);
+        u8* block = dst.data() + (offset * byteStride);
+        for (u64 k = 0; k < byteStride; ++k)
+        {
+            data = decodeBytes(data, dataEnd, deltas.data(), alignedCount, decodeGroup);
+            if (data == nullptr)
+            {
+                return false;
+            }
+
+            u8 previous = lastVertex[k];
+            for (u64 i = 0; i < blockCount; ++i)
+            {
+                u8 delta = deltas[i];
+                previous = static_cast<u8>(previous + ((delta >> 1) ^ (0u - (delta & 1))));
+                block[(i * byteStride) + k] = previous;
+            }
+        }
+        std::memcpy(lastVertex.data(), block + ((blockCount - 1) * byteStride), byteStride);
+    }
+
+    return static_cast<u64>(dataEnd - data) == tailSize;
+}
+
+bool decodeMeshoptTriangles(std::span<const u8> src, u64 count, u64 indexSize, std::span<u8> dst)
+{
+    if (count % 3 != 0 || (indexSize != 2 && indexSize != 4) || dst.size() < count * indexSize)
+    {
+        return false;
+    }
+
+    // One code byte per triangle follows the header, then the triangle data and a table of 16 common codeaux bytes
+    if (src.size() < 1 + (count / 3) + CODEAUX_TABLE_SIZE || (src[0] & 0xf0) != TRIANGLE_HEADER)
+    {
+        return false;
+    }
+    u32 version = src[0] & 0x0f;
+    if (version > 1)
+    {
+        return false;
+    }
+
+    const u8* code = src.data() + 1;
+    const u8* data = code + (count / 3);
+    const u8* dataSafeEnd = src.data() + src.size() - CODEAUX_TABLE_SIZE;
+    const u8* codeauxTable = dataSafeEnd;
+
+    TriangleFifos fifos;
+    u32 next = 0; // Next vertex that has not been referenced yet
+    u32 last = 0; // Last free index, the base of the free index deltas
+    u32 fecMax = version >= 1 ? 13 : 15;
+
+    for (u64 i = 0; i < count; i += 3)
+    {
+        // A triangle reads at most 16 bytes of data, which the codeaux table after the data makes room for
+        if (data > dataSafeEnd)
+        {
+            return false;
+        }
+
+        u8 codeTri = *code++;
+        if (codeTri < 0xf0)
+        {
+            // Triangle on an edge from the fifo, the third vertex is new, from the fifo or a free index
+            const std::array<u32, 2>& edge = fifos.edges[(fifos.edgeOffset - 1 - (codeTri >> 4)) & 15];
+            u32 a = edge[0];
+            u32 b = edge[1];
+            u32 fec = codeTri & 15;
+
+            u32 c = 0;
+            bool advance = true;
+            if (fec < fecMax)
+            {
+                c = fec == 0 ? next++ : fifos.vertices[(fifos.vertexOffset - 1 - fec) & 15];
+                advance = fec == 0;
+            }
+            else
+            {
+                // 13 and 14 are the last free index -1 and +1 in version 1
+                last = c = fec != 15 ? last + (fec == 13 ? ~0u : 1u) : decodeIndexDelta(data, last);
+            }
+
+            writeIndex(dst.data(), i, indexSize, a);
+            writeIndex(dst.data(), i + 1, indexSize, b);
+            writeIndex(dst.data(), i + 2, indexSize, c);
+            fifos.pushVertex(c, advance);
+            fifos.pushEdge(c, b);
+            fifos.pushEdge(a, c);
+            continue;
+        }
+
+        // Triangle without a known edge, the codes of b and c come from the table or a codeaux byte in the data
+        u8 codeAux = codeTri < 0xfe ? codeauxTable[codeTri & 15] : *data++;
+        u32 feb = codeAux >> 4;
+        u32 fec = codeAux & 15;
+        bool freeA = codeTri == 0xff;
+        if (codeTri >= 0xfe && codeAux == 0)
+        {
+            next = 0; // Restart, encoded as not-a-table codeaux 0
+        }
+
+        // next is incremented for all three vertices before the free indices are decoded, like the encoder does
+        u32 a = freeA ? 0 : next++;
+        u32 b = feb == 0 ? next++ : fifos.vertices[(fifos.vertexOffset - feb) & 15];
+        u32 c = fec == 0 ? next++ : fifos.vertices[(fifos.vertexOffset - fec) & 15];
+        if (codeTri >= 0xfe)
+        {
+            if (freeA)
+            {
+                last = a = decodeIndexDelta(data, last);
+            }
+            if (feb == 15)
+            {
+                last = b = decodeIndexDelta(data, last);
+            }
+            if (fec == 15)
+            {
+                last = c = decodeIndexDelta(data, last);
+            }
+        }
+
+        writeIndex(dst.data(), i, indexSize, a);
+        writeIndex(dst.data(), i + 1, indexSize, b);
+        writeIndex(dst.data(), i + 2, indexSize, c);
+        fifos.pushVertex(a);
+        fifos.pushVertex(b, feb == 0 || feb == 15);
+        fifos.pushVertex(c, fec == 0 || fec == 15);
+        fifos.pushTriangle(a, b, c);
+    }
+
+    return data == dataSafeEnd;
+}
+
+bool decodeMeshoptIndices(std::span<const u8> src, u64 count, u64 indexSize, std::span<u8> dst)
+{
+    if ((indexSize != 2 && indexSize != 4) || dst.size() < count * indexSize)
+    {
+        return false;
+    }
+    if (src.size() < 1 + count + SEQUENCE_TAIL_SIZE || (src[0] & 0xf0) != SEQUENCE_HEADER || (src[0] & 0x0f) > 1)
+    {
+        return false;
+    }
+
+    const u8* data = src.data() + 1;
+    const u8* dataSafeEnd = src.data() + src.size() - SEQUENCE_TAIL_SIZE;
+
+    // Indices are deltas to one of two baselines, the lowest bit selects which
+    std::array<u32, 2> last{};
+    for (u64 i = 0; i < count; ++i)
+    {
+        // An index reads at most 5 bytes, which the tail after the data makes room for
+        if (data >= dataSafeEnd)
+        {
+            return false;
+        }
+
+        u32 value = decodeVByte(data);
+        u32 baseline = value & 1;
+        value >>= 1;
+        last[baseline] += (value >> 1) ^ (0u - (value & 1));
+        writeIndex(dst.data(), i, indexSize, last[baseline]);
+    }
+
+    return data == dataSafeEnd;
+}
+
+bool applyMeshoptFilter(MeshoptFilter filter, u64 count, u64 byteStride, std::span<u8> data)
+{
+    if (data.size() < count * byteStride)
+    {
+        return false;
+    }
+
+    switch (filter)
+    {
+    case MeshoptFilter::NONE:
+        return true;
+    case MeshoptFilter::OCTAHEDRAL:
+        if (byteStride == 4)
+        {
+            decodeOctahedral<i8>(data.data(), count);
+            return true;
+        }
+        if (byteStride == 8)
+        {
+            decodeOctahedral<i16>(data.data(), count);
+            return true;
+        }
+        return false;
+    case MeshoptFilter::QUATERNION:
+        if (byteStride != 8)
+        {
+            return false;
+        }
+        decodeQuaternion(data.data(), count);
+        return true;
+    case MeshoptFilter::EXPONENTIAL:
+        if (byteStride % 4 != 0)
+        {
+            return false;
+        }
+        decodeExponential(data.data(), count * byteStride / 4);
+        return true;
+    }
+    return false;
+}
+
+} // namespace huedra
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "core/types.hpp"
+
+#include <span>
+
+namespace huedra {
+
+// Decoders for the bitstreams of the EXT_meshopt_compression gltf extension (the meshoptimizer codecs). All of them
+// write exactly count elements to dst, which has to hold count * stride bytes, and return false if the data is corrupt
+// or the stride is not allowed by the extension. Output is little endian like the uncompressed buffer data would be
+
+enum class MeshoptFilter
+{
+    NONE,
+    OCTAHEDRAL,  // Unit vectors as 2 components of 8 or 16 bits, z is reconstructed
+    QUATERNION,  // Unit quaternions as 3 components of 16 bits, the largest component is reconstructed
+    EXPONENTIAL, // Floats as a shared exponent and a 24-bit mantissa
+};
+
+// "ATTRIBUTES" mode, byteStride has to be a multiple of 4 of at most 256
+bool decodeMeshoptVertices(std::span<const u8> src, u64 count, u64 byteStride, std::span<u8> dst);
+
+// "TRIANGLES" mode, count is the index count and a multiple of 3, indexSize is 2 or 4
+bool decodeMeshoptTriangles(std::span<const u8> src, u64 count, u64 indexSize, std::span<u8> dst);
+
+// "INDICES" mode, for index lists that are not triangles, indexSize is 2 or 4
+bool decodeMeshoptIndices(std::span<const u8> src, u64 count, u64 indexSize, std::span<u8> dst);
+
+// Reverts the filter of vertices decoded by decodeMeshoptVertices in place
+bool applyMeshoptFilter(MeshoptFilter filter, u64 count, u64 byteStride, std::span<u8> data);
+
+} // namespace huedra
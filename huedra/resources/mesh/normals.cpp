@@ -0,0 +1,375 @@
+#include "normals.hpp"
+#include "core/log.hpp"
+#include "core/thread/utils.hpp"
+#include "math/vec_transform.hpp"
+#include "resources/mesh/vertex_welder.hpp"
+
+#include <bit>
+#include <cmath>
+#include <numbers>
+#include <span>
+
+namespace huedra {
+
+namespace {
+
+// Smallest amount of triangles or vertices worth handing to a separate thread
+constexpr u64 ELEMENTS_PER_TASK = 16384;
+
+// Calls func(begin, end) for ranges of at most ELEMENTS_PER_TASK elements spread over worker threads
+template <typename Func>
+void parallelForRanges(u64 count, Func&& func)
+{
+    parallelFor((count + ELEMENTS_PER_TASK - 1) / ELEMENTS_PER_TASK, [&](u64 i) {
+        func(i * ELEMENTS_PER_TASK, std::min(count, (i + 1) * ELEMENTS_PER_TASK));
+    });
+}
+
+// Corners (positions in the index buffer) around every group of vertices in compressed rows, the corners of group g
+// are corners[offsets[g]] to corners[offsets[g + 1]]. Gathering per group instead of scattering per triangle lets
+// the groups be summed on separate threads without atomics and keeps the result deterministic
+struct CornerTable
+{
+    std::vector<u32> offsets;
+    std::vector<u32> corners;
+};
+
+CornerTable buildCornerTable(const std::vector<u32>& indices, const std::vector<u32>& groups, u64 groupCount)
+{
+    CornerTable table;
+    table.offsets.resize(groupCount + 1, 0);
+    for (u32 index : indices)
+    {
+        ++table.offsets[groups[index] + 1];
+    }
+    for (u64 i = 1; i < table.offsets.size(); ++i)
+    {
+        table.offsets[i] += table.offsets[i - 1];
+    }
+
+    std::vector<u32> cursors(table.offsets.begin(), table.offsets.end() - 1);
+    table.corners.resize(indices.size());
+    for (u64 i = 0; i < indices.size(); ++i)
+    {
+        table.corners[cursors[groups[indices[i]]]++] = static_cast<u32>(i);
+    }
+    return table;
+}
+
+vec3 normalizeOrZero(const vec3& vec)
+{
+    float len = math::length(vec);
+    return len > 0.0f ? vec / len : vec3(0.0f);
+}
+
+// Angles of every corner of every triangle
+void computeCornerAngles(const MeshData& meshData, std::vector<float>& angles)
+{
+    angles.resize(meshData.indices.size());
+    parallelForRanges(meshData.indices.size() / 3, [&](u64 begin, u64 end) {
+        for (u64 i = begin; i < end; ++i)
+        {
+            const vec3& p0 = meshData.positions[meshData.indices[(i * 3) + 0]];
+            const vec3& p1 = meshData.positions[meshData.indices[(i * 3) + 1]];
+            const vec3& p2 = meshData.positions[meshData.indices[(i * 3) + 2]];
+            vec3 edge01 = normalizeOrZero(p1 - p0);
+            vec3 edge12 = normalizeOrZero(p2 - p1);
+            vec3 edge02 = normalizeOrZero(p2 - p0);
+            float angle0 = std::acos(std::clamp(math::dot(edge01, edge02), -1.0f, 1.0f));
+            float angle1 = std::acos(std::clamp(-math::dot(edge01, edge12), -1.0f, 1.0f));
+            angles[(i * 3) + 0] = angle0;
+            angles[(i * 3) + 1] = angle1;
+            angles[(i * 3) + 2] = std::max(std::numbers::pi_v<float> - angle0 - angle1, 0.0f);
+        }
+    });
+}
+
+// Gives vertices at the same position the same group. Vertices are split into buckets by a hash of their position
+// first, so that every bucket can be welded on its own thread with a table small enough to stay in cache
+u64 weldPositions(const std::vector<vec3>& positions, std::vector<u32>& groups)
+{
+    u64 bucketCount = std::bit_ceil(std::max<u64>(positions.size() / ELEMENTS_PER_TASK, 1));
+    std::vector<u32> buckets(positions.size());
+    std::vector<u32> bucketOffsets(bucketCount + 1, 0);
+    for (u64 i = 0; i < positions.size(); ++i)
+    {
+        // Adding 0 turns -0.0 into 0.0 so that both weld together
+        vec3 position = positions[i] + vec3(0.0f);
+        u64 hash = (std::bit_cast<u32>(position.x) * 0x9e3779b97f4a7c15ull) ^
+                   (std::bit_cast<u32>(position.y) * 0xc2b2ae3d27d4eb4full) ^
+                   (std::bit_cast<u32>(position.z) * 0x165667b19e3779f9ull);
+        buckets[i] = static_cast<u32>((hash >> 32) & (bucketCount - 1));
+        ++bucketOffsets[buckets[i] + 1];
+    }
+    for (u64 i = 1; i < bucketOffsets.size(); ++i)
+    {
+        bucketOffsets[i] += bucketOffsets[i - 1];
+    }
+
+    std::vector<u32> cursors(bucketOffsets.begin(), bucketOffsets.end() - 1);
+    std::vector<u32> sorted(positions.size());
+    for (u64 i = 0; i < positions.size(); ++i)
+    {
+        sorted[cursors[buckets[i]]++] = static_cast<u32>(i);
+    }
+
+    // Groups are numbered per bucket first and offset by the group counts of the previous buckets afterwards
+    std::vector<u32> groupCounts(bucketCount + 1, 0);
+    groups.resize(positions.size());
+    parallelFor(bucketCount, [&](u64 bucket) {
+        VertexWelder welder(sizeof(vec3), bucketOffsets[bucket + 1] - bucketOffsets[bucket]);
+        for (u32 j = bucketOffsets[bucket]; j < bucketOffsets[bucket + 1]; ++j)
+        {
+            groups[sorted[j]] = welder.insert(positions[sorted[j]] + vec3(0.0f)).first;
+        }
+        groupCounts[bucket + 1] = static_cast<u32>(welder.size());
+    });
+    for (u64 i = 1; i < groupCounts.size(); ++i)
+    {
+        groupCounts[i] += groupCounts[i - 1];
+    }
+    parallelForRanges(positions.size(), [&](u64 begin, u64 end) {
+        for (u64 i = begin; i < end; ++i)
+        {
+            groups[i] += groupCounts[buckets[i]];
+        }
+    });
+    return groupCounts.back();
+}
+
+bool validateIndices(const MeshData& meshData, const char* func)
+{
+    for (u32 index : meshData.indices)
+    {
+        if (index >= meshData.positions.size())
+        {
+            log(LogLevel::WARNING, "{}(): mesh \"{}\" has an index out of range: {}", func, meshData.name.c_str(),
+                index);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sign of the uv determinant of a triangle, negative for mirrored uvs and zero for degenerate uvs
+float computeUvOrientation(const MeshData& meshData, u32 i0, u32 i1, u32 i2)
+{
+    vec2 uvEdge1 = meshData.uvs[i1] - meshData.uvs[i0];
+    vec2 uvEdge2 = meshData.uvs[i2] - meshData.uvs[i0];
+    float determinant = (uvEdge1.x * uvEdge2.y) - (uvEdge2.x * uvEdge1.y);
+    return determinant < 0.0f ? -1.0f : (determinant > 0.0f ? 1.0f : 0.0f);
+}
+
+// Duplicates every vertex that is shared by triangles with regular and mirrored uvs and moves the mirrored triangles
+// onto the copy, as MikkTSpace does, so that both sides of a mirror seam get their own handedness. Triangles with
+// degenerate uvs keep the original vertex. Lod triangles are moved by their own orientation
+void splitMirroredVertices(MeshData& meshData, const std::vector<float>& orientations)
+{
+    constexpr u8 REGULAR = 1;
+    constexpr u8 MIRRORED = 2;
+    u64 vertexCount = meshData.positions.size();
+    std::vector<u8> usage(vertexCount, 0);
+    for (u64 i = 0; i < orientations.size(); ++i)
+    {
+        u8 flag = orientations[i] > 0.0f ? REGULAR : (orientations[i] < 0.0f ? MIRRORED : 0);
+        for (u64 j = 0; j < 3; ++j)
+        {
+            usage[meshData.indices[(i * 3) + j]] |= flag;
+        }
+    }
+
+    std::vector<u32> copies(vertexCount, ~0u);
+    for (u64 i = 0; i < vertexCount; ++i)
+    {
+        if (usage[i] == (REGULAR | MIRRORED))
+        {
+            copies[i] = static_cast<u32>(meshData.positions.size());
+            meshData.positions.push_back(meshData.positions[i]);
+            meshData.normals.push_back(meshData.normals[i]);
+            meshData.uvs.push_back(meshData.uvs[i]);
+        }
+    }
+    if (meshData.positions.size() == vertexCount)
+    {
+        return;
+    }
+
+    auto moveMirrored = [&copies](std::span<u32> triangle) {
+        for (u32& index : triangle)
+        {
+            if (index < copies.size() && copies[index] != ~0u)
+            {
+                index = copies[index];
+            }
+        }
+    };
+    for (u64 i = 0; i < orientations.size(); ++i)
+    {
+        if (orientations[i] < 0.0f)
+        {
+            moveMirrored(std::span(meshData.indices).subspan(i * 3, 3));
+        }
+    }
+    for (u64 i = 0; i + 2 < meshData.lodIndices.size(); i += 3)
+    {
+        std::span<u32> triangle = std::span(meshData.lodIndices).subspan(i, 3);
+        if (triangle[0] < vertexCount && triangle[1] < vertexCount && triangle[2] < vertexCount &&
+            computeUvOrientation(meshData, triangle[0], triangle[1], triangle[2]) < 0.0f)
+        {
+            moveMirrored(triangle);
+        }
+    }
+}
+
+} // namespace
+
+bool generateNormals(MeshData& meshData, const NormalSettings& settings)
+{
+    if (!validateIndices(meshData, "generateNormals"))
+    {
+        return false;
+    }
+    u64 vertexCount = meshData.positions.size();
+    u64 triangleCount = meshData.indices.size() / 3;
+
+    // The length of the cross product is twice the area of the triangle, so it is kept for area weighting
+    std::vector<vec3> faceNormals(triangleCount);
+    parallelForRanges(triangleCount, [&](u64 begin, u64 end) {
+        for (u64 i = begin; i < end; ++i)
+        {
+            const vec3& p0 = meshData.positions[meshData.indices[(i * 3) + 0]];
+            const vec3& p1 = meshData.positions[meshData.indices[(i * 3) + 1]];
+            const vec3& p2 = meshData.positions[meshData.indices[(i * 3) + 2]];
+            vec3 normal = math::cross(p1 - p0, p2 - p0);
+            faceNormals[i] = settings.weighting == NormalWeighting::AREA ? normal : normalizeOrZero(normal);
+        }
+    });
+
+    std::vector<float> angles;
+    if (settings.weighting == NormalWeighting::ANGLE)
+    {
+        computeCornerAngles(meshData, angles);
+    }
+
+    // Every vertex is its own group unless vertices are welded by position
+    std::vector<u32> groups(vertexCount);
+    u64 groupCount = vertexCount;
+    if (settings.weldPositions)
+    {
+        groupCount = weldPositions(meshData.positions, groups);
+    }
+    else
+    {
+        for (u64 i = 0; i < vertexCount; ++i)
+        {
+            groups[i] = static_cast<u32>(i);
+        }
+    }
+
+    CornerTable table = buildCornerTable(meshData.indices, groups, groupCount);
+    std::vector<vec3> groupNormals(groupCount);
+    parallelForRanges(groupCount, [&](u64 begin, u64 end) {
+        for (u64 i = begin; i < end; ++i)
+        {
+            vec3 sum(0.0f);
+            for (u32 j = table.offsets[i]; j < table.offsets[i + 1]; ++j)
+            {
+                u32 corner = table.corners[j];
+                float weight = angles.empty() ? 1.0f : angles[corner];
+                sum += faceNormals[corner / 3] * weight;
+            }
+            groupNormals[i] = normalizeOrZero(sum);
+        }
+    });
+
+    meshData.normals.resize(vertexCount);
+    parallelForRanges(vertexCount, [&](u64 begin, u64 end) {
+        for (u64 i = begin; i < end; ++i)
+        {
+            meshData.normals[i] = groupNormals[groups[i]];
+        }
+    });
+    return true;
+}
+
+bool generateTangents(MeshData& meshData)
+{
+    u64 vertexCount = meshData.positions.size();
+    if (meshData.normals.size() != vertexCount || meshData.uvs.size() != vertexCount)
+    {
+        log(LogLevel::WARNING, "generateTangents(): mesh \"{}\" needs normals and uvs for every vertex",
+            meshData.name.c_str());
+        return false;
+    }
+    if (!validateIndices(meshData, "generateTangents"))
+    {
+        return false;
+    }
+    u64 triangleCount = meshData.indices.size() / 3;
+
+    // Directions of increasing u and v on every triangle. Only the directions matter, so instead of dividing by the
+    // uv determinant only its sign is applied, which keeps triangles with mirrored uvs oriented correctly. Degenerate
+    // uvs get a zero orientation, their vertices fall back to the other triangles around them
+    std::vector<vec3> faceTangents(triangleCount);
+    std::vector<vec3> faceBitangents(triangleCount);
+    std::vector<float> orientations(triangleCount);
+    parallelForRanges(triangleCount, [&](u64 begin, u64 end) {
+        for (u64 i = begin; i < end; ++i)
+        {
+            u32 i0 = meshData.indices[(i * 3) + 0];
+            u32 i1 = meshData.indices[(i * 3) + 1];
+            u32 i2 = meshData.indices[(i * 3) + 2];
+            vec3 edge1 = meshData.positions[i1] - meshData.positions[i0];
+            vec3 edge2 = meshData.positions[i2] - meshData.positions[i0];
+            vec2 uvEdge1 = meshData.uvs[i1] - meshData.uvs[i0];
+            vec2 uvEdge2 = meshData.uvs[i2] - meshData.uvs[i0];
+
+            orientations[i] = computeUvOrientation(meshData, i0, i1, i2);
+            faceTangents[i] = ((edge1 * uvEdge2.y) - (edge2 * uvEdge1.y)) * orientations[i];
+            faceBitangents[i] = ((edge2 * uvEdge1.x) - (edge1 * uvEdge2.x)) * orientations[i];
+        }
+    });
+
+    splitMirroredVertices(meshData, orientations);
+    vertexCount = meshData.positions.size();
+
+    std::vector<float> angles;
+    computeCornerAngles(meshData, angles);
+
+    std::vector<u32> groups(vertexCount);
+    for (u64 i = 0; i < vertexCount; ++i)
+    {
+        groups[i] = static_cast<u32>(i);
+    }
+    CornerTable table = buildCornerTable(meshData.indices, groups, vertexCount);
+
+    meshData.tangents.resize(vertexCount);
+    parallelForRanges(vertexCount, [&](u64 begin, u64 end) {
+        for (u64 i = begin; i < end; ++i)
+        {
+            const vec3& normal = meshData.normals[i];
+            vec3 tangentSum(0.0f);
+            vec3 bitangentSum(0.0f);
+            for (u32 j = table.offsets[i]; j < table.offsets[i + 1]; ++j)
+            {
+                u32 corner = table.corners[j];
+                const vec3& faceTangent = faceTangents[corner / 3];
+                tangentSum += normalizeOrZero(faceTangent - (normal * math::dot(normal, faceTangent))) * angles[corner];
+                bitangentSum += normalizeOrZero(faceBitangents[corner / 3]) * angles[corner];
+            }
+
+            vec3 tangent = normalizeOrZero(tangentSum);
+            if (tangent == vec3(0.0f))
+            {
+                // No usable uvs around the vertex, any direction perpendicular to the normal is as good as another
+                vec3 axis = std::abs(normal.x) < 0.9f ? vec3(1.0f, 0.0f, 0.0f) : vec3(0.0f, 1.0f, 0.0f);
+                tangent = normalizeOrZero(math::cross(axis, normal));
+            }
+            float handedness = math::dot(math::cross(normal, tangent), bitangentSum) < 0.0f ? -1.0f : 1.0f;
+            meshData.tangents[i] = vec4(tangent.x, tangent.y, tangent.z, handedness);
+        }
+    });
+    return true;
+}
+
+} // namespace huedra
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "core/types.hpp"
+#include "resources/mesh/data.hpp"
+
+namespace huedra {
+
+enum class NormalWeighting
+{
+    AREA,  // Larger triangles contribute more, cheapest
+    ANGLE, // Triangles contribute by their angle at the vertex, independent of how the surface is triangulated
+};
+
+struct NormalSettings
+{
+    NormalWeighting weighting{NormalWeighting::ANGLE};
+    bool weldPositions{true}; // Vertices at the same position share a normal, hides uv seams but smooths hard edges
+};
+
+// Computes a normal for every vertex by summing the normals of the triangles around it, existing normals are
+// replaced. Triangle ranges and vertex ranges are processed on worker threads. Returns false if the indices are out
+// of range
+bool generateNormals(MeshData& meshData, const NormalSettings& settings = {});
+
+// Computes a tangent for every vertex in the MikkTSpace convention (Mikkelsen 2008): the tangents of the triangles
+// around a vertex are projected into the plane of its normal, normalized and summed with angle weights. w is the
+// handedness, the bitangent is cross(normal, tangent.xyz) * w. Vertices where triangles with regular and mirrored uvs
+// meet are split like in MikkTSpace, the copies are appended and the indices and lod indices of the mirrored
+// triangles are moved onto them. Meshlets are not remapped, build them afterwards. Requires normals and uvs, returns
+// false if they are missing
+bool generateTangents(MeshData& meshData);
+
+} // namespace huedra
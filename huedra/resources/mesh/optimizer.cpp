@@ -0,0 +1,370 @@
+#include "optimizer.hpp"
+#include "core/log.hpp"
+#include "math/vec_transform.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace huedra {
+
+namespace {
+
+constexpr u32 NO_VERTEX = ~0u;
+
+// Triangles using each vertex, laid out as offsets into one array
+struct TriangleAdjacency
+{
+    std::vector<u32> offsets; // vertexCount + 1
+    std::vector<u32> triangles;
+};
+
+TriangleAdjacency buildTriangleAdjacency(std::span<const u32> indices, u64 vertexCount)
+{
+    TriangleAdjacency adjacency;
+    adjacency.offsets.assign(vertexCount + 1, 0);
+    for (u32 index : indices)
+    {
+        ++adjacency.offsets[index + 1];
+    }
+    std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+
+    std::vector<u32> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    adjacency.triangles.resize(indices.size());
+    for (u64 i = 0; i < indices.size(); ++i)
+    {
+        adjacency.triangles[fill[indices[i]]++] = static_cast<u32>(i / 3);
+    }
+    return adjacency;
+}
+
+// Fifo cache simulation, a vertex is in the cache if fewer than cacheSize misses happened since it was loaded
+class VertexCacheSimulator
+{
+public:
+    VertexCacheSimulator(u64 vertexCount, u32 cacheSize)
+        : m_cacheSize(cacheSize), m_time(cacheSize), m_timestamps(vertexCount, 0)
+    {}
+
+    // Returns true on a cache miss
+    bool access(u32 vertex)
+    {
+        if (m_time - m_timestamps[vertex] < m_cacheSize)
+        {
+            return false;
+        }
+        m_timestamps[vertex] = m_time++;
+        return true;
+    }
+
+    void flush() { m_time += m_cacheSize; }
+
+private:
+    u32 m_cacheSize;
+    u64 m_time{0}; // Starts at the cache size so that every vertex starts out of the cache
+    std::vector<u64> m_timestamps;
+};
+
+} // namespace
+
+VertexCacheStats analyzeVertexCache(std::span<const u32> indices, u64 vertexCount, u32 cacheSize)
+{
+    VertexCacheStats stats;
+    u64 triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return stats;
+    }
+
+    VertexCacheSimulator cache(vertexCount, cacheSize);
+    std::vector<bool> referenced(vertexCount, false);
+    u64 misses = 0;
+    u64 uniqueVertices = 0;
+    for (u32 index : indices)
+    {
+        misses += cache.access(index) ? 1 : 0;
+        if (!referenced[index])
+        {
+            referenced[index] = true;
+            ++uniqueVertices;
+        }
+    }
+
+    stats.acmr = static_cast<float>(misses) / static_cast<float>(triangleCount);
+    stats.atvr = static_cast<float>(misses) / static_cast<float>(uniqueVertices);
+    return stats;
+}
+
+void optimizeVertexCache(std::vector<u32>& indices, u64 vertexCount, u32 cacheSize)
+{
+    u64 triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    TriangleAdjacency adjacency = buildTriangleAdjacency(indices, vertexCount);
+    std::vector<u32> liveTriangles(vertexCount);
+    for (u64 i = 0; i < vertexCount; ++i)
+    {
+        liveTriangles[i] = adjacency.offsets[i + 1] - adjacency.offsets[i];
+    }
+
+    std::vector<u64> timestamps(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<u32> deadEnd; // Recently used vertices, used to continue when the fanning vertex runs out
+    std::vector<u32> candidates;
+    std::vector<u32> result;
+    result.reserve(indices.size());
+
+    u64 time = cacheSize + 1ull;
+    u64 scanVertex = 0;
+    u32 fanVertex = 0;
+    while (fanVertex != NO_VERTEX)
+    {
+        // Emit all remaining triangles around the fanning vertex
+        candidates.clear();
+        for (u32 i = adjacency.offsets[fanVertex]; i < adjacency.offsets[fanVertex + 1]; ++i)
+        {
+            u32 triangle = adjacency.triangles[i];
+            if (emitted[triangle])
+            {
+                continue;
+            }
+            emitted[triangle] = true;
+
+            for (u64 j = 0; j < 3; ++j)
+            {
+                u32 vertex = indices[(triangle * 3ull) + j];
+                result.push_back(vertex);
+                deadEnd.push_back(vertex);
+                candidates.push_back(vertex);
+                --liveTriangles[vertex];
+                if (time - timestamps[vertex] > cacheSize)
+                {
+                    timestamps[vertex] = time++;
+                }
+            }
+        }
+
+        // Next fanning vertex is the candidate that will stay in the cache the longest while its remaining
+        // triangles are emitted
+        fanVertex = NO_VERTEX;
+        u64 bestPriority = 0;
+        for (u32 vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+            {
+                continue;
+            }
+            u64 priority = 1;
+            u64 age = time - timestamps[vertex];
+            if (age + (2ull * liveTriangles[vertex]) <= cacheSize)
+            {
+                priority += age;
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanVertex = vertex;
+            }
+        }
+
+        // Dead end, continue from a recently used vertex or the next vertex with triangles left
+        while (fanVertex == NO_VERTEX && !deadEnd.empty())
+        {
+            u32 vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[vertex] > 0)
+            {
+                fanVertex = vertex;
+            }
+        }
+        for (; fanVertex == NO_VERTEX && scanVertex < vertexCount; ++scanVertex)
+        {
+            if (liveTriangles[scanVertex] > 0)
+            {
+                fanVertex = static_cast<u32>(scanVertex);
+            }
+        }
+    }
+
+    indices = std::move(result);
+}
+
+void optimizeOverdraw(std::vector<u32>& indices, std::span<const vec3> positions, float threshold, u32 cacheSize)
+{
+    u64 triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Cache misses of every triangle in the current order
+    VertexCacheSimulator cache(positions.size(), cacheSize);
+    std::vector<u8> triangleMisses(triangleCount);
+    u64 totalMisses = 0;
+    for (u64 i = 0; i < triangleCount; ++i)
+    {
+        for (u64 j = 0; j < 3; ++j)
+        {
+            triangleMisses[i] += cache.access(indices[(i * 3) + j]) ? 1 : 0;
+        }
+        totalMisses += triangleMisses[i];
+    }
+    float targetAcmr = static_cast<float>(totalMisses) / static_cast<float>(triangleCount) * threshold;
+
+    // Clusters start at hard boundaries, where all vertices missed so the cache was cold anyway, and at soft
+    // boundaries where the cluster so far is within threshold of the cache efficiency of the mesh. Misses are counted
+    // with a cache that is flushed at the start of every cluster, as the clusters will be drawn in another order
+    std::vector<u64> clusterStarts{0};
+    u64 clusterMisses = 0;
+    cache.flush();
+    for (u64 i = 0; i < triangleCount; ++i)
+    {
+        u64 clusterTriangles = i - clusterStarts.back();
+        bool hardBoundary = triangleMisses[i] == 3;
+        bool softBoundary = static_cast<float>(clusterMisses) <= targetAcmr * static_cast<float>(clusterTriangles);
+        if (clusterTriangles > 0 && (hardBoundary || softBoundary))
+        {
+            clusterStarts.push_back(i);
+            clusterMisses = 0;
+            cache.flush();
+        }
+        for (u64 j = 0; j < 3; ++j)
+        {
+            clusterMisses += cache.access(indices[(i * 3) + j]) ? 1 : 0;
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+    u64 clusterCount = clusterStarts.size() - 1;
+
+    // Area weighted center of the mesh
+    vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+    std::vector<vec3> clusterCenters(clusterCount, vec3(0.0f));
+    std::vector<vec3> clusterNormals(clusterCount, vec3(0.0f));
+    for (u64 c = 0; c < clusterCount; ++c)
+    {
+        float clusterArea = 0.0f;
+        for (u64 i = clusterStarts[c]; i < clusterStarts[c + 1]; ++i)
+        {
+            const vec3& p0 = positions[indices[i * 3]];
+            const vec3& p1 = positions[indices[(i * 3) + 1]];
+            const vec3& p2 = positions[indices[(i * 3) + 2]];
+            vec3 normal = math::cross(p1 - p0, p2 - p0); // Length is twice the area
+            float area = math::length(normal);
+            vec3 center = (p0 + p1 + p2) * (area / 3.0f);
+
+            clusterCenters[c] += center;
+            clusterNormals[c] += normal;
+            clusterArea += area;
+            meshCenter += center;
+            meshArea += area;
+        }
+        if (clusterArea > 0.0f)
+        {
+            clusterCenters[c] = clusterCenters[c] * (1.0f / clusterArea);
+        }
+    }
+    if (meshArea > 0.0f)
+    {
+        meshCenter = meshCenter * (1.0f / meshArea);
+    }
+
+    // Clusters facing away from the center are likely to occlude the rest, draw them first
+    std::vector<float> sortKeys(clusterCount);
+    for (u64 c = 0; c < clusterCount; ++c)
+    {
+        float normalLength = math::length(clusterNormals[c]);
+        vec3 normal = normalLength > 0.0f ? clusterNormals[c] * (1.0f / normalLength) : vec3(0.0f);
+        sortKeys[c] = math::dot(clusterCenters[c] - meshCenter, normal);
+    }
+    std::vector<u32> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](u32 lhs, u32 rhs) { return sortKeys[lhs] > sortKeys[rhs]; });
+
+    std::vector<u32> result;
+    result.reserve(indices.size());
+    for (u32 c : order)
+    {
+        result.insert(result.end(), indices.begin() + static_cast<i64>(clusterStarts[c] * 3),
+                      indices.begin() + static_cast<i64>(clusterStarts[c + 1] * 3));
+    }
+    indices = std::move(result);
+}
+
+void optimizeVertexFetch(MeshData& meshData)
+{
+    u64 vertexCount = meshData.positions.size();
+    std::vector<u32> remap(vertexCount, NO_VERTEX);
+    u32 nextVertex = 0;
+    for (u32& index : meshData.indices)
+    {
+        if (remap[index] == NO_VERTEX)
+        {
+            remap[index] = nextVertex++;
+        }
+        index = remap[index];
+    }
+    for (u32& vertex : remap)
+    {
+        if (vertex == NO_VERTEX)
+        {
+            vertex = nextVertex++;
+        }
+    }
+
+    auto reorder = [&](auto& attributes) {
+        if (attributes.size() != vertexCount)
+        {
+            return;
+        }
+        std::remove_reference_t<decltype(attributes)> reordered(vertexCount);
+        for (u64 i = 0; i < vertexCount; ++i)
+        {
+            reordered[remap[i]] = attributes[i];
+        }
+        attributes = std::move(reordered);
+    };
+    reorder(meshData.positions);
+    reorder(meshData.uvs);
+    reorder(meshData.normals);
+    reorder(meshData.tangents);
+    for (u32& index : meshData.lodIndices)
+    {
+        index = remap[index];
+    }
+    for (u32& vertex : meshData.meshletVertices)
+    {
+        vertex = remap[vertex];
+    }
+}
+
+MeshOptimizationReport optimizeMesh(MeshData& meshData)
+{
+    MeshOptimizationReport report;
+    u64 vertexCount = meshData.positions.size();
+    if (std::ranges::any_of(meshData.indices, [&](u32 index) { return index >= vertexCount; }))
+    {
+        log(LogLevel::WARNING, "optimizeMesh(): {} has indices out of bounds", meshData.name.c_str());
+        return report;
+    }
+
+    report.before = analyzeVertexCache(meshData.indices, vertexCount);
+
+    optimizeVertexCache(meshData.indices, vertexCount);
+    optimizeOverdraw(meshData.indices, meshData.positions);
+    for (const MeshLod& lod : meshData.lods)
+    {
+        auto begin = meshData.lodIndices.begin() + lod.indexOffset;
+        std::vector<u32> lodIndices(begin, begin + lod.indexCount);
+        optimizeVertexCache(lodIndices, vertexCount);
+        std::ranges::copy(lodIndices, begin);
+    }
+    optimizeVertexFetch(meshData);
+
+    report.after = analyzeVertexCache(meshData.indices, vertexCount);
+    return report;
+}
+
+} // namespace huedra
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "core/types.hpp"
+#include "resources/mesh/data.hpp"
+
+#include <span>
+
+namespace huedra {
+
+// Size of the simulated post-transform vertex cache, a fifo of this size is a reasonable model for most gpus
+constexpr u32 VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats
+{
+    float acmr{0.0f}; // Average cache miss ratio, transformed vertices per triangle (0.5 - 3.0, lower is better)
+    float atvr{0.0f}; // Average transformed vertex ratio, transformed per referenced vertex (1.0 is optimal)
+};
+
+struct MeshOptimizationReport
+{
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+// Simulates a fifo vertex cache over a triangle list, the stats are zero when there are no triangles
+VertexCacheStats analyzeVertexCache(std::span<const u32> indices, u64 vertexCount,
+                                    u32 cacheSize = VERTEX_CACHE_SIZE);
+
+// Reorders triangles for vertex cache hits using Tipsify (Sander et al. 2007), runs in linear time
+void optimizeVertexCache(std::vector<u32>& indices, u64 vertexCount, u32 cacheSize = VERTEX_CACHE_SIZE);
+
+// Reorders clusters of triangles from a vertex cache optimized index buffer so that triangles facing outwards from
+// the center of the mesh are drawn first, which reduces overdraw from any view direction. Clusters are split where
+// the cache is cold anyway and where the cache miss ratio of the cluster is within threshold of the whole mesh, so
+// the vertex cache efficiency is kept mostly intact
+void optimizeOverdraw(std::vector<u32>& indices, std::span<const vec3> positions, float threshold = 1.05f,
+                      u32 cacheSize = VERTEX_CACHE_SIZE);
+
+// Reorders the vertices in order of first use by the indices, so vertex fetches walk memory linearly. Unreferenced
+// vertices are moved to the end. Lod indices and meshlet vertices are remapped as well
+void optimizeVertexFetch(MeshData& meshData);
+
+// Runs the vertex cache, overdraw and vertex fetch optimizations on the mesh, lods are only optimized for the vertex
+// cache and the report only covers the full mesh
+MeshOptimizationReport optimizeMesh(MeshData& meshData);
+
+} // namespace huedra
@@ -0,0 +1,645 @@
+#include "simplifier.hpp"
+#include "core/log.hpp"
+#include "math/vec_transform.hpp"
+#include "resources/mesh/vertex_welder.hpp"
+
+#include <cmath>
+#include <numeric>
+
+namespace huedra {
+
+namespace {
+
+constexpr u32 NO_VERTEX = ~0u;
+constexpr u64 QUADRIC_SIZE = 8; // Position, uv and normal
+constexpr u64 QUADRIC_MATRIX_SIZE = (QUADRIC_SIZE * (QUADRIC_SIZE + 1)) / 2;
+constexpr float BORDER_WEIGHT = 10.0f; // Weight of the planes keeping borders and seams in place
+constexpr float FLIP_THRESHOLD = 0.5f; // Smallest cosine between the normals of a triangle before and after a collapse
+
+using QuadricVector = std::array<float, QUADRIC_SIZE>;
+
+float dot(const QuadricVector& lhs, const QuadricVector& rhs)
+{
+    float result = 0.0f;
+    for (u64 i = 0; i < QUADRIC_SIZE; ++i)
+    {
+        result += lhs[i] * rhs[i];
+    }
+    return result;
+}
+
+// Weighted sum of squared distances to a set of planes, error(v) = v^T * A * v + 2 * b^T * v + c. Evaluates to the
+// weighted average so that the error is a squared distance
+struct Quadric
+{
+    std::array<float, QUADRIC_MATRIX_SIZE> a{}; // Upper triangle of the symmetric matrix, row major
+    QuadricVector b{};
+    float c{0.0f};
+    float weight{0.0f};
+
+    Quadric& operator+=(const Quadric& rhs)
+    {
+        for (u64 i = 0; i < a.size(); ++i)
+        {
+            a[i] += rhs.a[i];
+        }
+        for (u64 i = 0; i < QUADRIC_SIZE; ++i)
+        {
+            b[i] += rhs.b[i];
+        }
+        c += rhs.c;
+        weight += rhs.weight;
+        return *this;
+    }
+
+    float evaluate(const QuadricVector& v) const
+    {
+        float error = c;
+        u64 k = 0;
+        for (u64 i = 0; i < QUADRIC_SIZE; ++i)
+        {
+            float row = a[k++] * v[i];
+            for (u64 j = i + 1; j < QUADRIC_SIZE; ++j)
+            {
+                row += 2.0f * a[k++] * v[j];
+            }
+            error += v[i] * (row + (2.0f * b[i]));
+        }
+        return weight > 0.0f ? std::max(error, 0.0f) / weight : 0.0f;
+    }
+};
+
+// Generalized quadric of a triangle in n dimensions (Garland and Heckbert 1998), the distance to the plane spanned by
+// the orthonormal basis e1, e2 through p0 is |v - p0|^2 - ((v - p0) . e1)^2 - ((v - p0) . e2)^2
+Quadric triangleQuadric(const QuadricVector& p0, const QuadricVector& p1, const QuadricVector& p2, float weight)
+{
+    QuadricVector e1{};
+    QuadricVector e2{};
+    for (u64 i = 0; i < QUADRIC_SIZE; ++i)
+    {
+        e1[i] = p1[i] - p0[i];
+        e2[i] = p2[i] - p0[i];
+    }
+    float e1Length = std::sqrt(dot(e1, e1));
+    if (e1Length <= 0.0f)
+    {
+        return {};
+    }
+    for (float& value : e1)
+    {
+        value /= e1Length;
+    }
+    float projection = dot(e1, e2);
+    for (u64 i = 0; i < QUADRIC_SIZE; ++i)
+    {
+        e2[i] -= projection * e1[i];
+    }
+    float e2Length = std::sqrt(dot(e2, e2));
+    if (e2Length <= 0.0f)
+    {
+        return {};
+    }
+    for (float& value : e2)
+    {
+        value /= e2Length;
+    }
+
+    Quadric quadric;
+    float d1 = dot(p0, e1);
+    float d2 = dot(p0, e2);
+    u64 k = 0;
+    for (u64 i = 0; i < QUADRIC_SIZE; ++i)
+    {
+        for (u64 j = i; j < QUADRIC_SIZE; ++j)
+        {
+            quadric.a[k++] = ((i == j ? 1.0f : 0.0f) - (e1[i] * e1[j]) - (e2[i] * e2[j])) * weight;
+        }
+        quadric.b[i] = ((d1 * e1[i]) + (d2 * e2[i]) - p0[i]) * weight;
+    }
+    quadric.c = (dot(p0, p0) - (d1 * d1) - (d2 * d2)) * weight;
+    quadric.weight = weight;
+    return quadric;
+}
+
+// Quadric of the plane normal . x + distance = 0 over the position only
+Quadric planeQuadric(const vec3& normal, float distance, float weight)
+{
+    Quadric quadric;
+    u64 k = 0;
+    for (u64 i = 0; i < QUADRIC_SIZE; ++i)
+    {
+        for (u64 j = i; j < QUADRIC_SIZE; ++j)
+        {
+            quadric.a[k++] = i < 3 && j < 3 ? normal[i] * normal[j] * weight : 0.0f;
+        }
+        quadric.b[i] = i < 3 ? distance * normal[i] * weight : 0.0f;
+    }
+    quadric.c = distance * distance * weight;
+    quadric.weight = weight;
+    return quadric;
+}
+
+// Directed edges leaving every vertex, laid out as offsets into one array
+struct EdgeAdjacency
+{
+    std::vector<u32> offsets; // vertexCount + 1
+    std::vector<u32> targets;
+
+    bool contains(u32 from, u32 to) const
+    {
+        return std::find(targets.begin() + offsets[from], targets.begin() + offsets[from + 1], to) !=
+               targets.begin() + offsets[from + 1];
+    }
+};
+
+EdgeAdjacency buildEdgeAdjacency(std::span<const u32> indices, std::span<const u32> ids, u64 idCount)
+{
+    EdgeAdjacency adjacency;
+    adjacency.offsets.assign(idCount + 1, 0);
+    for (u32 index : indices)
+    {
+        ++adjacency.offsets[ids[index] + 1];
+    }
+    std::partial_sum(adjacency.offsets.begin(), adjacency.offsets.end(), adjacency.offsets.begin());
+
+    std::vector<u32> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    adjacency.targets.resize(indices.size());
+    for (u64 i = 0; i < indices.size(); i += 3)
+    {
+        for (u64 j = 0; j < 3; ++j)
+        {
+            adjacency.targets[fill[ids[indices[i + j]]]++] = ids[indices[i + ((j + 1) % 3)]];
+        }
+    }
+    return adjacency;
+}
+
+enum class VertexKind : u8
+{
+    MANIFOLD, // Collapses to any neighbour
+    BORDER,   // On an open border, collapses along the border
+    SEAM,     // Shares its position with exactly one other vertex, both collapse along the seam together
+    LOCKED
+};
+
+// Minimum corner and largest side of the bounds
+std::pair<vec3, float> computeExtent(std::span<const vec3> positions)
+{
+    if (positions.empty())
+    {
+        return {vec3(0.0f), 0.0f};
+    }
+    vec3 minPosition = positions[0];
+    vec3 maxPosition = positions[0];
+    for (const vec3& position : positions)
+    {
+        for (u64 j = 0; j < 3; ++j)
+        {
+            minPosition[j] = std::min(minPosition[j], position[j]);
+            maxPosition[j] = std::max(maxPosition[j], position[j]);
+        }
+    }
+    vec3 size = maxPosition - minPosition;
+    return {minPosition, std::max({size.x, size.y, size.z})};
+}
+
+struct Collapse
+{
+    u32 vertex;
+    u32 target;
+    float error;
+};
+
+} // namespace
+
+SimplifiedMesh simplifyMesh(const MeshData& meshData, std::span<const u32> indices, u64 targetIndexCount,
+                            float targetError, const SimplifyOptions& options)
+{
+    SimplifiedMesh result;
+    result.indices.assign(indices.begin(), indices.begin() + static_cast<i64>((indices.size() / 3) * 3));
+
+    const std::vector<vec3>& positions = meshData.positions;
+    u64 vertexCount = positions.size();
+    if (result.indices.size() <= targetIndexCount)
+    {
+        return result;
+    }
+    if (std::ranges::any_of(result.indices, [&](u32 index) { return index >= vertexCount; }))
+    {
+        log(LogLevel::WARNING, "simplifyMesh(): {} has indices out of bounds", meshData.name.c_str());
+        return result;
+    }
+
+    // Positions are normalized to the unit cube so that the error is relative to the extent of the mesh
+    auto [minPosition, extent] = computeExtent(positions);
+    if (extent <= 0.0f)
+    {
+        return result;
+    }
+
+    bool hasUvs = options.uvWeight > 0.0f && meshData.uvs.size() == vertexCount;
+    bool hasNormals = options.normalWeight > 0.0f && meshData.normals.size() == vertexCount;
+    std::vector<QuadricVector> attributes(vertexCount);
+    for (u64 i = 0; i < vertexCount; ++i)
+    {
+        QuadricVector& attribute = attributes[i];
+        for (u64 j = 0; j < 3; ++j)
+        {
+            attribute[j] = (positions[i][j] - minPosition[j]) / extent;
+        }
+        for (u64 j = 0; hasUvs && j < 2; ++j)
+        {
+            attribute[3 + j] = meshData.uvs[i][j] * options.uvWeight;
+        }
+        for (u64 j = 0; hasNormals && j < 3; ++j)
+        {
+            attribute[5 + j] = meshData.normals[i][j] * options.normalWeight;
+        }
+    }
+    auto position = [&](u32 vertex) {
+        return vec3(attributes[vertex][0], attributes[vertex][1], attributes[vertex][2]);
+    };
+
+    // Referenced vertices with the same position are wedges of one position, linked in a circular list
+    std::vector<bool> referenced(vertexCount, false);
+    for (u32 index : result.indices)
+    {
+        referenced[index] = true;
+    }
+    VertexWelder welder(sizeof(vec3), vertexCount);
+    std::vector<u32> positionIds(vertexCount, 0);
+    std::vector<u32> wedges(vertexCount);
+    std::vector<u32> firstWedges;
+    std::vector<u32> wedgeCounts;
+    std::iota(wedges.begin(), wedges.end(), 0);
+    for (u64 i = 0; i < vertexCount; ++i)
+    {
+        if (!referenced[i])
+        {
+            continue;
+        }
+        vec3 key = positions[i] + vec3(0.0f); // -0.0 + 0.0 is 0.0
+        auto [id, added] = welder.insert(key);
+        positionIds[i] = id;
+        if (added)
+        {
+            firstWedges.push_back(static_cast<u32>(i));
+            wedgeCounts.push_back(1);
+            continue;
+        }
+        u32 first = firstWedges[id];
+        wedges[i] = wedges[first];
+        wedges[first] = static_cast<u32>(i);
+        ++wedgeCounts[id];
+    }
+
+    // Edges without an opposite edge are open, in the index topology these are borders and seams while in the position
+    // topology only borders are open. Vertices on edges used more than once in the same direction are non manifold
+    std::vector<u32> identityIds(vertexCount);
+    std::iota(identityIds.begin(), identityIds.end(), 0);
+    EdgeAdjacency vertexEdges = buildEdgeAdjacency(result.indices, identityIds, vertexCount);
+    EdgeAdjacency positionEdges = buildEdgeAdjacency(result.indices, positionIds, welder.size());
+    std::vector<u8> openOut(vertexCount, 0);
+    std::vector<u8> openIn(vertexCount, 0);
+    std::vector<bool> positionOpen(welder.size(), false);
+    std::vector<bool> nonManifold(vertexCount, false);
+    std::vector<Quadric> quadrics(vertexCount);
+    for (u64 i = 0; i < result.indices.size(); i += 3)
+    {
+        u32 v0 = result.indices[i];
+        u32 v1 = result.indices[i + 1];
+        u32 v2 = result.indices[i + 2];
+        vec3 normal = math::cross(position(v1) - position(v0), position(v2) - position(v0));
+        float area = math::length(normal) * 0.5f;
+        Quadric quadric = triangleQuadric(attributes[v0], attributes[v1], attributes[v2], area);
+        quadrics[v0] += quadric;
+        quadrics[v1] += quadric;
+        quadrics[v2] += quadric;
+
+        for (u64 j = 0; j < 3; ++j)
+        {
+            u32 from = result.indices[i + j];
+            u32 to = result.indices[i + ((j + 1) % 3)];
+            auto begin = vertexEdges.targets.begin() + vertexEdges.offsets[from];
+            auto end = vertexEdges.targets.begin() + vertexEdges.offsets[from + 1];
+            if (std::count(begin, end, to) > 1)
+            {
+                nonManifold[from] = true;
+                nonManifold[to] = true;
+            }
+            if (!positionEdges.contains(positionIds[to], positionIds[from]))
+            {
+                positionOpen[positionIds[from]] = true;
+            }
+            if (vertexEdges.contains(to, from))
+            {
+                continue;
+            }
+
+            openOut[from] = static_cast<u8>(std::min(openOut[from] + 1, 2));
+            openIn[to] = static_cast<u8>(std::min(openIn[to] + 1, 2));
+
+            // Plane through the edge perpendicular to the triangle, keeps the border or seam from moving
+            vec3 edge = position(to) - position(from);
+            vec3 planeNormal = math::cross(edge, normal);
+            float planeLength = math::length(planeNormal);
+            if (planeLength > 0.0f)
+            {
+                planeNormal = planeNormal * (1.0f / planeLength);
+                Quadric border = planeQuadric(planeNormal, -math::dot(planeNormal, position(from)),
+                                              BORDER_WEIGHT * math::dot(edge, edge));
+                quadrics[from] += border;
+                quadrics[to] += border;
+            }
+        }
+    }
+
+    std::vector<VertexKind> kinds(vertexCount, VertexKind::LOCKED);
+    auto hasSingleLoop = [&](u32 vertex) { return openOut[vertex] == 1 && openIn[vertex] == 1; };
+    for (u64 i = 0; i < vertexCount; ++i)
+    {
+        u32 vertex = static_cast<u32>(i);
+        u32 id = positionIds[i];
+        if (!referenced[i] || nonManifold[i])
+        {
+            continue;
+        }
+        if (wedgeCounts[id] == 1 && openOut[i] == 0 && openIn[i] == 0)
+        {
+            kinds[i] = VertexKind::MANIFOLD;
+        }
+        else if (wedgeCounts[id] == 1 && hasSingleLoop(vertex) && positionOpen[id] && !options.lockBorder)
+        {
+            kinds[i] = VertexKind::BORDER;
+        }
+        else if (wedgeCounts[id] == 2 && hasSingleLoop(vertex) && hasSingleLoop(wedges[i]) && !positionOpen[id] &&
+                 !nonManifold[wedges[i]])
+        {
+            kinds[i] = VertexKind::SEAM;
+        }
+    }
+
+    std::vector<u32> loop(vertexCount);
+    std::vector<u32> loopback(vertexCount);
+    std::vector<u32> triangleOffsets(vertexCount + 1);
+    std::vector<u32> vertexTriangles;
+    std::vector<u32> bestTargets(vertexCount);
+    std::vector<float> bestErrors(vertexCount);
+    std::vector<Collapse> collapses;
+    std::vector<u32> remap(vertexCount);
+    std::vector<bool> collapseLocked(vertexCount);
+
+    // Target of the seam partner of vertex when vertex collapses to target along its seam
+    auto seamTarget = [&](u32 vertex, u32 target) {
+        u32 wedge = wedges[vertex];
+        u32 wedgeTarget = target == loop[vertex] ? loopback[wedge] : loop[wedge];
+        return wedgeTarget != NO_VERTEX && positionIds[wedgeTarget] == positionIds[target] ? wedgeTarget : NO_VERTEX;
+    };
+
+    auto canCollapse = [&](u32 vertex, u32 target) {
+        switch (kinds[vertex])
+        {
+        case VertexKind::MANIFOLD:
+            return true;
+        case VertexKind::BORDER:
+            return (target == loop[vertex] || target == loopback[vertex]) &&
+                   (kinds[target] == VertexKind::BORDER || kinds[target] == VertexKind::LOCKED);
+        case VertexKind::SEAM:
+            return (target == loop[vertex] || target == loopback[vertex]) &&
+                   (kinds[target] == VertexKind::SEAM || kinds[target] == VertexKind::LOCKED) &&
+                   seamTarget(vertex, target) != NO_VERTEX;
+        default:
+            return false;
+        }
+    };
+
+    // True if moving vertex onto target turns any of the remaining triangles around it over. Triangles are remapped
+    // with the collapses done so far in the pass
+    auto flipsTriangles = [&](u32 vertex, u32 target) {
+        for (u32 i = triangleOffsets[vertex]; i < triangleOffsets[vertex + 1]; ++i)
+        {
+            const u32* triangle = &result.indices[vertexTriangles[i] * 3ull];
+            std::array<u32, 3> corners{remap[triangle[0]], remap[triangle[1]], remap[triangle[2]]};
+            if (corners[0] == target || corners[1] == target || corners[2] == target || corners[0] == corners[1] ||
+                corners[1] == corners[2] || corners[0] == corners[2])
+            {
+                continue;
+            }
+            vec3 before = math::cross(position(corners[1]) - position(corners[0]),
+                                      position(corners[2]) - position(corners[0]));
+            for (u32& corner : corners)
+            {
+                corner = corner == vertex ? target : corner;
+            }
+            vec3 after = math::cross(position(corners[1]) - position(corners[0]),
+                                     position(corners[2]) - position(corners[0]));
+            if (math::dot(before, after) <= FLIP_THRESHOLD * math::length(before) * math::length(after))
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    float errorLimit = targetError * targetError;
+    float maxError = 0.0f;
+    u64 indexCount = result.indices.size();
+    while (indexCount > targetIndexCount)
+    {
+        // Open edges and triangle adjacency of the current indices
+        vertexEdges = buildEdgeAdjacency(result.indices, identityIds, vertexCount);
+        std::fill(loop.begin(), loop.end(), NO_VERTEX);
+        std::fill(loopback.begin(), loopback.end(), NO_VERTEX);
+        std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+        for (u64 i = 0; i < indexCount; i += 3)
+        {
+            for (u64 j = 0; j < 3; ++j)
+            {
+                u32 from = result.indices[i + j];
+                u32 to = result.indices[i + ((j + 1) % 3)];
+                if (!vertexEdges.contains(to, from))
+                {
+                    loop[from] = to;
+                    loopback[to] = from;
+                }
+                ++triangleOffsets[from + 1];
+            }
+        }
+        std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+        std::vector<u32> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+        vertexTriangles.resize(indexCount);
+        for (u64 i = 0; i < indexCount; ++i)
+        {
+            vertexTriangles[fill[result.indices[i]]++] = static_cast<u32>(i / 3);
+        }
+
+        // Cheapest collapse of every vertex
+        std::fill(bestTargets.begin(), bestTargets.end(), NO_VERTEX);
+        std::fill(bestErrors.begin(), bestErrors.end(), std::numeric_limits<float>::max());
+        for (u64 i = 0; i < indexCount; i += 3)
+        {
+            for (u64 j = 0; j < 6; ++j)
+            {
+                u32 vertex = result.indices[i + (j % 3)];
+                u32 target = result.indices[i + ((j + 1 + (j / 3)) % 3)]; // Next corner, then previous corner
+                if (!canCollapse(vertex, target))
+                {
+                    continue;
+                }
+                float error = quadrics[vertex].evaluate(attributes[target]);
+                if (kinds[vertex] == VertexKind::SEAM)
+                {
+                    error += quadrics[wedges[vertex]].evaluate(attributes[seamTarget(vertex, target)]);
+                }
+                if (error < bestErrors[vertex])
+                {
+                    bestTargets[vertex] = target;
+                    bestErrors[vertex] = error;
+                }
+            }
+        }
+        collapses.clear();
+        for (u64 i = 0; i < vertexCount; ++i)
+        {
+            if (bestTargets[i] != NO_VERTEX && bestErrors[i] <= errorLimit)
+            {
+                collapses.push_back({static_cast<u32>(i), bestTargets[i], bestErrors[i]});
+            }
+        }
+        std::ranges::sort(collapses, [](const Collapse& lhs, const Collapse& rhs) { return lhs.error < rhs.error; });
+
+        // Collapse in order of error, both ends of a collapse are locked for the rest of the pass so that every vertex
+        // is remapped at most once
+        std::iota(remap.begin(), remap.end(), 0);
+        std::fill(collapseLocked.begin(), collapseLocked.end(), false);
+        u64 collapseCount = 0;
+        for (const Collapse& collapse : collapses)
+        {
+            if (indexCount <= targetIndexCount)
+            {
+                break;
+            }
+
+            std::array<u32, 2> vertices{collapse.vertex, NO_VERTEX};
+            std::array<u32, 2> targets{collapse.target, NO_VERTEX};
+            if (kinds[collapse.vertex] == VertexKind::SEAM)
+            {
+                vertices[1] = wedges[collapse.vertex];
+                targets[1] = seamTarget(collapse.vertex, collapse.target);
+            }
+            u64 pairs = vertices[1] == NO_VERTEX ? 1 : 2;
+            bool valid = true;
+            for (u64 i = 0; i < pairs && valid; ++i)
+            {
+                valid = !collapseLocked[vertices[i]] && !collapseLocked[targets[i]] &&
+                        !flipsTriangles(vertices[i], targets[i]);
+            }
+            if (!valid)
+            {
+                continue;
+            }
+
+            for (u64 i = 0; i < pairs; ++i)
+            {
+                for (u32 j = triangleOffsets[vertices[i]]; j < triangleOffsets[vertices[i] + 1]; ++j)
+                {
+                    const u32* triangle = &result.indices[vertexTriangles[j] * 3ull];
+                    if (remap[triangle[0]] == targets[i] || remap[triangle[1]] == targets[i] ||
+                        remap[triangle[2]] == targets[i])
+                    {
+                        indexCount -= 3;
+                    }
+                }
+                remap[vertices[i]] = targets[i];
+                quadrics[targets[i]] += quadrics[vertices[i]];
+                collapseLocked[vertices[i]] = true;
+                collapseLocked[targets[i]] = true;
+            }
+            maxError = std::max(maxError, collapse.error);
+            ++collapseCount;
+        }
+        if (collapseCount == 0)
+        {
+            break;
+        }
+
+        u64 written = 0;
+        for (u64 i = 0; i < result.indices.size(); i += 3)
+        {
+            u32 v0 = remap[result.indices[i]];
+            u32 v1 = remap[result.indices[i + 1]];
+            u32 v2 = remap[result.indices[i + 2]];
+            if (v0 != v1 && v1 != v2 && v0 != v2)
+            {
+                result.indices[written++] = v0;
+                result.indices[written++] = v1;
+                result.indices[written++] = v2;
+            }
+        }
+        result.indices.resize(written);
+        indexCount = written;
+    }
+
+    result.error = std::sqrt(maxError) * extent;
+    return result;
+}
+
+void buildMeshLods(MeshData& meshData, const MeshLodSettings& settings)
+{
+    meshData.lods.clear();
+    meshData.lodIndices.clear();
+
+    float extent = computeExtent(meshData.positions).second;
+    std::span<const u32> indices = meshData.indices;
+    float error = 0.0f;
+    for (u32 level = 0; level < settings.lodCount; ++level)
+    {
+        // The error limit of the level is what is left after the error of the previous levels
+        u64 targetIndexCount = (static_cast<u64>(static_cast<float>(indices.size()) * settings.ratio) / 3) * 3;
+        float targetError = settings.maxError - (error / extent);
+        if (extent <= 0.0f || targetError <= 0.0f)
+        {
+            break;
+        }
+        SimplifiedMesh simplified = simplifyMesh(meshData, indices, targetIndexCount, targetError, settings.options);
+
+        // Less than 5% fewer indices, the error limit or the locked vertices stop any further simplification
+        if (simplified.indices.empty() || simplified.indices.size() * 20 > indices.size() * 19)
+        {
+            break;
+        }
+
+        MeshLod& lod = meshData.lods.emplace_back();
+        lod.indexOffset = static_cast<u32>(meshData.lodIndices.size());
+        lod.indexCount = static_cast<u32>(simplified.indices.size());
+        lod.error = error + simplified.error;
+        meshData.lodIndices.insert(meshData.lodIndices.end(), simplified.indices.begin(), simplified.indices.end());
+
+        indices = std::span(meshData.lodIndices).subspan(lod.indexOffset, lod.indexCount);
+        error = lod.error;
+    }
+}
+
+float getLodScreenError(float error, float distance, float projectionScale)
+{
+    if (distance <= 0.0f)
+    {
+        return std::numeric_limits<float>::max();
+    }
+    return error * projectionScale / distance;
+}
+
+u32 selectMeshLod(const MeshData& meshData, float distance, float projectionScale, float maxScreenError)
+{
+    u32 level = 0;
+    for (u64 i = 0; i < meshData.lods.size(); ++i)
+    {
+        if (getLodScreenError(meshData.lods[i].error, distance, projectionScale) <= maxScreenError)
+        {
+            level = static_cast<u32>(i + 1);
+        }
+    }
+    return level;
+}
+
+} // namespace huedra
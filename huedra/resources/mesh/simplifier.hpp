@@ -0,0 +1,53 @@
+#pragma once
+
+#include "core/types.hpp"
+#include "resources/mesh/data.hpp"
+
+#include <span>
+
+namespace huedra {
+
+struct SimplifyOptions
+{
+    float uvWeight{0.5f};     // Importance of uv distortion compared to geometric error, 0 ignores uvs
+    float normalWeight{0.5f}; // Importance of normal distortion compared to geometric error, 0 ignores normals
+    bool lockBorder{false};   // Keeps the vertices on open borders, e.g. where the mesh connects to other meshes
+};
+
+struct SimplifiedMesh
+{
+    std::vector<u32> indices;
+    float error{0.0f}; // Object space deviation from the input
+};
+
+struct MeshLodSettings
+{
+    u32 lodCount{0};       // Levels to generate in addition to the full mesh, 0 disables lod generation
+    float ratio{0.5f};     // Index count of every level compared to the previous one
+    float maxError{0.05f}; // Relative to the extent of the mesh, no level exceeds this
+    SimplifyOptions options;
+};
+
+// Simplifies the triangles by collapsing edges in order of quadric error (Garland and Heckbert 1998, using the
+// generalized quadrics over position, uv and normal). Vertices are not moved and the result indexes into the same
+// vertices, so every level can share one vertex buffer. Vertices on uv or normal seams only collapse along their seam
+// and open borders only along the border, complex vertices are never collapsed.
+// Stops when the index count is at or below targetIndexCount or when the next collapse would exceed targetError,
+// which is relative to the extent of the mesh
+SimplifiedMesh simplifyMesh(const MeshData& meshData, std::span<const u32> indices, u64 targetIndexCount,
+                            float targetError, const SimplifyOptions& options = {});
+
+// Fills the lod chain of the mesh data. Every level is simplified from the previous one and its error is the sum of
+// the errors so far, which bounds the deviation from the full mesh. Generation stops early when a level could not be
+// reduced any further within the error limit
+void buildMeshLods(MeshData& meshData, const MeshLodSettings& settings);
+
+// Projected size of an object space error in pixels. projectionScale is screenHeight / (2 * tan(fovY / 2)) for a
+// perspective projection, distance is the object space distance from the camera to the mesh
+float getLodScreenError(float error, float distance, float projectionScale);
+
+// Coarsest level with a projected error of at most maxScreenError pixels, 0 is the full mesh and level i > 0 is
+// meshData.lods[i - 1]
+u32 selectMeshLod(const MeshData& meshData, float distance, float projectionScale, float maxScreenError = 1.0f);
+
+} // namespace huedra
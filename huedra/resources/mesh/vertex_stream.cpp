@@ -0,0 +1,144 @@
+#include "vertex_stream.hpp"
+#include "math/vec_transform.hpp"
+
+#include <cmath>
+
+namespace huedra {
+
+namespace {
+
+constexpr float UNORM16_MAX = 65535.0f;
+constexpr float NORM16_MAX = 32767.0f;
+
+u16 quantizeUnorm16(float value, float offset, float invScale)
+{
+    return static_cast<u16>(std::clamp(std::round((value - offset) * invScale), 0.0f, UNORM16_MAX));
+}
+
+i16 quantizeNorm16(float value) { return static_cast<i16>(std::round(std::clamp(value, -1.0f, 1.0f) * NORM16_MAX)); }
+
+float signNotZero(float value) { return value >= 0.0f ? 1.0f : -1.0f; }
+
+} // namespace
+
+QuantizedVertexStream buildQuantizedVertexStream(const MeshData& meshData)
+{
+    QuantizedVertexStream stream;
+    u64 vertexCount = meshData.positions.size();
+    if (vertexCount == 0)
+    {
+        return stream;
+    }
+
+    bool hasUvs = meshData.uvs.size() == vertexCount;
+    bool hasNormals = meshData.normals.size() == vertexCount;
+
+    vec3 minPosition = meshData.positions[0];
+    vec3 maxPosition = meshData.positions[0];
+    vec2 minUv = hasUvs ? meshData.uvs[0] : vec2(0.0f);
+    vec2 maxUv = minUv;
+    for (u64 i = 0; i < vertexCount; ++i)
+    {
+        for (u64 j = 0; j < 3; ++j)
+        {
+            minPosition[j] = std::min(minPosition[j], meshData.positions[i][j]);
+            maxPosition[j] = std::max(maxPosition[j], meshData.positions[i][j]);
+        }
+        if (hasUvs)
+        {
+            for (u64 j = 0; j < 2; ++j)
+            {
+                minUv[j] = std::min(minUv[j], meshData.uvs[i][j]);
+                maxUv[j] = std::max(maxUv[j], meshData.uvs[i][j]);
+            }
+        }
+    }
+
+    // A flat axis gets a scale of 0, every vertex then decodes to the offset
+    vec3 positionInvScale(0.0f);
+    vec2 uvInvScale(0.0f);
+    VertexDequantization& dequantization = stream.dequantization;
+    for (u64 j = 0; j < 3; ++j)
+    {
+        float extent = maxPosition[j] - minPosition[j];
+        dequantization.positionScale[j] = extent / UNORM16_MAX;
+        dequantization.positionOffset[j] = minPosition[j];
+        positionInvScale[j] = extent > 0.0f ? UNORM16_MAX / extent : 0.0f;
+    }
+    for (u64 j = 0; j < 2; ++j)
+    {
+        float extent = maxUv[j] - minUv[j];
+        dequantization.uvScale[j] = extent / UNORM16_MAX;
+        dequantization.uvOffset[j] = minUv[j];
+        uvInvScale[j] = extent > 0.0f ? UNORM16_MAX / extent : 0.0f;
+    }
+
+    stream.vertices.resize(vertexCount);
+    for (u64 i = 0; i < vertexCount; ++i)
+    {
+        QuantizedVertex& vertex = stream.vertices[i];
+        for (u64 j = 0; j < 3; ++j)
+        {
+            vertex.position[j] = quantizeUnorm16(meshData.positions[i][j], minPosition[j], positionInvScale[j]);
+        }
+        if (hasUvs)
+        {
+            for (u64 j = 0; j < 2; ++j)
+            {
+                vertex.uv[j] = quantizeUnorm16(meshData.uvs[i][j], minUv[j], uvInvScale[j]);
+            }
+        }
+        if (hasNormals)
+        {
+            vertex.normal = encodeOctahedralNormal(meshData.normals[i]);
+        }
+    }
+
+    return stream;
+}
+
+VertexInputStream getQuantizedVertexInputStream()
+{
+    return {.size = sizeof(QuantizedVertex),
+            .inputRate = VertexInputRate::VERTEX,
+            .attributes{
+                {.format = GraphicsDataFormat::RGBA_16_UNORM,
+                 .offset = static_cast<u32>(offsetof(QuantizedVertex, position))},
+                {.format = GraphicsDataFormat::RG_16_UNORM, .offset = static_cast<u32>(offsetof(QuantizedVertex, uv))},
+                {.format = GraphicsDataFormat::RG_16_NORM,
+                 .offset = static_cast<u32>(offsetof(QuantizedVertex, normal))},
+            }};
+}
+
+std::array<i16, 2> encodeOctahedralNormal(const vec3& normal)
+{
+    float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (sum == 0.0f)
+    {
+        return {0, 0};
+    }
+
+    float x = normal.x / sum;
+    float y = normal.y / sum;
+    if (normal.z < 0.0f)
+    {
+        float foldedX = (1.0f - std::abs(y)) * signNotZero(x);
+        y = (1.0f - std::abs(x)) * signNotZero(y);
+        x = foldedX;
+    }
+    return {quantizeNorm16(x), quantizeNorm16(y)};
+}
+
+vec3 decodeOctahedralNormal(const std::array<i16, 2>& encoded)
+{
+    // -32768 and -32767 both map to -1, same as the snorm conversion on the gpu
+    float x = std::max(static_cast<float>(encoded[0]) / NORM16_MAX, -1.0f);
+    float y = std::max(static_cast<float>(encoded[1]) / NORM16_MAX, -1.0f);
+    vec3 normal(x, y, 1.0f - std::abs(x) - std::abs(y));
+    float t = std::max(-normal.z, 0.0f);
+    normal.x += normal.x >= 0.0f ? -t : t;
+    normal.y += normal.y >= 0.0f ? -t : t;
+    return math::normalize(normal);
+}
+
+} // namespace huedra
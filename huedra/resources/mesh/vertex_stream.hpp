@@ -0,0 +1,49 @@
+#pragma once
+
+#include "core/types.hpp"
+#include "graphics/pipeline_data.hpp"
+#include "math/vec4.hpp"
+#include "resources/mesh/data.hpp"
+
+namespace huedra {
+
+// Interleaved vertex with quantized attributes, 16 bytes compared to the 32 bytes of float attributes in MeshData:
+//     position: RGBA_16_UNORM, normalized over the bounds of the mesh (w is unused padding)
+//     uv:       RG_16_UNORM, normalized over the uv range of the mesh
+//     normal:   RG_16_NORM, octahedral encoded
+// Attributes missing in the mesh data are zero
+struct QuantizedVertex
+{
+    std::array<u16, 4> position{};
+    std::array<u16, 2> uv{};
+    std::array<i16, 2> normal{};
+};
+
+// Maps the normalized attributes back in the shader: position = positionOffset + positionScale * position.xyz and
+// uv = uvOffset + uvScale * uv. Laid out to be used directly as a constant buffer
+struct VertexDequantization
+{
+    vec4 positionScale{0.0f};
+    vec4 positionOffset{0.0f};
+    vec2 uvScale{0.0f};
+    vec2 uvOffset{0.0f};
+};
+
+struct QuantizedVertexStream
+{
+    std::vector<QuantizedVertex> vertices;
+    VertexDequantization dequantization;
+};
+
+// Builds a single interleaved stream from the mesh data, the indices of the mesh data can be used as they are
+QuantizedVertexStream buildQuantizedVertexStream(const MeshData& meshData);
+
+// Description of a QuantizedVertex stream, attributes are in the order position, uv, normal
+VertexInputStream getQuantizedVertexInputStream();
+
+// Octahedral normal encoding, maps the unit sphere onto a square by projecting it onto an octahedron and folding the
+// lower half over the upper one. Decoding is the reverse of this and is done in the shader
+std::array<i16, 2> encodeOctahedralNormal(const vec3& normal);
+vec3 decodeOctahedralNormal(const std::array<i16, 2>& encoded);
+
+} // namespace huedra
@@ -0,0 +1,98 @@
+#include "vertex_welder.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace huedra {
+
+VertexWelder::VertexWelder(u32 keySize, u64 expectedVertices) : m_keySize(keySize) { reserve(expectedVertices); }
+
+std::pair<u32, bool> VertexWelder::insert(const void* key)
+{
+    if ((m_count + 1) * 2 > m_slots.size())
+    {
+        rehash(std::max<u64>(m_slots.size() * 2, 64));
+    }
+
+    const u8* keyBytes = static_cast<const u8*>(key);
+    u64 mask = m_slots.size() - 1;
+    for (u64 slot = hashKey(keyBytes) & mask;; slot = (slot + 1) & mask)
+    {
+        u32 index = m_slots[slot];
+        if (index == EMPTY_SLOT)
+        {
+            index = static_cast<u32>(m_count++);
+            m_slots[slot] = index;
+            m_keys.insert(m_keys.end(), keyBytes, keyBytes + m_keySize);
+            return {index, true};
+        }
+        if (std::memcmp(&m_keys[static_cast<u64>(index) * m_keySize], keyBytes, m_keySize) == 0)
+        {
+            return {index, false};
+        }
+    }
+}
+
+void VertexWelder::reserve(u64 vertexCount)
+{
+    if (vertexCount == 0)
+    {
+        return;
+    }
+
+    m_keys.reserve(vertexCount * m_keySize);
+    u64 capacity = std::bit_ceil(vertexCount * 2);
+    if (capacity > m_slots.size())
+    {
+        rehash(capacity);
+    }
+}
+
+void VertexWelder::clear()
+{
+    m_count = 0;
+    m_keys.clear();
+    std::fill(m_slots.begin(), m_slots.end(), EMPTY_SLOT);
+}
+
+u64 VertexWelder::hashKey(const u8* key) const
+{
+    // Word wise multiply-xorshift, keys are small (usually 12-32 bytes) so this is only a few instructions
+    u64 hash = 0x9e3779b97f4a7c15ull ^ m_keySize;
+    u64 i = 0;
+    for (; i + sizeof(u64) <= m_keySize; i += sizeof(u64))
+    {
+        u64 word = 0;
+        std::memcpy(&word, &key[i], sizeof(u64));
+        hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+        hash ^= hash >> 32;
+    }
+    if (i < m_keySize)
+    {
+        u64 word = 0;
+        std::memcpy(&word, &key[i], m_keySize - i);
+        hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void VertexWelder::rehash(u64 capacity)
+{
+    m_slots.assign(capacity, EMPTY_SLOT);
+    u64 mask = capacity - 1;
+    for (u64 i = 0; i < m_count; ++i)
+    {
+        u64 slot = hashKey(&m_keys[i * m_keySize]) & mask;
+        while (m_slots[slot] != EMPTY_SLOT)
+        {
+            slot = (slot + 1) & mask;
+        }
+        m_slots[slot] = static_cast<u32>(i);
+    }
+}
+
+} // namespace huedra
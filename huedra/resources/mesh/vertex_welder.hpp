@@ -0,0 +1,51 @@
+#pragma once
+
+#include "core/types.hpp"
+
+namespace huedra {
+
+// Open addressing hash table that maps vertex keys to consecutive indices, used to weld identical vertices when
+// building index buffers. A key is a fixed size blob of bytes, e.g. an index triple (OBJ) or the attribute data of a
+// vertex (non indexed glTF primitives). Keys are compared bitwise, so float attributes should be normalized beforehand
+// if -0.0/0.0 or NaNs need to be treated as equal.
+class VertexWelder
+{
+public:
+    explicit VertexWelder(u32 keySize, u64 expectedVertices = 0);
+    ~VertexWelder() = default;
+
+    VertexWelder(const VertexWelder& rhs) = default;
+    VertexWelder& operator=(const VertexWelder& rhs) = default;
+    VertexWelder(VertexWelder&& rhs) = default;
+    VertexWelder& operator=(VertexWelder&& rhs) = default;
+
+    // Returns the index of an equal key, or adds the key with the next index. The second value is true if the key was
+    // added, the caller should then append the vertex data
+    std::pair<u32, bool> insert(const void* key);
+
+    template <typename T>
+        requires(std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>)
+    std::pair<u32, bool> insert(const T& key)
+    {
+        return insert(static_cast<const void*>(&key));
+    }
+
+    void reserve(u64 vertexCount);
+    void clear();
+
+    u64 size() const { return m_count; }
+    u32 getKeySize() const { return m_keySize; }
+
+private:
+    static constexpr u32 EMPTY_SLOT = ~0u;
+
+    u64 hashKey(const u8* key) const;
+    void rehash(u64 capacity);
+
+    u32 m_keySize{0};
+    u64 m_count{0};
+    std::vector<u8> m_keys;   // Keys of all inserted vertices, ordered by index
+    std::vector<u32> m_slots; // Vertex indices, power of two sized with a load factor of at most 1/2
+};
+
+} // namespace huedra
@@ -3,7 +3,11 @@
 #include "core/global.hpp"
 #include "core/log.hpp"
 #include "core/string/utils.hpp"
+#include "resources/mesh/cache.hpp"
 #include "resources/mesh/loader.hpp"
+#include "resources/mesh/meshlet.hpp"
+#include "resources/mesh/normals.hpp"
+#include "resources/mesh/optimizer.hpp"
 #include "resources/texture/loader.hpp"
 
 namespace huedra {
@@ -13,36 +17,93 @@ void ResourceManager::init() {}
 void ResourceManager::cleanup()
 {
     m_meshDatas.clear();
+    m_meshNodes.clear();
     m_textureDatas.clear();
 }
 
-std::vector<MeshData>& ResourceManager::loadMeshData(const std::string& path)
+std::vector<MeshData>& ResourceManager::loadMeshData(const std::string& path, const MeshLodSettings& lodSettings)
 {
     u64 hash = m_strHash(path);
     if (!m_meshDatas.contains(hash))
     {
-        FilePathInfo info = transformFilePath(path);
-        if (info.extension == "obj")
-        {
-            m_meshDatas.insert(std::pair<u64, std::vector<MeshData>>(hash, loadObj(path)));
-        }
-        else if (info.extension == "gltf")
+        u64 cacheKey = computeMeshCacheKey(path, lodSettings);
+        std::string cachePath = getMeshCachePath(path);
+        std::optional<std::vector<MeshData>> cachedMeshDatas;
+        std::vector<MeshNode> nodes;
+        if (cacheKey != 0)
         {
-            m_meshDatas.insert(std::pair<u64, std::vector<MeshData>>(hash, loadGltf(path)));
+            cachedMeshDatas = readMeshCache(cachePath, cacheKey, nodes);
         }
-        else if (info.extension == "glb")
+
+        std::vector<MeshData> meshDatas;
+        if (cachedMeshDatas.has_value())
         {
-            m_meshDatas.insert(std::pair<u64, std::vector<MeshData>>(hash, loadGlb(path)));
+            meshDatas = std::move(cachedMeshDatas.value());
         }
         else
         {
-            log(LogLevel::WARNING, "loadMeshData(): extension \"{}\" not supported", info.extension.c_str());
-            return m_missingMeshData;
+            nodes.clear();
+            FilePathInfo info = transformFilePath(path);
+            if (info.extension == "obj")
+            {
+                meshDatas = loadObj(path);
+            }
+            else if (info.extension == "gltf")
+            {
+                meshDatas = loadGltf(path, nodes);
+            }
+            else if (info.extension == "glb")
+            {
+                meshDatas = loadGlb(path, nodes);
+            }
+            else
+            {
+                log(LogLevel::WARNING, "loadMeshData(): extension \"{}\" not supported", info.extension.c_str());
+                return m_missingMeshData;
+            }
+
+            // All processing happens before the cache is written, so cached meshes are used as they are
+            for (MeshData& meshData : meshDatas)
+            {
+                if (lodSettings.lodCount > 0)
+                {
+                    buildMeshLods(meshData, lodSettings);
+                }
+                if (meshData.normals.empty())
+                {
+                    log(LogLevel::INFO, "loadMeshData(): mesh \"{}\" has no normals, generating them",
+                        meshData.name.c_str());
+                    generateNormals(meshData);
+                }
+
+                MeshOptimizationReport optimization = optimizeMesh(meshData);
+                log(LogLevel::INFO, "loadMeshData(): optimized mesh \"{}\", acmr: {} -> {}, atvr: {} -> {}",
+                    meshData.name.c_str(), optimization.before.acmr, optimization.after.acmr, optimization.before.atvr,
+                    optimization.after.atvr);
+                buildMeshlets(meshData);
+            }
+            if (cacheKey != 0 && !meshDatas.empty())
+            {
+                writeMeshCache(cachePath, cacheKey, meshDatas, nodes);
+            }
         }
+        m_meshDatas.insert(std::pair<u64, std::vector<MeshData>>(hash, std::move(meshDatas)));
+        m_meshNodes.insert(std::pair<u64, std::vector<MeshNode>>(hash, std::move(nodes)));
     }
     return m_meshDatas[hash];
 }
 
+std::vector<MeshNode>& ResourceManager::loadMeshNodes(const std::string& path, const MeshLodSettings& lodSettings)
+{
+    loadMeshData(path, lodSettings);
+    u64 hash = m_strHash(path);
+    if (!m_meshNodes.contains(hash))
+    {
+        return m_missingMeshNodes;
+    }
+    return m_meshNodes[hash];
+}
+
 TextureData& ResourceManager::loadTextureData(const std::string& path, TexelChannelFormat channelFormat)
 {
     u64 hash = m_strHash(path);
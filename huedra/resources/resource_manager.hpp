@@ -3,6 +3,7 @@
 #include "core/types.hpp"
 #include "graphics/shader_module.hpp"
 #include "resources/mesh/data.hpp"
+#include "resources/mesh/simplifier.hpp"
 #include "resources/texture/data.hpp"
 
 namespace huedra {
@@ -21,7 +22,11 @@ public:
     void init();
     void cleanup();
 
-    std::vector<MeshData>& loadMeshData(const std::string& path);
+    // Meshes are cached by path, the lod settings only apply to the first load of a path. Imported meshes get lods,
+    // normals if they have none, optimized buffers and meshlets, and are stored in the mesh cache in that state
+    std::vector<MeshData>& loadMeshData(const std::string& path, const MeshLodSettings& lodSettings = {});
+    // Node hierarchy of a mesh file, loads the mesh data as well. Empty for files without a hierarchy
+    std::vector<MeshNode>& loadMeshNodes(const std::string& path, const MeshLodSettings& lodSettings = {});
     TextureData& loadTextureData(const std::string& path, TexelChannelFormat channelFormat);
     ShaderModule& loadShaderModule(const std::string& path);
 
@@ -29,10 +34,12 @@ private:
     std::hash<std::string> m_strHash;
 
     std::vector<MeshData> m_missingMeshData;
+    std::vector<MeshNode> m_missingMeshNodes;
     TextureData m_missingTextureData;
     ShaderModule m_missingShaderModule;
 
     std::unordered_map<u64, std::vector<MeshData>> m_meshDatas;
+    std::unordered_map<u64, std::vector<MeshNode>> m_meshNodes;
     std::unordered_map<u64, TextureData> m_textureDatas;
     std::unordered_map<u64, ShaderModule> m_shaders;
 };
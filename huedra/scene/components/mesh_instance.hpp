@@ -0,0 +1,14 @@
+#pragma once
+
+#include "resources/mesh/data.hpp"
+
+namespace huedra {
+
+// Mesh drawn at the Transform of the entity. The mesh data is owned by the ResourceManager, every instance of the
+// same mesh points to the same data
+struct MeshInstance
+{
+    const MeshData* meshData{nullptr};
+};
+
+} // namespace huedra
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "scene/types.hpp"
+
+namespace huedra {
+
+// The Transform of an entity with a parent is relative to the Transform of the parent
+struct Parent
+{
+    Entity entity{0};
+};
+
+} // namespace huedra
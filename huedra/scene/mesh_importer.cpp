@@ -0,0 +1,70 @@
+#include "mesh_importer.hpp"
+#include "core/global.hpp"
+#include "core/log.hpp"
+#include "scene/components/mesh_instance.hpp"
+#include "scene/components/parent.hpp"
+#include "scene/components/transform.hpp"
+
+namespace huedra {
+
+std::vector<Entity> importMeshScene(SceneManager& sceneManager, const std::string& path,
+                                    const MeshLodSettings& lodSettings)
+{
+    std::vector<MeshData>& meshDatas = global::resourceManager.loadMeshData(path, lodSettings);
+    std::vector<MeshNode>& nodes = global::resourceManager.loadMeshNodes(path, lodSettings);
+
+    std::vector<Entity> entities;
+    if (nodes.empty())
+    {
+        entities.reserve(meshDatas.size());
+        for (const MeshData& meshData : meshDatas)
+        {
+            Entity entity = sceneManager.addEntity();
+            sceneManager.setComponents(entity, Transform{}, MeshInstance{.meshData = &meshData});
+            entities.push_back(entity);
+        }
+        return entities;
+    }
+
+    entities.reserve(nodes.size());
+    for (const MeshNode& node : nodes)
+    {
+        Entity entity = sceneManager.addEntity();
+        sceneManager.setComponent(
+            entity, Transform{.position = node.position, .rotation = node.rotation, .scale = node.scale});
+
+        // Parents are stored before their children, so the entity of the parent already exists
+        if (node.parent != MESH_NODE_NONE && node.parent < entities.size())
+        {
+            sceneManager.setComponent(entity, Parent{.entity = entities[node.parent]});
+        }
+        else if (node.parent != MESH_NODE_NONE)
+        {
+            log(LogLevel::WARNING, "importMeshScene(): node {} of \"{}\" has parent {} out of range, ignoring it",
+                entities.size(), path.c_str(), node.parent);
+        }
+        if (node.mesh != MESH_NODE_NONE && node.mesh < meshDatas.size())
+        {
+            sceneManager.setComponent(entity, MeshInstance{.meshData = &meshDatas[node.mesh]});
+        }
+        entities.push_back(entity);
+    }
+    return entities;
+}
+
+matrix4 getWorldMatrix(const SceneManager& sceneManager, Entity entity)
+{
+    matrix4 matrix(1.0f);
+    while (sceneManager.hasComponents<Transform>(entity))
+    {
+        matrix = sceneManager.getComponent<Transform>(entity).applyMatrix() * matrix;
+        if (!sceneManager.hasComponents<Parent>(entity))
+        {
+            break;
+        }
+        entity = sceneManager.getComponent<Parent>(entity).entity;
+    }
+    return matrix;
+}
+
+} // namespace huedra
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "math/matrix.hpp"
+#include "resources/mesh/simplifier.hpp"
+#include "scene/scene_manager.hpp"
+
+namespace huedra {
+
+// Creates an entity for every node of a mesh file, with a Transform, a Parent unless the node is a root and a
+// MeshInstance if the node has a mesh. Files without a node hierarchy get one root entity per mesh. Returns the
+// entities in node order, parents before their children
+std::vector<Entity> importMeshScene(SceneManager& sceneManager, const std::string& path,
+                                    const MeshLodSettings& lodSettings = {});
+
+// Model matrix of an entity, combined with the Transforms of all of its parents
+matrix4 getWorldMatrix(const SceneManager& sceneManager, Entity entity);
+
+} // namespace huedra